@@ -5,6 +5,16 @@
 
 namespace ArtifactCategoryPolicy {
 
+/**
+ * @brief Stable main categories that artifact labels are normalized to.
+ */
+inline constexpr char kSoftwareCategory[] = "Software";
+inline constexpr char kInstallersCategory[] = "Installers";
+inline constexpr char kDriversCategory[] = "Drivers";
+inline constexpr char kOperatingSystemsCategory[] = "Operating Systems";
+inline constexpr char kArchivesCategory[] = "Archives";
+inline constexpr char kDataExportsCategory[] = "Data Exports";
+
 /**
  * @brief Normalized category/subcategory labels for software-like or archive-like files.
  */
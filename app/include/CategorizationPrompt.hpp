@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+
+/**
+ * @brief System prompts shared by the remote categorization backends.
+ *
+ * The single-item and batched prompts are built from the same guidance so the
+ * two request shapes cannot drift apart; only the item framing and the reply
+ * format differ.
+ */
+namespace CategorizationPrompt {
+
+/**
+ * @brief Returns the system prompt for a request that categorizes one item.
+ * @return Prompt asking for one `<Main category> : <Subcategory>` line.
+ */
+const std::string& single_item_system_prompt();
+
+/**
+ * @brief Returns the system prompt for a request that lists several numbered items.
+ * @return Prompt asking for a JSON array with one category/subcategory object per item.
+ */
+const std::string& batch_system_prompt();
+
+} // namespace CategorizationPrompt
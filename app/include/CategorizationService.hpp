@@ -3,12 +3,18 @@
 
 #include "Types.hpp"
 #include "DatabaseManager.hpp"
+#include "FastPathCategorizer.hpp"
+#include "FilenameClusterPlan.hpp"
+#include "ILLMClient.hpp"
+#include "InferenceExecutor.hpp"
+#include "LearnedCategoryClassifier.hpp"
 
 #include <atomic>
 #include <deque>
 #include <future>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -16,7 +22,6 @@
 #include <vector>
 
 class Settings;
-class ILLMClient;
 class UserLearningStore;
 namespace spdlog { class logger; }
 
@@ -50,6 +55,7 @@ public:
                           DatabaseManager& db_manager,
                           std::shared_ptr<spdlog::logger> core_logger,
                           UserLearningStore* user_learning_store = nullptr);
+    ~CategorizationService();
 
     /**
      * @brief Updates the optional learned-behavior store used for candidate retrieval.
@@ -106,6 +112,7 @@ private:
     using CategoryPair = std::pair<std::string, std::string>;
     using HintHistory = std::deque<CategoryPair>;
     using SessionHistoryMap = std::unordered_map<std::string, HintHistory>;
+    using PrefetchedCategorization = std::pair<ILLMClient::CategorizationRequest, std::string>;
 
     /**
      * @brief Returns a cached categorization when available, otherwise calls the LLM.
@@ -156,7 +163,56 @@ private:
         const ProgressCallback& progress_callback,
         const RecategorizationCallback& recategorization_callback,
         SessionHistoryMap& session_history) const;
+    /**
+     * @brief Applies a filename cluster's representative result to another member and persists it.
+     * @param entry Cluster member to categorize.
+     * @param representative Confirmed result of the cluster's representative.
+     * @param suggested_name Optional suggested name for renaming.
+     * @param progress_callback Progress updates callback.
+     * @param session_history Mutable session history for consistency hints.
+     * @return Categorized entry, or std::nullopt when the entry has its own cached result or rule match.
+     */
+    std::optional<CategorizedFile> propagate_cluster_result(
+        const FileEntry& entry,
+        const CategorizedFile& representative,
+        const std::string& suggested_name,
+        const ProgressCallback& progress_callback,
+        SessionHistoryMap& session_history) const;
 
+    /**
+     * @brief Builds the consistency-hint and whitelist context sent with an entry's prompt.
+     * @param entry File entry being categorized.
+     * @param prompt_name Name used in the categorization prompt.
+     * @param prompt_path Path/context payload used in the categorization prompt.
+     * @param session_history Session history for consistency hints.
+     * @return Combined prompt context.
+     */
+    std::string build_entry_context(const FileEntry& entry,
+                                    const std::string& prompt_name,
+                                    const std::string& prompt_path,
+                                    const SessionHistoryMap& session_history) const;
+    /**
+     * @brief Submits the next window of uncached entries to the LLM as one batched request.
+     * @param llm LLM client used for the request.
+     * @param is_local_llm True when using a local LLM backend.
+     * @param files All entries being categorized.
+     * @param start_index Index of the first entry to consider.
+     * @param batch_size Maximum number of requests to submit together.
+     * @param prompt_override Optional prompt override provider.
+     * @param session_history Session history for consistency hints.
+     * @param cluster_plan Filename clusters; members expected to reuse a result are skipped.
+     * @param prefetched Output list of requests paired with their raw responses.
+     * @return Index one past the last entry scanned for this window.
+     */
+    std::size_t prefetch_batch_categorizations(ILLMClient& llm,
+                                               bool is_local_llm,
+                                               const std::vector<FileEntry>& files,
+                                               std::size_t start_index,
+                                               std::size_t batch_size,
+                                               const PromptOverrideProvider& prompt_override,
+                                               const SessionHistoryMap& session_history,
+                                               const FilenameClusterPlan& cluster_plan,
+                                               std::vector<PrefetchedCategorization>& prefetched) const;
     /**
      * @brief Combines language, family-candidate, whitelist, and hint blocks into a single prompt context.
      * @param hint_block Consistency hint block.
@@ -198,6 +254,34 @@ private:
         const std::string& prompt_path,
         const ProgressCallback& progress_callback,
         const std::string& combined_context) const;
+    /**
+     * @brief Returns the fast-path rule match for an entry when rules are enabled and allowed.
+     * @param entry File entry to check.
+     * @return Rule labels, or std::nullopt when the entry needs the LLM.
+     *
+     * The file is read once per categorization run; later calls for the same path reuse that result.
+     */
+    std::optional<FastPathCategorizer::Match> match_fast_path(const FileEntry& entry) const;
+    /**
+     * @brief Trains the learned classifier on approvals recorded since the last run.
+     */
+    void refresh_learned_classifier() const;
+    /**
+     * @brief Returns the learned classifier's answer when it is confident enough and allowed.
+     * @param entry File entry to check.
+     * @param prompt_path Prompt path, which may carry an image description or document summary.
+     * @return Predicted labels, or std::nullopt when the entry needs the LLM.
+     */
+    std::optional<LearnedCategoryClassifier::Prediction> match_learned_classifier(
+        const FileEntry& entry,
+        const std::string& prompt_path) const;
+    /**
+     * @brief Returns whether the cache holds a valid categorization for an entry.
+     * @param dir_path Directory path of the entry.
+     * @param entry File entry to check.
+     * @return True when a cached category/subcategory pair passes validation.
+     */
+    bool has_valid_cached_categorization(const std::string& dir_path, const FileEntry& entry) const;
     /**
      * @brief Handles empty or invalid categorization results.
      * @param entry File entry being categorized.
@@ -255,19 +339,19 @@ private:
      */
     int resolve_llm_timeout(bool is_local_llm) const;
     /**
-     * @brief Launches an asynchronous LLM categorization request.
+     * @brief Queues an LLM categorization request on the inference executor.
      * @param llm LLM client used for the request.
      * @param item_name Display name for the item.
      * @param item_path Display path for the item.
      * @param file_type File or directory.
      * @param consistency_context Consistency hints block.
-     * @return Future that yields the raw LLM response.
+     * @return Future that yields the raw LLM response, with the flag that cancels the request.
      */
-    std::future<std::string> start_llm_future(ILLMClient& llm,
-                                              const std::string& item_name,
-                                              const std::string& item_path,
-                                              FileType file_type,
-                                              const std::string& consistency_context) const;
+    InferenceExecutor::Submission<std::string> start_llm_future(ILLMClient& llm,
+                                                                const std::string& item_name,
+                                                                const std::string& item_path,
+                                                                FileType file_type,
+                                                                const std::string& consistency_context) const;
     /**
      * @brief Builds a whitelist context block for the prompt.
      * @return Whitelist prompt section.
@@ -307,6 +391,19 @@ private:
     std::string build_learned_candidate_context(const std::string& prompt_name,
                                                 const std::string& prompt_path,
                                                 FileType file_type) const;
+    /**
+     * @brief Normalizes learned labels for a file and checks they suit its family and the whitelist.
+     * @param prompt_name Name used in the categorization prompt.
+     * @param file_type File or directory being categorized.
+     * @param category Learned main category.
+     * @param subcategory Learned subcategory; may be empty.
+     * @return Image/document/artifact-normalized labels, or std::nullopt when the main category is outside
+     *         the file family's candidates or the labels are not allowed by the active whitelist.
+     */
+    std::optional<CategoryPair> fit_learned_labels(const std::string& prompt_name,
+                                                   FileType file_type,
+                                                   std::string category,
+                                                   std::string subcategory) const;
     /**
      * @brief Prefer a strong user-learned candidate over generic model output.
      * @param resolved Model-resolved category/subcategory before learned preference.
@@ -449,6 +546,13 @@ private:
     DatabaseManager& db_manager;
     std::shared_ptr<spdlog::logger> core_logger;
     UserLearningStore* user_learning_store_{nullptr};
+    std::unique_ptr<InferenceExecutor> inference_executor_;
+    FastPathCategorizer fast_path_categorizer_;
+    mutable std::mutex fast_path_mutex_;
+    /** Full path -> rule match of the current categorization run. */
+    mutable std::unordered_map<std::string, std::optional<FastPathCategorizer::Match>> fast_path_matches_;
+    mutable std::mutex learned_classifier_mutex_;
+    mutable LearnedCategoryClassifier learned_classifier_;
 };
 
 #endif
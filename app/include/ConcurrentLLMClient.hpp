@@ -0,0 +1,80 @@
+#pragma once
+
+#include "ILLMClient.hpp"
+#include "InferenceExecutor.hpp"
+#include "RemoteRateLimiter.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Sends the items of a categorize_files batch to a remote API as concurrent requests.
+ *
+ * Each in-flight request uses its own client, created on demand from the factory.
+ * All requests share a RemoteRateLimiter, so the configured request rate and any
+ * Retry-After delay reported by the server apply across the whole batch.
+ * When the wrapped clients pack several items into one prompt, each request carries
+ * one such sub-batch. Responses come back in request order; an item whose request
+ * fails is returned empty so the caller can retry it on its own.
+ */
+class ConcurrentLLMClient : public ILLMClient {
+public:
+    using Factory = std::function<std::unique_ptr<ILLMClient>()>;
+
+    /**
+     * @brief Wraps a remote client.
+     * @param primary Client used for single requests and the first concurrent slot.
+     * @param factory Creates the clients for the other concurrent slots.
+     * @param concurrency Maximum number of requests in flight.
+     * @param limiter Rate limiter shared by all requests.
+     * @param stop_flag Cancellation flag checked before each request.
+     */
+    ConcurrentLLMClient(std::unique_ptr<ILLMClient> primary,
+                        Factory factory,
+                        std::size_t concurrency,
+                        std::shared_ptr<RemoteRateLimiter> limiter,
+                        const std::atomic<bool>& stop_flag);
+    ~ConcurrentLLMClient() override;
+
+    /**
+     * @brief Categorizes one item with the primary client.
+     * @throws BackoffError while the server's rate-limit pause is still running.
+     * @throws std::runtime_error when the stop flag is raised while waiting for the rate limiter.
+     */
+    std::string categorize_file(const std::string& file_name,
+                                const std::string& file_path,
+                                FileType file_type,
+                                const std::string& consistency_context) override;
+    std::vector<std::string> categorize_files(const std::vector<CategorizationRequest>& requests) override;
+    std::size_t max_batch_size() const override;
+    /**
+     * @brief Completes a prompt with the primary client under the shared rate limit.
+     * @throws BackoffError while the server's rate-limit pause is still running.
+     * @throws std::runtime_error when the stop flag is raised while waiting for the rate limiter.
+     */
+    std::string complete_prompt(const std::string& prompt, int max_tokens) override;
+    void set_prompt_logging_enabled(bool enabled) override;
+    void set_cancellation_flag(const std::atomic<bool>* flag) override;
+
+private:
+    std::size_t inner_batch_size() const;
+    ILLMClient* client_for_slot(std::size_t slot);
+    void acquire_or_throw();
+    void throw_if_paused() const;
+    void pause_after(int retry_after_seconds);
+
+    Factory factory_;
+    std::size_t concurrency_{1};
+    std::shared_ptr<RemoteRateLimiter> limiter_;
+    const std::atomic<bool>& stop_flag_;
+    bool prompt_logging_enabled_{false};
+    const std::atomic<bool>* cancellation_flag_{nullptr};
+    std::mutex clients_mutex_;
+    std::vector<std::unique_ptr<ILLMClient>> clients_;
+    std::unique_ptr<InferenceExecutor> slot_executor_;
+};
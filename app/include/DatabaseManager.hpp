@@ -90,6 +90,62 @@ public:
                                            bool recursive = false) const;
     std::optional<bool> get_directory_categorization_style(const std::string& dir_path) const;
 
+    /**
+     * @brief Image analysis output cached by content fingerprint.
+     */
+    struct CachedImageAnalysis {
+        std::string description;
+        std::string suggested_name;
+    };
+
+    /**
+     * @brief Looks up a cached image analysis for identical file content.
+     * @param content_fingerprint Fingerprint from FileFingerprint::compute().
+     * @param model_id Visual model that produced the analysis.
+     * @return Cached description and suggested name when present.
+     */
+    std::optional<CachedImageAnalysis> get_image_analysis(const std::string& content_fingerprint,
+                                                          const std::string& model_id) const;
+    /**
+     * @brief Stores the analysis of an image so identical content can skip the visual model.
+     * @param content_fingerprint Fingerprint from FileFingerprint::compute().
+     * @param model_id Visual model that produced the analysis.
+     * @param analysis Description and suggested name to cache.
+     * @return True when the row was written.
+     */
+    bool store_image_analysis(const std::string& content_fingerprint,
+                              const std::string& model_id,
+                              const CachedImageAnalysis& analysis);
+
+    /**
+     * @brief Document text and metadata cached by file identity.
+     *
+     * Fields left empty were not extracted yet; an empty string means extraction found nothing.
+     */
+    struct CachedDocumentExcerpt {
+        std::optional<std::string> excerpt;
+        std::optional<std::string> creation_date;
+    };
+
+    /**
+     * @brief Looks up a cached document excerpt.
+     * @param file_identity Identity from FileFingerprint::identity().
+     * @param extractor_key Extractor version and excerpt budget the entry was produced with.
+     * @return Cached fields when a row exists.
+     */
+    std::optional<CachedDocumentExcerpt> get_document_excerpt(const std::string& file_identity,
+                                                              const std::string& extractor_key) const;
+    /**
+     * @brief Stores document fields; fields left empty keep their cached value.
+     * @param file_identity Identity from FileFingerprint::identity().
+     * @param extractor_key Extractor version and excerpt budget the entry was produced with.
+     * @param entry Fields to store.
+     * @return True when the row was written.
+     */
+    bool store_document_excerpt(const std::string& file_identity,
+                                const std::string& extractor_key,
+                                const CachedDocumentExcerpt& entry);
+
 private:
     struct TaxonomyEntry {
         int id;
@@ -101,6 +157,8 @@ private:
 
     void initialize_schema();
     void initialize_taxonomy_schema();
+    void initialize_image_analysis_schema();
+    void initialize_document_excerpt_schema();
     void load_taxonomy_cache();
     void load_translation_cache();
     /**
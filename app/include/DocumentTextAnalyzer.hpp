@@ -4,7 +4,10 @@
 #include <filesystem>
 #include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
+class DatabaseManager;
 class ILLMClient;
 
 inline constexpr std::size_t kDefaultDocumentAnalyzerMaxCharacters = 8000;
@@ -48,6 +51,10 @@ public:
          * @brief Maximum number of tokens to generate for the response.
          */
         int max_tokens = kDefaultDocumentAnalyzerMaxTokens;
+        /**
+         * @brief Character budget for an extractive summary of the excerpt; 0 sends the excerpt as is.
+         */
+        size_t summary_characters = 0;
     };
 
     /**
@@ -68,6 +75,41 @@ public:
     DocumentAnalysisResult analyze(const std::filesystem::path& document_path,
                                    ILLMClient& llm) const;
 
+    /**
+     * @brief Analyze text that was already extracted with extract_text().
+     * @param document_path Path of the document the text came from.
+     * @param raw_text Extracted text; empty text is reported as an error.
+     * @param llm LLM client used to generate the summary and filename.
+     * @return Analysis result containing summary and suggested filename.
+     */
+    DocumentAnalysisResult analyze_text(const std::filesystem::path& document_path,
+                                        const std::string& raw_text,
+                                        ILLMClient& llm) const;
+
+    /**
+     * @brief Extracts plain text from a supported document, capped at the configured character budget.
+     *
+     * Safe to call from several threads at once; PDFium access is serialized internally.
+     * With an excerpt cache set, unchanged files are answered from the cache without being opened.
+     *
+     * @param path Document to read.
+     * @return Extracted text, or an empty string when nothing could be extracted.
+     */
+    std::string extract_text(const std::filesystem::path& path) const;
+
+    /**
+     * @brief Returns the document creation date, using the excerpt cache when one is set.
+     * @param path Document path to inspect.
+     * @return Creation date formatted as YYYY-MM when available.
+     */
+    std::optional<std::string> creation_date(const std::filesystem::path& path) const;
+
+    /**
+     * @brief Caches extracted text and creation dates by file identity across runs.
+     * @param cache Database holding the cache, or nullptr to always read the files.
+     */
+    void set_excerpt_cache(DatabaseManager* cache);
+
     /**
      * @brief Returns true if the file extension is supported for document analysis.
      * @param path Document path to inspect.
@@ -82,7 +124,11 @@ public:
     static std::optional<std::string> extract_creation_date(const std::filesystem::path& path);
 
 private:
-    std::string extract_text(const std::filesystem::path& path) const;
+    std::string extract_text_uncached(const std::filesystem::path& path) const;
+    /**
+     * @brief Extractor version and excerpt budget that cached entries must match.
+     */
+    std::string excerpt_cache_key() const;
     std::string build_prompt(const std::string& excerpt,
                              const std::string& file_name) const;
     std::string sanitize_filename(const std::string& value,
@@ -95,4 +141,24 @@ private:
     static std::string slugify(const std::string& value);
 
     Settings settings_;
+    DatabaseManager* excerpt_cache_{nullptr};
 };
+
+#ifdef AI_FILE_SORTER_TEST_BUILD
+namespace DocumentTextAnalyzerTestAccess {
+/**
+ * @brief Runs the streaming OOXML/ODF text collector over XML split into chunks.
+ * @param chunks Consecutive pieces of one XML document.
+ * @param max_chars Character budget after which collection stops.
+ * @return Collected text and the number of chunks consumed before the budget was reached.
+ */
+std::pair<std::string, std::size_t> collect_xml_text(const std::vector<std::string>& chunks, std::size_t max_chars);
+/**
+ * @brief Runs the extractive sentence selection used to shrink long excerpts.
+ * @param text Excerpt to summarise.
+ * @param max_chars Character budget of the summary.
+ * @return Selected sentences in document order.
+ */
+std::string select_key_sentences(const std::string& text, std::size_t max_chars);
+}
+#endif
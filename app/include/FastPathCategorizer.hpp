@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Types.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <regex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Deterministic rules that categorize unambiguous files without an LLM request.
+ *
+ * Built-in rules cover fonts, disk images and archives, and each one is confirmed by
+ * the file's signature bytes so a renamed file falls through to the model. Installers
+ * are left to the model, which names the kind of software they install. Rules read
+ * from a JSON file are evaluated before the built-in ones.
+ */
+class FastPathCategorizer {
+public:
+    /**
+     * @brief One rule; every condition that is set must hold for the rule to match.
+     */
+    struct Rule {
+        std::string name;
+        /** Lower-case file name suffixes including the dot; empty accepts any name. */
+        std::vector<std::string> extensions;
+        /** ECMAScript regular expression searched case-insensitively in the file name; empty accepts any name. */
+        std::string name_pattern;
+        std::optional<std::uintmax_t> min_size;
+        std::optional<std::uintmax_t> max_size;
+        /** Bytes expected at magic_offset; empty skips the content check. */
+        std::string magic;
+        /** Offset of the magic bytes; negative values count back from the end of the file. */
+        std::int64_t magic_offset{0};
+        std::string category;
+        std::string subcategory;
+    };
+
+    /**
+     * @brief Labels chosen by a matching rule.
+     */
+    struct Match {
+        std::string rule_name;
+        std::string category;
+        std::string subcategory;
+    };
+
+    /**
+     * @brief Creates a categorizer from a list of rules, evaluated in order.
+     * @param rules Rules to evaluate; invalid rules are skipped with a warning.
+     */
+    explicit FastPathCategorizer(std::vector<Rule> rules = default_rules());
+
+    /**
+     * @brief Creates a categorizer from a rules file followed by the built-in rules.
+     * @param file JSON file with a "rules" array; a missing file yields the built-in rules only.
+     *
+     * Setting "use_builtin_rules" to false in the file drops the built-in rules.
+     */
+    static FastPathCategorizer from_file(const std::filesystem::path& file);
+
+    /**
+     * @brief Returns the built-in rules.
+     */
+    static std::vector<Rule> default_rules();
+
+    /**
+     * @brief Finds the first rule that matches a file.
+     * @param file_name File name used for extension and pattern checks.
+     * @param full_path Path used for size and signature checks.
+     * @param file_type Only regular files are matched.
+     * @return Labels of the first matching rule, or std::nullopt.
+     */
+    std::optional<Match> match(const std::string& file_name,
+                               const std::string& full_path,
+                               FileType file_type) const;
+
+    /**
+     * @brief Returns the number of usable rules.
+     */
+    std::size_t rule_count() const { return rules_.size(); }
+
+private:
+    struct CompiledRule {
+        Rule rule;
+        std::optional<std::regex> pattern;
+    };
+
+    std::vector<CompiledRule> rules_;
+};
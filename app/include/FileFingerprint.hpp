@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+/**
+ * @brief Fast content fingerprints that identify a file independently of its path.
+ *
+ * The fingerprint combines the file size with a hash of sampled blocks from the
+ * start, middle and end of the file, so moved, copied or re-imported files map to
+ * the same key without reading them in full.
+ */
+namespace FileFingerprint {
+
+/** @brief Size of each sampled block in bytes. */
+inline constexpr std::size_t kSampleBlockBytes = 64 * 1024;
+
+/**
+ * @brief Computes the content fingerprint of a file.
+ * @param path File to fingerprint.
+ * @return Fingerprint formatted as "<size>:<16 hex digits>", or std::nullopt when the file cannot be read.
+ */
+std::optional<std::string> compute(const std::filesystem::path& path);
+
+/**
+ * @brief Builds a metadata-only identity for a file without reading its contents.
+ *
+ * On POSIX systems the identity is the device and inode plus size and modification
+ * time, so renamed or moved files on the same volume keep it. Elsewhere the absolute
+ * path takes the place of device and inode. Any edit changes the modification time
+ * and therefore the identity.
+ *
+ * @param path File to identify.
+ * @return Identity string, or std::nullopt when the file cannot be inspected.
+ */
+std::optional<std::string> identity(const std::filesystem::path& path);
+
+} // namespace FileFingerprint
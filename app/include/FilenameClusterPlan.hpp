@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Types.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Groups sibling files whose names differ only by numbers, dates, UUIDs or hashes.
+ *
+ * Files are clustered by parent directory and name template, e.g. `scan_0001.pdf` and
+ * `scan_0002.pdf` share `scan_{n}.pdf`. The first member of each cluster is categorized
+ * normally, the next few members verify that result, and the remaining members reuse it.
+ * A verification member that disagrees (or fails) dissolves the cluster so its remaining
+ * members are categorized one by one.
+ */
+class FilenameClusterPlan {
+public:
+    /**
+     * @brief Creates an empty plan that never propagates results.
+     */
+    FilenameClusterPlan() = default;
+
+    /**
+     * @brief Clusters the pending entries of a categorization run.
+     * @param files Entries in the order they will be categorized.
+     * @param verification_samples Members after the first that are categorized on their own to confirm the result.
+     * @param excluded Returns true for entries that must be categorized on their own, e.g. because their
+     *        prompt carries an image description or document summary that the name does not predict.
+     */
+    FilenameClusterPlan(const std::vector<FileEntry>& files,
+                        std::size_t verification_samples,
+                        const std::function<bool(const FileEntry&)>& excluded = {});
+
+    /**
+     * @brief Normalizes a file name into its template.
+     * @param file_name File name including the extension.
+     * @return Lower-case template with `{uuid}`, `{hash}`, `{date}` and `{n}` placeholders, or std::nullopt
+     *         when the name has no variable part or fewer than two literal letters.
+     */
+    static std::optional<std::string> make_template(const std::string& file_name);
+
+    /**
+     * @brief Returns the confirmed result to reuse for an entry.
+     * @param index Index of the entry in the planned list.
+     * @return Representative result, or nullptr when the entry must be categorized itself.
+     */
+    const CategorizedFile* representative_result(std::size_t index) const;
+
+    /**
+     * @brief Returns whether an entry is expected to reuse its cluster's result.
+     * @param index Index of the entry in the planned list.
+     * @return True for members past the verification samples of a cluster that has not been dissolved.
+     */
+    bool will_propagate(std::size_t index) const;
+
+    /**
+     * @brief Records the outcome of an entry that was categorized itself.
+     * @param index Index of the entry in the planned list.
+     * @param result Categorization result, or std::nullopt when the entry produced none.
+     */
+    void record_result(std::size_t index, const std::optional<CategorizedFile>& result);
+
+    /**
+     * @brief Returns the number of clusters with members that can reuse a result.
+     */
+    std::size_t cluster_count() const { return clusters_.size(); }
+
+private:
+    struct Cluster {
+        std::optional<CategorizedFile> representative;
+        std::size_t verified{0};
+        bool dissolved{false};
+    };
+
+    struct Membership {
+        std::size_t cluster{0};
+        std::size_t rank{0};
+    };
+
+    std::vector<Cluster> clusters_;
+    std::vector<std::optional<Membership>> membership_;
+    std::size_t verification_samples_{0};
+};
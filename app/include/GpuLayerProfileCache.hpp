@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+
+/**
+ * @brief Persists the GPU layer count that last loaded a model successfully.
+ *
+ * Entries are keyed by model file identity, backend and a bucket of the total GPU
+ * memory, so a later load on the same machine can skip layer estimation and the
+ * load-retry ladder.
+ */
+class GpuLayerProfileCache {
+public:
+    /**
+     * @brief Identifies one model/backend/device combination.
+     */
+    struct Key {
+        std::string model_identity;
+        std::string backend;
+        std::uint64_t memory_bucket_mib{0};
+    };
+
+    /**
+     * @brief Creates a cache stored in the given JSON file.
+     * @param file Path of the JSON file; it is created on the first store().
+     */
+    explicit GpuLayerProfileCache(std::filesystem::path file);
+
+    /**
+     * @brief Returns the stored layer count for a key.
+     * @param key Model/backend/device key.
+     * @return Stored n_gpu_layers, or std::nullopt when unknown.
+     */
+    std::optional<int> lookup(const Key& key) const;
+    /**
+     * @brief Records the layer count that loaded successfully for a key.
+     * @param key Model/backend/device key.
+     * @param n_gpu_layers Layer count to store.
+     * @return True when the file was written.
+     */
+    bool store(const Key& key, int n_gpu_layers);
+    /**
+     * @brief Removes a stored entry, e.g. after the stored layer count failed to load.
+     * @param key Model/backend/device key.
+     * @return True when the file was written.
+     */
+    bool forget(const Key& key);
+
+    /**
+     * @brief Rounds a total memory size down to the bucket granularity used in keys.
+     * @param total_bytes Total device memory in bytes.
+     * @return Bucketed size in MiB.
+     */
+    static std::uint64_t memory_bucket_mib(std::uint64_t total_bytes);
+
+private:
+    std::filesystem::path file_;
+    static std::mutex file_mutex_;
+};
@@ -1,15 +1,60 @@
 #pragma once
 #include "Types.hpp"
+#include <atomic>
+#include <cstddef>
 #include <string>
+#include <vector>
 
 class ILLMClient {
 public:
+    /**
+     * @brief Arguments of a single categorize_file call submitted as part of a batch.
+     */
+    struct CategorizationRequest {
+        std::string file_name;
+        std::string file_path;
+        FileType file_type{FileType::File};
+        std::string consistency_context;
+    };
+
     virtual ~ILLMClient() = default;
     virtual std::string categorize_file(const std::string& file_name,
                                         const std::string& file_path,
                                         FileType file_type,
                                         const std::string& consistency_context) = 0;
+    /**
+     * @brief Categorizes several items in one call.
+     * @param requests Items to categorize.
+     * @return One raw response per request, in request order.
+     *
+     * The default implementation calls categorize_file for each request in turn;
+     * clients that can decode several prompts together override it.
+     */
+    virtual std::vector<std::string> categorize_files(const std::vector<CategorizationRequest>& requests)
+    {
+        std::vector<std::string> responses;
+        responses.reserve(requests.size());
+        for (const auto& request : requests) {
+            responses.push_back(categorize_file(request.file_name,
+                                                request.file_path,
+                                                request.file_type,
+                                                request.consistency_context));
+        }
+        return responses;
+    }
+    /**
+     * @brief Returns how many requests categorize_files can process together efficiently.
+     * @return Preferred batch size; 1 when the client has no batched mode.
+     */
+    virtual std::size_t max_batch_size() const { return 1; }
     virtual std::string complete_prompt(const std::string& prompt,
                                         int max_tokens) = 0;
     virtual void set_prompt_logging_enabled(bool enabled) = 0;
+    /**
+     * @brief Sets a flag the client polls to abandon the request in progress.
+     * @param flag Cancellation flag that outlives the request, or nullptr to clear it.
+     *
+     * Clients that cannot interrupt a request ignore the flag.
+     */
+    virtual void set_cancellation_flag(const std::atomic<bool>* flag) { (void)flag; }
 };
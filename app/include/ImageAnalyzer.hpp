@@ -8,6 +8,9 @@
 #include <filesystem>
 #include <functional>
 #include <string>
+#include <vector>
+
+#include "Types.hpp"
 
 inline constexpr int32_t kDefaultImageAnalyzerContextTokens = 4096;
 inline constexpr int32_t kDefaultImageAnalyzerPredictTokens = 80;
@@ -73,6 +76,22 @@ struct ImageAnalysisResult {
     ImageAnalysisDiagnostics diagnostics;
 };
 
+/**
+ * @brief Image decoded ahead of inference, typically already downscaled.
+ */
+struct PreparedImage {
+    /** @brief Original image path. */
+    std::filesystem::path path;
+    /** @brief Width in pixels. */
+    uint32_t width = 0;
+    /** @brief Height in pixels. */
+    uint32_t height = 0;
+    /** @brief Packed RGB pixels, three bytes per pixel. */
+    std::vector<unsigned char> rgb;
+    /** @brief Decode/downscale time in milliseconds. */
+    double decode_ms = 0.0;
+};
+
 /**
  * @brief Shared configuration for local image analyzers.
  */
@@ -83,6 +102,12 @@ struct ImageAnalyzerSettings {
     int32_t n_predict = kDefaultImageAnalyzerPredictTokens;
     /** @brief Number of CPU threads to use (0 = auto). */
     int32_t n_threads = 0;
+    /** @brief Number of CPU threads for prompt and image batches (0 = same as n_threads). */
+    int32_t n_threads_batch = 0;
+    /** @brief KV cache precision for the text context. */
+    KvCacheType kv_cache_type = KvCacheType::Auto;
+    /** @brief Flash-attention mode for the text context. */
+    FlashAttentionMode flash_attention = FlashAttentionMode::Auto;
     /** @brief Sampling temperature. */
     float temperature = kDefaultImageAnalyzerTemperature;
     /** @brief Whether to use GPU acceleration. */
@@ -113,4 +138,23 @@ public:
      * @return Analysis result with description and suggested name.
      */
     virtual ImageAnalysisResult analyze(const std::filesystem::path& image_path) = 0;
+
+    /**
+     * @brief Analyze an image that was already decoded.
+     * @param image Decoded image; backends without bitmap input fall back to image.path.
+     * @return Analysis result with description and suggested name.
+     */
+    virtual ImageAnalysisResult analyze(const PreparedImage& image) { return analyze(image.path); }
+
+    /**
+     * @brief Longest image side worth decoding for this backend.
+     * @return Maximum long side in pixels, or 0 when prepared images are not used.
+     */
+    virtual int32_t preferred_input_long_side() const { return 0; }
+
+    /**
+     * @brief Smallest image long side the backend can use without upscaling.
+     * @return Minimum long side in pixels, or 0 when unknown.
+     */
+    virtual int32_t minimum_input_long_side() const { return 0; }
 };
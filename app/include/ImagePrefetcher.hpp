@@ -0,0 +1,58 @@
+#pragma once
+
+#include "ImageAnalyzer.hpp"
+#include "OrderedPrefetcher.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+/**
+ * @brief Decodes and downscales upcoming images on worker threads ahead of visual inference.
+ *
+ * Workers stay at most @c lookahead images ahead of the consumer, so only a few
+ * decoded bitmaps are held in memory at a time.
+ */
+class ImagePrefetcher {
+public:
+    /**
+     * @brief Starts decoding the given images in order.
+     * @param paths Images in the order they will be taken.
+     * @param max_long_side Longest side of the decoded images in pixels; 0 keeps the full resolution.
+     * @param workers Number of decode threads.
+     * @param lookahead Maximum number of images decoded ahead of the consumer.
+     * @param min_thumbnail_long_side Use embedded camera previews (EXIF or MPF) at least this large; 0 always decodes the image.
+     */
+    ImagePrefetcher(std::vector<std::filesystem::path> paths,
+                    int32_t max_long_side,
+                    std::size_t workers,
+                    std::size_t lookahead,
+                    int32_t min_thumbnail_long_side = 0);
+
+    /**
+     * @brief Waits for an image and hands it to the caller.
+     * @param index Position of the image in the constructor's path list.
+     * @return Decoded image, or std::nullopt when decoding failed or the image was already taken.
+     */
+    std::optional<PreparedImage> take(std::size_t index);
+
+    /**
+     * @brief Decodes one image, downscaling it while decoding when the format allows.
+     * @param path Image to decode.
+     * @param max_long_side Longest side in pixels; 0 keeps the full resolution.
+     * @param min_thumbnail_long_side Use the embedded camera preview when its long side reaches this size;
+     *        0 always decodes the image itself.
+     * @return Packed RGB image, or std::nullopt when the image cannot be decoded.
+     */
+    static std::optional<PreparedImage> decode(const std::filesystem::path& path,
+                                               int32_t max_long_side,
+                                               int32_t min_thumbnail_long_side = 0);
+
+private:
+    std::vector<std::filesystem::path> paths_;
+    int32_t max_long_side_{0};
+    int32_t min_thumbnail_long_side_{0};
+    OrderedPrefetcher<PreparedImage> queue_;
+};
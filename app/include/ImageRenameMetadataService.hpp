@@ -2,9 +2,11 @@
 #define IMAGE_RENAME_METADATA_SERVICE_HPP
 
 #include <chrono>
+#include <cstdint>
 #include <filesystem>
 #include <optional>
 #include <string>
+#include <vector>
 
 struct sqlite3;
 
@@ -72,6 +74,27 @@ public:
                                                 const std::optional<std::string>& date_prefix,
                                                 const std::optional<std::string>& place_prefix);
 
+    /**
+     * @brief JPEG preview stored in the EXIF thumbnail directory (IFD1) or the Multi-Picture Format index.
+     */
+    struct EmbeddedThumbnail {
+        /** @brief Encoded JPEG bytes of the preview. */
+        std::vector<uint8_t> jpeg;
+        /** @brief EXIF orientation of the main image (1-8), applied to the preview as well. */
+        int orientation{1};
+    };
+
+    /**
+     * @brief Reads the embedded EXIF preview of a JPEG without decoding the image.
+     *
+     * Only the APP1/APP2 segments and the preview bytes are read, so this stays cheap even for large
+     * photos. When both an EXIF thumbnail and an MPF preview exist, the larger one is returned.
+     *
+     * @param image_path Absolute or relative image file path.
+     * @return Preview bytes and orientation, or `std::nullopt` when the file has no JPEG preview.
+     */
+    static std::optional<EmbeddedThumbnail> extract_embedded_thumbnail(const std::filesystem::path& image_path);
+
 private:
     struct ExifMetadata {
         std::optional<std::string> capture_date;
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Runs LLM requests on a fixed set of reusable worker threads.
+ *
+ * Every job receives a cancellation flag that the caller can raise, for example
+ * when it stops waiting after a timeout. Clients poll the flag to abandon the
+ * request, so the worker is freed for the next job instead of a new thread being
+ * started next to the one still decoding. Jobs cancelled before they start are
+ * dropped and their futures report std::future_error (broken promise).
+ */
+class InferenceExecutor {
+public:
+    /** @brief Flag shared between a job and the caller waiting for it. */
+    using CancellationFlag = std::shared_ptr<std::atomic<bool>>;
+
+    /**
+     * @brief Result of submitting a job.
+     * @tparam T Value produced by the job.
+     */
+    template <typename T>
+    struct Submission {
+        /** @brief Future for the job's value or exception. */
+        std::future<T> result;
+        /** @brief Raise to ask the job to stop early. */
+        CancellationFlag cancel;
+    };
+
+    /**
+     * @brief Starts the worker threads.
+     * @param workers Number of worker threads; at least one is started.
+     */
+    explicit InferenceExecutor(std::size_t workers);
+
+    /**
+     * @brief Cancels outstanding jobs and joins the workers.
+     */
+    ~InferenceExecutor();
+
+    InferenceExecutor(const InferenceExecutor&) = delete;
+    InferenceExecutor& operator=(const InferenceExecutor&) = delete;
+
+    /**
+     * @brief Queues a job.
+     * @param job Callable taking the job's cancellation flag.
+     * @return Future for the job's result together with its cancellation flag.
+     */
+    template <typename Job>
+    auto submit(Job&& job) -> Submission<std::invoke_result_t<Job&, const std::atomic<bool>&>>
+    {
+        using Result = std::invoke_result_t<Job&, const std::atomic<bool>&>;
+        auto cancel = std::make_shared<std::atomic<bool>>(false);
+        auto task = std::make_shared<std::packaged_task<Result()>>(
+            [job = std::forward<Job>(job), cancel]() mutable { return job(*cancel); });
+        Submission<Result> submission{task->get_future(), cancel};
+        enqueue([task]() { (*task)(); }, std::move(cancel));
+        return submission;
+    }
+
+    /**
+     * @brief Raises the cancellation flag of every queued and running job.
+     */
+    void cancel_all();
+
+    /**
+     * @brief Blocks until no job is queued or running.
+     */
+    void wait_idle();
+
+private:
+    struct Task {
+        std::function<void()> run;
+        CancellationFlag cancel;
+    };
+
+    void enqueue(std::function<void()> run, CancellationFlag cancel);
+    void worker_loop();
+
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable idle_cv_;
+    std::deque<Task> queue_;
+    std::vector<CancellationFlag> running_;
+    bool stopping_{false};
+    std::vector<std::thread> workers_;
+};
@@ -3,7 +3,10 @@
 
 #include "ILLMClient.hpp"
 #include <Types.hpp>
+#include <atomic>
+#include <cstddef>
 #include <string>
+#include <vector>
 
 class LLMClient : public ILLMClient {
 public:
@@ -16,13 +19,28 @@ public:
                                 const std::string& file_path,
                                 FileType file_type,
                                 const std::string& consistency_context) override;
+    /**
+     * @brief Categorizes requests with one prompt per group of related items when batching is enabled.
+     * @return One raw response per request; empty for items the batched reply did not cover.
+     */
+    std::vector<std::string> categorize_files(const std::vector<CategorizationRequest>& requests) override;
+    std::size_t max_batch_size() const override;
+    /**
+     * @brief Sets how many items may share one categorization prompt.
+     * @param size Items per prompt, clamped to 1-RemoteBatchPrompt::kMaxBatchSize; 1 disables batching.
+     */
+    void set_batch_size(std::size_t size);
     std::string complete_prompt(const std::string& prompt,
                                 int max_tokens) override;
     void set_prompt_logging_enabled(bool enabled) override;
+    /**
+     * @brief Sets the flag that aborts the HTTP transfer in progress when raised.
+     */
+    void set_cancellation_flag(const std::atomic<bool>* flag) override;
 
 private:
     std::string api_key;
-    std::string send_api_request(std::string json_payload);
+    std::string send_api_request(std::string json_payload, std::size_t item_count = 1);
     std::string make_payload(const std::string &file_name,
                              const std::string &file_path,
                                 const FileType file_type,
@@ -36,6 +54,8 @@ private:
      */
     std::string resolve_api_url() const;
     bool prompt_logging_enabled{false};
+    std::size_t batch_size{1};
+    std::atomic<const std::atomic<bool>*> cancellation_flag{nullptr};
     std::string last_prompt;
     std::string model;
     std::string base_url;
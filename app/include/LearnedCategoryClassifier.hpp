@@ -0,0 +1,126 @@
+#pragma once
+
+#include "UserLearningStore.hpp"
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @brief On-device softmax regression over TextEmbeddingService vectors, trained from approved examples.
+ *
+ * Each approved file name and its stored context text are embedded with the local hashing
+ * model and fed to a multinomial logistic regression with one weight vector per
+ * category/subcategory pair. Training is incremental: new approvals are learned with a few
+ * stochastic gradient steps, and the model is refit only when a stored example changes label
+ * or disappears. Prediction costs one dot product per known label.
+ *
+ * The file extension is left out of the features, since it says little about the
+ * category and would otherwise let unrelated files of a common type inherit a label.
+ */
+class LearnedCategoryClassifier {
+public:
+    /**
+     * @brief Most likely labels for a file and the model's probability for them.
+     */
+    struct Prediction {
+        std::string category;
+        std::string subcategory;
+        /** @brief Softmax probability of the predicted label, in the range [0, 1]. */
+        double confidence{0.0};
+        /** @brief Number of approved examples behind the predicted label. */
+        std::size_t support{0};
+    };
+
+    /**
+     * @brief Minimum number of approved examples a label needs before it is predicted.
+     */
+    static constexpr std::size_t kMinimumExamplesPerLabel = 10;
+
+    /**
+     * @brief Minimum lead of the predicted label's probability over the runner-up.
+     */
+    static constexpr double kMinimumMargin = 0.5;
+
+    /**
+     * @brief Builds the text that is embedded for training and prediction.
+     * @param file_name File or directory name; a trailing extension is dropped.
+     * @param context_text Image description or document summary; may be empty.
+     * @return Text passed to TextEmbeddingService::embed.
+     */
+    static std::string feature_text(const std::string& file_name, const std::string& context_text);
+
+    /**
+     * @brief Brings the model up to date with the approved examples of a learning store.
+     * @param examples All approved examples, as returned by UserLearningStore::approved_examples().
+     *
+     * Examples imported from the whitelist are ignored because they carry no file evidence.
+     */
+    void sync(const std::vector<UserLearningStore::ApprovedExample>& examples);
+
+    /**
+     * @brief Learns one example.
+     * @param text Feature text, usually built with feature_text().
+     * @param category Approved main category.
+     * @param subcategory Approved subcategory.
+     *
+     * Examples learned this way are not tied to a store row and are dropped when sync() refits.
+     */
+    void train(const std::string& text, const std::string& category, const std::string& subcategory);
+
+    /**
+     * @brief Predicts the labels for a file.
+     * @param text Feature text, usually built with feature_text().
+     * @return Most likely labels, or std::nullopt when fewer than two labels are known, the text has no
+     *         features, the best label has fewer than kMinimumExamplesPerLabel examples, leads the runner-up
+     *         by less than kMinimumMargin, or shares no word with the examples it was trained on.
+     */
+    std::optional<Prediction> predict(const std::string& text) const;
+
+    /**
+     * @brief Forgets all labels and examples.
+     */
+    void clear();
+
+    /**
+     * @brief Returns the number of distinct labels the model knows.
+     */
+    std::size_t label_count() const { return labels_.size(); }
+
+    /**
+     * @brief Returns the number of examples the model has learned.
+     */
+    std::size_t example_count() const { return examples_.size(); }
+
+private:
+    struct Label {
+        std::string category;
+        std::string subcategory;
+        std::vector<float> weights;
+        std::size_t support{0};
+        /** Tokens with a letter seen in the label's examples. */
+        std::unordered_set<std::string> tokens;
+    };
+
+    struct Example {
+        std::vector<float> features;
+        std::size_t label{0};
+    };
+
+    std::size_t label_for(const std::string& category, const std::string& subcategory);
+    std::size_t add_example(const std::string& text, const std::string& category, const std::string& subcategory);
+    void learn_step(std::size_t example_index);
+    void learn(std::size_t example_index);
+    void fit();
+    std::vector<double> probabilities(const std::vector<float>& features) const;
+
+    std::vector<Label> labels_;
+    std::unordered_map<std::string, std::size_t> label_index_;
+    std::vector<Example> examples_;
+    /** Learning store row id -> index into examples_. */
+    std::unordered_map<int, std::size_t> synced_examples_;
+    unsigned int replay_state_{1};
+};
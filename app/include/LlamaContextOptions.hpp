@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Types.hpp"
+#include "llama.h"
+
+namespace LlamaContextOptions {
+
+/**
+ * @brief KV cache precision and attention mode resolved for one llama context.
+ */
+struct KvCacheConfig {
+    ggml_type type_k{GGML_TYPE_F16};
+    ggml_type type_v{GGML_TYPE_F16};
+    llama_flash_attn_type flash_attn{LLAMA_FLASH_ATTN_TYPE_AUTO};
+};
+
+/**
+ * @brief Resolves the user-facing KV cache options into llama context settings.
+ * @param cache_type Requested KV cache precision.
+ * @param flash_attention Requested flash-attention mode.
+ * @param memory_constrained True when the GPU estimation could not offload the whole model.
+ * @return Cache types and flash-attention mode to apply.
+ *
+ * Auto keeps f16 unless memory is constrained, then uses q8_0. A quantized V cache needs
+ * flash attention, so V stays f16 when flash attention is turned off.
+ */
+KvCacheConfig resolve(KvCacheType cache_type, FlashAttentionMode flash_attention, bool memory_constrained);
+
+/**
+ * @brief Writes a resolved configuration into llama context parameters.
+ * @param params Context parameters to update.
+ * @param config Resolved configuration.
+ */
+void apply(llama_context_params& params, const KvCacheConfig& config);
+
+/**
+ * @brief Returns a short label for a KV cache type, for logs.
+ * @param type Cache tensor type.
+ * @return Label such as "f16" or "q8_0".
+ */
+const char* type_label(ggml_type type);
+
+} // namespace LlamaContextOptions
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "llama.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Process-wide cache of loaded llama text models shared between LLM clients.
+ *
+ * Models are keyed by (path, backend, n_gpu_layers). Callers hold a shared handle and
+ * create their own llama_context from it. A model nobody holds stays resident so the
+ * next stage of an analysis can reuse it; idle models are evicted before a different
+ * model is loaded so two large models are never resident only because of a handover.
+ */
+class LlamaModelRegistry {
+public:
+    using ModelHandle = std::shared_ptr<llama_model>;
+    using Loader = std::function<llama_model*(const std::string& path, const llama_model_params& params)>;
+    using Releaser = std::function<void(llama_model*)>;
+
+    /**
+     * @brief A resident model matched by find().
+     */
+    struct Lookup {
+        ModelHandle model;
+        int n_gpu_layers{0};
+    };
+
+    /**
+     * @brief Constructs a registry with custom load/free functions.
+     * @param loader Loads a model; returns nullptr on failure.
+     * @param releaser Frees a model returned by the loader.
+     */
+    LlamaModelRegistry(Loader loader, Releaser releaser);
+    LlamaModelRegistry(const LlamaModelRegistry&) = delete;
+    LlamaModelRegistry& operator=(const LlamaModelRegistry&) = delete;
+
+    /**
+     * @brief Returns the registry backed by llama_model_load_from_file/llama_model_free.
+     * @return Process-wide registry instance.
+     */
+    static LlamaModelRegistry& instance();
+
+    /**
+     * @brief Finds a resident model for a path and backend regardless of its GPU layer count.
+     * @param path Model file path.
+     * @param backend Backend tag the model was requested with.
+     * @return Resident model and its GPU layer count, or std::nullopt.
+     */
+    std::optional<Lookup> find(const std::string& path, const std::string& backend);
+    /**
+     * @brief Returns the resident model for the key, loading it when necessary.
+     * @param path Model file path.
+     * @param backend Backend tag used as part of the key.
+     * @param params Model parameters; n_gpu_layers is part of the key.
+     * @return Shared model handle, or nullptr when loading failed.
+     */
+    ModelHandle acquire(const std::string& path, const std::string& backend, const llama_model_params& params);
+    /**
+     * @brief Frees every model that no client currently holds.
+     */
+    void release_idle();
+    /**
+     * @brief Drops the registry's reference to every resident model.
+     *
+     * Idle models are freed immediately; a model still held by a client is freed
+     * when that client releases it. Called on shutdown so no model outlives the
+     * ggml backends through static destruction.
+     */
+    void release_all();
+    /**
+     * @brief Returns the number of models currently resident.
+     * @return Resident model count.
+     */
+    std::size_t resident_count() const;
+
+private:
+    struct Entry {
+        std::string path;
+        std::string backend;
+        int n_gpu_layers{0};
+        ModelHandle model;
+    };
+
+    void release_idle_locked();
+
+    Loader loader_;
+    Releaser releaser_;
+    mutable std::mutex mutex_;
+    std::vector<Entry> entries_;
+};
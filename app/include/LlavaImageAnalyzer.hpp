@@ -4,12 +4,14 @@
 #include "VisualModelCatalog.hpp"
 
 #include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <filesystem>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #ifdef AI_FILE_SORTER_HAS_MTMD
@@ -68,6 +70,22 @@ public:
      * @return Analysis result with description and suggested name.
      */
     ImageAnalysisResult analyze(const std::filesystem::path& image_path) override;
+    /**
+     * @brief Analyze a prefetched image without decoding it on the inference thread.
+     * @param image Decoded RGB image; falls back to decoding image.path when empty.
+     * @return Analysis result with description and suggested name.
+     */
+    ImageAnalysisResult analyze(const PreparedImage& image) override;
+    /**
+     * @brief Longest side worth decoding, derived from the projector's input size.
+     * @return Maximum long side in pixels, or 0 when the projector size is unknown.
+     */
+    int32_t preferred_input_long_side() const override;
+    /**
+     * @brief Projector input size; smaller images would be upscaled before encoding.
+     * @return Minimum long side in pixels, or 0 when the projector size is unknown.
+     */
+    int32_t minimum_input_long_side() const override;
 
     /**
      * @brief Returns true if the image path has a supported extension.
@@ -78,19 +96,33 @@ public:
 
 private:
 #ifdef AI_FILE_SORTER_HAS_MTMD
+    /**
+     * @brief Runs the description and filename passes for a loaded bitmap.
+     * @param bitmap Loaded image bitmap.
+     * @param image_path Original image path, used for filename fallbacks.
+     * @param bitmap_load_ms Time spent decoding the bitmap.
+     * @param analysis_started Start of the analysis request, for total timing.
+     * @return Analysis result with description and suggested name.
+     */
+    ImageAnalysisResult analyze_bitmap(mtmd_bitmap* bitmap,
+                                       const std::filesystem::path& image_path,
+                                       double bitmap_load_ms,
+                                       std::chrono::steady_clock::time_point analysis_started);
     /**
      * @brief Runs inference on the given bitmap.
      * @param bitmap Input bitmap.
      * @param system_prompt Optional system prompt to apply via chat template.
      * @param user_prompt Prompt to run.
      * @param max_tokens Maximum tokens to generate.
+     * @param grammar Optional GBNF grammar that constrains the response.
      * @return Model response text.
      */
     std::string infer_text(mtmd_bitmap* bitmap,
                            std::string_view system_prompt,
                            const std::string& user_prompt,
                            int32_t max_tokens,
-                           ImageInferenceDiagnostics* diagnostics = nullptr);
+                           ImageInferenceDiagnostics* diagnostics = nullptr,
+                           const char* grammar = nullptr);
 #else
     /**
      * @brief Runs inference on the given bitmap (stub for non-MTMD builds).
@@ -98,13 +130,15 @@ private:
      * @param system_prompt Optional system prompt to apply via chat template.
      * @param user_prompt Prompt to run.
      * @param max_tokens Maximum tokens to generate.
+     * @param grammar Optional GBNF grammar that constrains the response.
      * @return Model response text.
      */
     std::string infer_text(void* bitmap,
                            std::string_view system_prompt,
                            const std::string& user_prompt,
                            int32_t max_tokens,
-                           ImageInferenceDiagnostics* diagnostics = nullptr);
+                           ImageInferenceDiagnostics* diagnostics = nullptr,
+                           const char* grammar = nullptr);
 #endif
     /**
      * @brief Sanitizes a suggested filename.
@@ -150,6 +184,9 @@ private:
     int32_t batch_size_{0};
     bool text_gpu_enabled_{false};
     bool mmproj_gpu_enabled_{false};
+    bool gpu_memory_constrained_{false};
+    int32_t projector_image_size_{0};
+    bool single_pass_enabled_{true};
     std::atomic<int32_t> image_batch_current_{0};
     std::atomic<int32_t> image_batch_total_{0};
     void initialize_context();
@@ -217,5 +254,17 @@ std::string description_system_prompt(VisualPromptPolicy policy);
 std::string description_user_prompt(VisualPromptPolicy policy);
 std::string filename_system_prompt(VisualPromptPolicy policy);
 std::string filename_user_prompt(VisualPromptPolicy policy, std::string_view description);
+/**
+ * @brief Returns the combined description-and-filename prompt for single-pass policies.
+ * @param policy Prompt policy.
+ * @return User prompt, or an empty string when the policy uses separate passes.
+ */
+std::string single_pass_user_prompt(VisualPromptPolicy policy);
+/**
+ * @brief Splits a single-pass reply into its description and filename.
+ * @param reply Raw model reply.
+ * @return Description and filename; std::nullopt when no description was produced.
+ */
+std::optional<std::pair<std::string, std::string>> parse_single_pass_reply(std::string_view reply);
 }
 #endif
@@ -1,12 +1,18 @@
 #pragma once
 
+#include "GpuLayerProfileCache.hpp"
 #include "ILLMClient.hpp"
 #include "Types.hpp"
 #include "llama.h"
+#include <atomic>
+#include <cstddef>
+#include <filesystem>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace spdlog { class logger; }
@@ -37,9 +43,25 @@ public:
      * @return True to retry on CPU; false to abort.
      */
     using FallbackDecisionCallback = std::function<bool(const std::string& reason)>;
+    /**
+     * @brief CPU thread counts used by the llama contexts.
+     */
+    struct ThreadTuning {
+        /** @brief Threads used while generating tokens. */
+        int n_threads{0};
+        /** @brief Threads used while evaluating prompt batches. */
+        int n_threads_batch{0};
+    };
 
+    /**
+     * @brief Loads the model and prepares the client.
+     * @param model_path Path to the GGUF model.
+     * @param fallback_decision_callback Decides whether GPU failures may fall back to CPU.
+     * @param state_dir Directory for GPU layer profiles and prompt state snapshots; empty disables both.
+     */
     explicit LocalLLMClient(const std::string& model_path,
-                            FallbackDecisionCallback fallback_decision_callback = {});
+                            FallbackDecisionCallback fallback_decision_callback = {},
+                            const std::string& state_dir = {});
     ~LocalLLMClient();
 
     std::string make_prompt(const std::string& file_name,
@@ -49,14 +71,52 @@ public:
     std::string generate_response(const std::string& prompt,
                                   int n_predict,
                                   bool apply_sanitizer = true,
-                                  const std::string& system_prompt = {});
+                                  const std::string& system_prompt = {},
+                                  bool constrain_output = false);
     std::string categorize_file(const std::string& file_name,
                                 const std::string& file_path,
                                 FileType file_type,
                                 const std::string& consistency_context) override;
+    /**
+     * @brief Categorizes several items by decoding their prompts as parallel llama sequences.
+     * @param requests Items to categorize.
+     * @return One sanitized response per request, in request order.
+     */
+    std::vector<std::string> categorize_files(const std::vector<CategorizationRequest>& requests) override;
+    std::size_t max_batch_size() const override;
     std::string complete_prompt(const std::string& prompt,
                                 int max_tokens) override;
     void set_prompt_logging_enabled(bool enabled) override;
+    /**
+     * @brief Sets the flag polled by llama's abort callback while decoding.
+     * @param flag Cancellation flag, or nullptr to clear it.
+     */
+    void set_cancellation_flag(const std::atomic<bool>* flag) override;
+    /**
+     * @brief Enables a GBNF grammar that forces categorization replies into "Category : Subcategory".
+     * @param enabled True to constrain categorize_file/categorize_files output.
+     */
+    void set_output_grammar_enabled(bool enabled);
+    /**
+     * @brief Selects the KV cache precision and flash-attention mode for new contexts.
+     * @param cache_type KV cache precision; Auto picks q8_0 when the model only partly fits in GPU memory.
+     * @param flash_attention Flash-attention mode.
+     */
+    void set_kv_cache_options(KvCacheType cache_type, FlashAttentionMode flash_attention);
+    /**
+     * @brief Benchmarks prompt evaluation and generation across thread counts and applies the fastest.
+     * @return Selected thread counts, or std::nullopt when calibration could not run.
+     */
+    std::optional<ThreadTuning> calibrate_threads();
+    /**
+     * @brief Applies previously calibrated thread counts to the llama contexts.
+     * @param tuning Thread counts to use; non-positive values are ignored.
+     */
+    void set_thread_counts(const ThreadTuning& tuning);
+    /**
+     * @brief Returns whether every model layer runs on the GPU, where CPU thread counts have no effect.
+     */
+    bool gpu_fully_offloaded() const { return gpu_fully_offloaded_; }
     /**
      * @brief Registers a status callback for runtime events.
      * @param callback Callback to invoke when status events occur.
@@ -74,21 +134,102 @@ private:
     llama_model_params prepare_model_params(const std::shared_ptr<spdlog::logger>& logger);
     llama_model_params load_model_or_throw(llama_model_params model_params,
                                            const std::shared_ptr<spdlog::logger>& logger);
+    /**
+     * @brief Loads the model with the cached GPU layer count when one is known, probing otherwise.
+     * @param logger Logger for diagnostics.
+     * @return Model parameters the model was loaded with.
+     */
+    llama_model_params load_model_with_profile(const std::shared_ptr<spdlog::logger>& logger);
+    /**
+     * @brief Stores the pending GPU layer profile once a context exists, or forgets it when creation failed.
+     * @param context_created True when the llama context was created with the loaded layer count.
+     */
+    void settle_gpu_layer_profile(bool context_created);
     void configure_context(int context_length, const llama_model_params& model_params);
+    /**
+     * @brief Resolves the KV cache options and writes them into ctx_params.
+     */
+    void apply_kv_cache_options();
+    /**
+     * @brief Frees the persistent llama context and sampler and forgets the cached prompt tokens.
+     */
+    void release_context();
+    void apply_thread_counts(const ThreadTuning& tuning);
+    /**
+     * @brief Replaces the shared model with a CPU-only instance from the model registry.
+     * @param cpu_params Model parameters with GPU offload disabled.
+     * @return True when the CPU model is loaded and active.
+     */
+    bool switch_to_cpu_model(const llama_model_params& cpu_params);
+    /**
+     * @brief Loads a saved prompt prefix into the persistent context when nothing in memory is reusable.
+     * @param snapshot_name File name of the snapshot for the current model, context and system prompt.
+     * @param prompt_tokens Tokens of the prompt about to be evaluated.
+     * @param logger Logger for diagnostics.
+     */
+    void restore_prompt_state(const std::string& snapshot_name,
+                              const std::vector<llama_token>& prompt_tokens,
+                              const std::shared_ptr<spdlog::logger>& logger);
+    /**
+     * @brief Writes the retained prompt prefix to disk when it is longer than the stored snapshot.
+     * @param snapshot_name File name of the snapshot for the current model, context and system prompt.
+     * @param n_keep Number of prompt tokens currently retained in the context.
+     * @param logger Logger for diagnostics.
+     */
+    void save_prompt_state(const std::string& snapshot_name,
+                           std::size_t n_keep,
+                           const std::shared_ptr<spdlog::logger>& logger);
+    /**
+     * @brief Lazily creates the multi-sequence context used by categorize_files.
+     * @param logger Logger for diagnostics.
+     * @return True when the batched context is available.
+     */
+    bool ensure_batch_context(const std::shared_ptr<spdlog::logger>& logger);
+    /**
+     * @brief Runs batched categorization on the multi-sequence context.
+     * @param requests Items to categorize.
+     * @param responses Output responses, one per request.
+     * @return False when batched decoding failed and the caller should fall back to sequential calls.
+     */
+    bool run_batched_categorization(const std::vector<CategorizationRequest>& requests,
+                                    std::vector<std::string>& responses);
     /**
      * @brief Emits a status event to the registered callback.
      * @param status Status event to emit.
      */
     void notify_status(Status status);
+    /**
+     * @brief llama abort callback; stops graph computation once the cancellation flag is raised.
+     * @param data The LocalLLMClient instance.
+     * @return True to abort the current decode.
+     */
+    static bool abort_requested(void* data);
 
     std::string model_path;
-    llama_model* model;
-    llama_context* ctx;
-    const llama_vocab *vocab;
-    llama_sampler* smpl;
+    std::filesystem::path state_dir_;
+    std::shared_ptr<llama_model> model_handle_;
+    std::string backend_tag_;
+    llama_model* model{nullptr};
+    llama_context* ctx{nullptr};
+    const llama_vocab *vocab{nullptr};
+    llama_sampler* smpl{nullptr};
+    llama_sampler* grammar_smpl{nullptr};
+    bool output_grammar_enabled_{false};
+    KvCacheType kv_cache_type_{KvCacheType::Auto};
+    FlashAttentionMode flash_attention_{FlashAttentionMode::Auto};
+    bool gpu_memory_constrained_{false};
+    bool gpu_fully_offloaded_{false};
+    std::optional<GpuLayerProfileCache::Key> gpu_profile_key_;
+    int gpu_profile_layers_{0};
+    std::vector<llama_token> kv_tokens_;
+    std::unordered_map<std::string, std::size_t> prompt_state_tokens_;
+    llama_context* batch_ctx_{nullptr};
+    std::size_t batch_size_{1};
+    std::mutex generation_mutex_;
     std::string sanitize_output(const std::string& output);
     llama_context_params ctx_params;
     bool prompt_logging_enabled{false};
+    std::atomic<const std::atomic<bool>*> cancellation_flag_{nullptr};
     StatusCallback status_callback_;
     FallbackDecisionCallback fallback_decision_callback_;
     std::vector<Status> pending_statuses_;
@@ -5,6 +5,8 @@
 #include "LocalLLMClient.hpp"
 #include "Types.hpp"
 
+#include <cstddef>
+#include <functional>
 #include <optional>
 #include <string>
 #include <vector>
@@ -57,6 +59,43 @@ std::string categorization_user_prompt_for_testing(const std::string& file_name,
                                                    FileType file_type,
                                                    const std::string& consistency_context);
 std::string sanitize_output_for_testing(const std::string& output);
+/**
+ * @brief Computes how many cached KV tokens can be kept when evaluating the next prompt.
+ * @param cached_tokens Tokens currently resident in the persistent context.
+ * @param prompt_tokens Tokens of the next prompt.
+ * @return Length of the shared prefix, capped so at least one prompt token is decoded.
+ */
+std::size_t reusable_prefix_length_for_testing(const std::vector<llama_token>& cached_tokens,
+                                               const std::vector<llama_token>& prompt_tokens);
+/**
+ * @brief Lists the thread counts the CPU thread calibration compares.
+ * @param hardware_threads Logical thread count reported by the system.
+ * @return Distinct candidate thread counts, largest first.
+ */
+std::vector<int> thread_calibration_candidates_for_testing(unsigned int hardware_threads);
+/**
+ * @brief Trims hint, file-context and candidate sections of a user prompt by a token count.
+ * @param prompt User prompt built for categorization.
+ * @param overflow_tokens Number of tokens to remove.
+ * @param token_pieces Splits a section into the text pieces of its tokens.
+ * @return Prompt with the lowest-priority sections shortened first.
+ */
+std::string fit_user_prompt_sections_for_testing(
+    const std::string& prompt,
+    int overflow_tokens,
+    const std::function<std::vector<std::string>(const std::string&)>& token_pieces);
+/**
+ * @brief Builds the file name of the on-disk prompt state snapshot.
+ * @param model_path Path to the GGUF model.
+ * @param backend_tag Backend the model was loaded for.
+ * @param system_prompt System prompt that starts the cached prefix.
+ * @param params Context parameters of the persistent context.
+ * @return Snapshot file name derived from all inputs.
+ */
+std::string prompt_state_snapshot_name_for_testing(const std::string& model_path,
+                                                  const std::string& backend_tag,
+                                                  const std::string& system_prompt,
+                                                  const llama_context_params& params);
 
 } // namespace LocalLLMTestAccess
 
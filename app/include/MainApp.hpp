@@ -58,6 +58,7 @@ class MainWindowStateBinder;
 class WhitelistManagerDialog;
 class SuitabilityBenchmarkDialog;
 class AnalysisCoordinator;
+class LocalLLMClient;
 class StoragePluginManager;
 
 struct CategorizedFile;
@@ -302,6 +303,12 @@ private:
     void update_settings_action_states();
 
     std::unique_ptr<ILLMClient> make_llm_client();
+    /**
+     * @brief Applies stored CPU thread counts for a local model, calibrating them on first use.
+     * @param client Local client to tune; may run on an analysis worker thread.
+     * @param model_path Model file the thread counts are stored for.
+     */
+    void apply_local_thread_tuning(LocalLLMClient& client, const std::string& model_path);
     void notify_recategorization_reset(const std::vector<CategorizedFile>& entries,
                                        const std::string& reason);
     void notify_recategorization_reset(const CategorizedFile& entry,
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Produces items on worker threads a bounded distance ahead of an in-order consumer.
+ *
+ * Workers stay at most @c lookahead items ahead of the consumer, so only a few
+ * results are held in memory at a time. The consumer may skip items; skipped
+ * items stop holding back the window.
+ *
+ * @tparam T Item type handed to the consumer.
+ */
+template <typename T>
+class OrderedPrefetcher {
+public:
+    /**
+     * @brief Producer invoked on a worker thread for one item.
+     * @param index Position of the item.
+     * @return Item, or std::nullopt when it could not be produced.
+     */
+    using Producer = std::function<std::optional<T>(std::size_t index)>;
+
+    /**
+     * @brief Starts producing items in order.
+     * @param count Number of items.
+     * @param producer Callback producing one item; must be safe to call concurrently.
+     * @param workers Number of worker threads.
+     * @param lookahead Maximum number of items produced ahead of the consumer.
+     */
+    OrderedPrefetcher(std::size_t count, Producer producer, std::size_t workers, std::size_t lookahead)
+        : producer_(std::move(producer)),
+          lookahead_(std::max<std::size_t>(1, lookahead)),
+          slots_(count)
+    {
+        const std::size_t worker_count = std::min(std::max<std::size_t>(1, workers), count);
+        workers_.reserve(worker_count);
+        for (std::size_t i = 0; i < worker_count; ++i) {
+            workers_.emplace_back([this]() { worker_loop(); });
+        }
+    }
+
+    /**
+     * @brief Stops the workers and discards pending items.
+     */
+    ~OrderedPrefetcher()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        work_cv_.notify_all();
+        ready_cv_.notify_all();
+        for (auto& worker : workers_) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+    }
+
+    OrderedPrefetcher(const OrderedPrefetcher&) = delete;
+    OrderedPrefetcher& operator=(const OrderedPrefetcher&) = delete;
+
+    /**
+     * @brief Waits for an item and hands it to the caller.
+     * @param index Position of the item.
+     * @return Item, or std::nullopt when producing it failed or it was already taken.
+     */
+    std::optional<T> take(std::size_t index)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (index >= slots_.size()) {
+            return std::nullopt;
+        }
+        // Skipped items no longer hold back the window.
+        if (index > consumer_position_) {
+            for (std::size_t i = consumer_position_; i < index; ++i) {
+                if (slots_[i].state == SlotState::Ready) {
+                    slots_[i].item.reset();
+                    slots_[i].state = SlotState::Taken;
+                }
+            }
+            consumer_position_ = index;
+            work_cv_.notify_all();
+        }
+
+        auto& slot = slots_[index];
+        if (slot.state == SlotState::Taken || (index < consumer_position_ && slot.state != SlotState::Ready)) {
+            return std::nullopt;
+        }
+        ready_cv_.wait(lock, [&]() { return stopping_ || slot.state == SlotState::Ready; });
+        if (slot.state != SlotState::Ready) {
+            return std::nullopt;
+        }
+
+        std::optional<T> item = std::move(slot.item);
+        slot.item.reset();
+        slot.state = SlotState::Taken;
+        consumer_position_ = std::max(consumer_position_, index + 1);
+        work_cv_.notify_all();
+        return item;
+    }
+
+private:
+    enum class SlotState { Pending, Producing, Ready, Taken };
+
+    struct Slot {
+        SlotState state{SlotState::Pending};
+        std::optional<T> item;
+    };
+
+    void worker_loop()
+    {
+        while (true) {
+            std::size_t index = 0;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                work_cv_.wait(lock, [this]() {
+                    return stopping_ ||
+                           next_to_produce_ >= slots_.size() ||
+                           next_to_produce_ < consumer_position_ + lookahead_;
+                });
+                next_to_produce_ = std::max(next_to_produce_, consumer_position_);
+                if (stopping_ || next_to_produce_ >= slots_.size()) {
+                    return;
+                }
+                index = next_to_produce_++;
+                slots_[index].state = SlotState::Producing;
+            }
+
+            std::optional<T> item;
+            try {
+                item = producer_(index);
+            } catch (const std::exception&) {
+                // The consumer redoes the work itself and reports the error in context.
+                item.reset();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto& slot = slots_[index];
+                if (index < consumer_position_ && slot.state == SlotState::Producing) {
+                    // The consumer moved past this item while it was being produced.
+                    slot.state = SlotState::Taken;
+                } else {
+                    slot.item = std::move(item);
+                    slot.state = SlotState::Ready;
+                }
+            }
+            ready_cv_.notify_all();
+        }
+    }
+
+    Producer producer_;
+    std::size_t lookahead_{1};
+    std::vector<Slot> slots_;
+    std::size_t next_to_produce_{0};
+    std::size_t consumer_position_{0};
+    bool stopping_{false};
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable ready_cv_;
+    std::vector<std::thread> workers_;
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+class QImage;
+
+/**
+ * @brief Difference hashes (dHash) for spotting resized, re-encoded or lightly edited copies of an image.
+ */
+namespace PerceptualHash {
+
+/** @brief Default Hamming distance at or below which two images count as near duplicates. */
+inline constexpr int kDefaultNearDuplicateDistance = 5;
+
+/**
+ * @brief Computes the 64-bit dHash of a decoded image.
+ * @param image Image to hash.
+ * @return Hash, or std::nullopt when the image is empty or too flat to hash reliably.
+ */
+std::optional<std::uint64_t> compute(const QImage& image);
+
+/**
+ * @brief Decodes an image at a reduced scale and computes its dHash.
+ * @param path Image to hash.
+ * @return Hash, or std::nullopt when the image cannot be decoded or is too flat.
+ */
+std::optional<std::uint64_t> compute(const std::filesystem::path& path);
+
+/**
+ * @brief Counts the differing bits between two hashes.
+ * @param lhs First hash.
+ * @param rhs Second hash.
+ * @return Hamming distance in the range 0-64.
+ */
+int distance(std::uint64_t lhs, std::uint64_t rhs);
+
+/**
+ * @brief Remembers hashed images and finds the closest earlier one within a distance limit.
+ */
+class NearDuplicateIndex {
+public:
+    /**
+     * @brief Match returned by find().
+     */
+    struct Match {
+        std::string key;
+        int distance{0};
+    };
+
+    /**
+     * @brief Creates an empty index.
+     * @param max_distance Largest Hamming distance treated as a near duplicate.
+     */
+    explicit NearDuplicateIndex(int max_distance = kDefaultNearDuplicateDistance);
+
+    /**
+     * @brief Adds an image to the index.
+     * @param key Caller-defined image key.
+     * @param hash Image hash.
+     */
+    void add(std::string key, std::uint64_t hash);
+
+    /**
+     * @brief Finds the closest indexed image.
+     * @param hash Hash of the image being looked up.
+     * @return Closest image within the distance limit, if any.
+     */
+    std::optional<Match> find(std::uint64_t hash) const;
+
+private:
+    int max_distance_;
+    std::vector<std::pair<std::uint64_t, std::string>> entries_;
+};
+
+} // namespace PerceptualHash
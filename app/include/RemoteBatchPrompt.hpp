@@ -0,0 +1,97 @@
+#pragma once
+
+#include "ILLMClient.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Packs several categorization requests into one remote prompt.
+ *
+ * Requests of the same extension family whose shared context (language,
+ * family guidance and whitelist) matches are listed together under a single
+ * copy of the system prompt and that context. Per-file blocks such as recent
+ * assignments and learned candidates are listed under their own item. The
+ * model answers with a JSON array of category/subcategory pairs; items missing
+ * from an unparsable or incomplete reply come back empty so the caller can
+ * request them on their own.
+ */
+namespace RemoteBatchPrompt {
+
+/**
+ * @brief Upper bound on the number of items placed in one batched prompt.
+ */
+constexpr std::size_t kMaxBatchSize = 32;
+
+/**
+ * @brief Sends one batched prompt covering item_count items and returns the model's raw reply.
+ */
+using BatchSender = std::function<std::string(const std::string& system_prompt,
+                                              const std::string& user_prompt,
+                                              std::size_t item_count)>;
+
+/**
+ * @brief Sends a single categorization request and returns the raw reply.
+ */
+using SingleSender = std::function<std::string(const ILLMClient::CategorizationRequest& request)>;
+
+/**
+ * @brief Consistency context split into the part a batch can share and the part that belongs to one file.
+ */
+struct ContextParts {
+    std::string shared;
+    std::string item;
+};
+
+/**
+ * @brief Splits a consistency context at its first per-file block.
+ * @param consistency_context Context built for one request.
+ * @return Shared guidance and whitelist text, and the trailing per-file candidates and hints.
+ */
+ContextParts split_context(const std::string& consistency_context);
+
+/**
+ * @brief Groups requests that can share one prompt.
+ * @param requests Requests to group.
+ * @param max_items Maximum number of requests per group.
+ * @return Request indices per group, in order of first appearance. Requests share a group when they
+ *         belong to the same extension family and their shared contexts match.
+ */
+std::vector<std::vector<std::size_t>> group_requests(
+    const std::vector<ILLMClient::CategorizationRequest>& requests,
+    std::size_t max_items);
+
+/**
+ * @brief Builds the user prompt listing a group of requests.
+ * @param requests All requests of the batch.
+ * @param indices Indices of the requests in the group; they share one shared context.
+ * @return Numbered item list with per-file context under each item, followed by the shared context.
+ */
+std::string build_user_prompt(const std::vector<ILLMClient::CategorizationRequest>& requests,
+                              const std::vector<std::size_t>& indices);
+
+/**
+ * @brief Parses a batched reply.
+ * @param reply Raw model reply; surrounding prose and code fences are ignored.
+ * @param count Number of items in the prompt.
+ * @return One "<Main category> : <Subcategory>" string per item; empty for items the reply does not cover.
+ */
+std::vector<std::string> parse_response(const std::string& reply, std::size_t count);
+
+/**
+ * @brief Categorizes requests with one prompt per group.
+ * @param requests Requests to categorize.
+ * @param max_items Maximum number of requests per prompt.
+ * @param send_batch Sends a prompt covering several requests.
+ * @param send_single Sends a request that has no group to share a prompt with.
+ * @return One raw response per request; empty where the request failed or the reply could not be parsed.
+ * @throws BackoffError when the server asks the client to slow down.
+ */
+std::vector<std::string> categorize(const std::vector<ILLMClient::CategorizationRequest>& requests,
+                                    std::size_t max_items,
+                                    const BatchSender& send_batch,
+                                    const SingleSender& send_single);
+
+} // namespace RemoteBatchPrompt
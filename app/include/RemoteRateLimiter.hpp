@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+/**
+ * @brief Token bucket shared by concurrent requests to a remote LLM API.
+ *
+ * Tokens refill at a steady rate up to a burst size, and each request takes one.
+ * When the server answers with a rate-limit error, pause() holds back every
+ * request until the server's Retry-After delay has passed.
+ */
+class RemoteRateLimiter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Creates a limiter.
+     * @param requests_per_minute Sustained request rate; 0 or less leaves the rate unlimited.
+     * @param burst Number of requests that may start back to back after an idle period.
+     */
+    RemoteRateLimiter(int requests_per_minute, std::size_t burst);
+
+    /**
+     * @brief Takes a token if one is available.
+     * @return Zero when a token was taken, otherwise the time until the next token
+     *         or the end of the current pause.
+     */
+    Clock::duration try_acquire();
+
+    /**
+     * @brief Waits for a token.
+     * @param stop_flag Cancellation flag checked while waiting.
+     * @return True when a token was taken; false when paused by the server or cancelled.
+     */
+    bool acquire(const std::atomic<bool>& stop_flag);
+
+    /**
+     * @brief Holds back all requests after the server reported a rate limit.
+     * @param delay Time to wait before the next request.
+     */
+    void pause(Clock::duration delay);
+
+    /**
+     * @brief Returns how long the current pause still lasts.
+     * @return Remaining pause, or zero when requests may proceed.
+     */
+    Clock::duration pause_remaining() const;
+
+private:
+    void refill(Clock::time_point now);
+
+    double tokens_per_second_{0.0};
+    double capacity_{1.0};
+    double tokens_{1.0};
+    Clock::time_point last_refill_;
+    Clock::time_point paused_until_;
+    mutable std::mutex mutex_;
+};
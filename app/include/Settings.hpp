@@ -317,6 +317,16 @@ public:
      * @param value True to enable image-only processing.
      */
     void set_process_images_only(bool value);
+    /**
+     * @brief Returns whether visual analysis may use embedded EXIF previews instead of decoding full images.
+     * @return True when fast visual mode is enabled.
+     */
+    bool get_fast_visual_mode() const;
+    /**
+     * @brief Enables or disables fast visual mode.
+     * @param value True to analyze embedded previews when they are large enough.
+     */
+    void set_fast_visual_mode(bool value);
     /**
      * @brief Returns whether document content analysis is enabled.
      * @return True when document analysis is enabled.
@@ -377,6 +387,16 @@ public:
      * @param value True to append document creation dates to categories.
      */
     void set_add_document_date_to_category(bool value);
+    /**
+     * @brief Returns the token budget for extractive document pre-summaries.
+     * @return Budget in tokens; 0 sends the full excerpt to the LLM.
+     */
+    int get_document_summary_tokens() const;
+    /**
+     * @brief Sets the token budget for extractive document pre-summaries.
+     * @param value Budget in tokens; 0 or less disables pre-summarization.
+     */
+    void set_document_summary_tokens(int value);
 
     /**
      * @brief Returns the current target sort folder path.
@@ -399,6 +419,128 @@ public:
      * @param value True to enable the consistency pass.
      */
     void set_consistency_pass_enabled(bool value);
+    /**
+     * @brief Returns whether local categorization replies are constrained by a grammar.
+     * @return True when the local LLM must answer in the "Category : Subcategory" shape.
+     */
+    bool get_constrain_local_categorization_output() const;
+    /**
+     * @brief Enables or disables grammar-constrained local categorization replies.
+     * @param value True to constrain local replies to the "Category : Subcategory" shape.
+     */
+    void set_constrain_local_categorization_output(bool value);
+    /**
+     * @brief Returns the calibrated CPU thread count for local token generation.
+     * @return Thread count, or 0 when no calibration is stored.
+     */
+    int get_local_llm_threads() const;
+    /**
+     * @brief Returns the calibrated CPU thread count for local prompt evaluation.
+     * @return Thread count, or 0 when no calibration is stored.
+     */
+    int get_local_llm_batch_threads() const;
+    /**
+     * @brief Returns the model/hardware profile the stored thread counts were calibrated for.
+     * @return Profile key, or an empty string when no calibration is stored.
+     */
+    std::string get_local_llm_thread_profile() const;
+    /**
+     * @brief Stores calibrated CPU thread counts for local inference.
+     * @param n_threads Thread count for token generation.
+     * @param n_threads_batch Thread count for prompt evaluation.
+     * @param profile Model/hardware profile the counts were measured for.
+     */
+    void set_local_llm_thread_tuning(int n_threads, int n_threads_batch, const std::string& profile);
+    /**
+     * @brief Returns the KV cache precision for local LLM contexts.
+     * @return Selected KV cache type.
+     */
+    KvCacheType get_local_kv_cache_type() const;
+    /**
+     * @brief Sets the KV cache precision for local LLM contexts.
+     * @param value KV cache type to use.
+     */
+    void set_local_kv_cache_type(KvCacheType value);
+    /**
+     * @brief Returns the flash-attention mode for local LLM contexts.
+     * @return Selected flash-attention mode.
+     */
+    FlashAttentionMode get_local_flash_attention() const;
+    /**
+     * @brief Sets the flash-attention mode for local LLM contexts.
+     * @param value Flash-attention mode to use.
+     */
+    void set_local_flash_attention(FlashAttentionMode value);
+    /**
+     * @brief Returns how many remote categorization requests may be in flight at once.
+     * @return Concurrent request limit; 1 sends requests one after another.
+     */
+    int get_remote_concurrency() const;
+    /**
+     * @brief Sets how many remote categorization requests may be in flight at once.
+     * @param value Concurrent request limit, clamped to 1-16.
+     */
+    void set_remote_concurrency(int value);
+    /**
+     * @brief Returns the request rate allowed against remote LLM APIs.
+     * @return Requests per minute; 0 leaves the rate unlimited.
+     */
+    int get_remote_requests_per_minute() const;
+    /**
+     * @brief Sets the request rate allowed against remote LLM APIs.
+     * @param value Requests per minute; 0 or less leaves the rate unlimited.
+     */
+    void set_remote_requests_per_minute(int value);
+    /**
+     * @brief Returns how many files may share one remote categorization prompt.
+     * @return Files per prompt; 1 sends one prompt per file.
+     */
+    int get_remote_batch_size() const;
+    /**
+     * @brief Sets how many files may share one remote categorization prompt.
+     * @param value Files per prompt, clamped to 1-32.
+     */
+    void set_remote_batch_size(int value);
+    /**
+     * @brief Returns whether deterministic fast-path rules may categorize files without the LLM.
+     * @return True when fast-path rules are applied.
+     */
+    bool get_fast_path_rules_enabled() const;
+    /**
+     * @brief Enables or disables deterministic fast-path rules.
+     * @param value True to categorize rule-matched files without the LLM.
+     */
+    void set_fast_path_rules_enabled(bool value);
+    /**
+     * @brief Returns the confidence the learned classifier needs to answer without the LLM.
+     * @return Threshold in percent; 0 disables the learned classifier.
+     */
+    int get_learned_classifier_threshold() const;
+    /**
+     * @brief Sets the confidence the learned classifier needs to answer without the LLM.
+     * @param value Threshold in percent, clamped to 0-100; 0 disables the learned classifier.
+     */
+    void set_learned_classifier_threshold(int value);
+    /**
+     * @brief Returns whether files whose names differ only by numbers, dates or ids share one categorization.
+     * @return True when sibling files are clustered by name template.
+     */
+    bool get_filename_clustering_enabled() const;
+    /**
+     * @brief Enables or disables filename-template clustering.
+     * @param value True to categorize one representative per cluster and reuse its result.
+     */
+    void set_filename_clustering_enabled(bool value);
+    /**
+     * @brief Returns how many cluster members are categorized on their own to confirm the representative.
+     * @return Number of verification samples per cluster.
+     */
+    int get_cluster_verification_samples() const;
+    /**
+     * @brief Sets how many cluster members are categorized on their own to confirm the representative.
+     * @param value Number of samples, clamped to 0-8.
+     */
+    void set_cluster_verification_samples(int value);
 
     /**
      * @brief Returns whether category whitelists are enabled.
@@ -597,12 +739,14 @@ private:
     bool image_options_expanded{false};
     bool rename_images_only{false};
     bool process_images_only{false};
+    bool fast_visual_mode{false};
     bool analyze_documents_by_content{false};
     bool offer_rename_documents{false};
     bool document_options_expanded{false};
     bool rename_documents_only{false};
     bool process_documents_only{false};
     bool add_document_date_to_category{false};
+    int document_summary_tokens{0};
     bool use_consistency_hints{false};
     bool use_whitelist{false};
     std::string default_sort_folder;
@@ -616,6 +760,19 @@ private:
     Language language{Language::English};
     CategoryLanguage category_language{CategoryLanguage::English};
     bool consistency_pass_enabled{false};
+    bool constrain_local_categorization_output{true};
+    int local_llm_threads{0};
+    int local_llm_batch_threads{0};
+    std::string local_llm_thread_profile;
+    KvCacheType local_kv_cache_type{KvCacheType::Auto};
+    FlashAttentionMode local_flash_attention{FlashAttentionMode::Auto};
+    int remote_concurrency{1};
+    int remote_requests_per_minute{0};
+    int remote_batch_size{1};
+    bool fast_path_rules_enabled{false};
+    int learned_classifier_threshold{0};
+    bool filename_clustering_enabled{true};
+    int cluster_verification_samples{1};
     bool development_prompt_logging{false};
     int categorized_file_count{0};
     int next_support_prompt_threshold{50};
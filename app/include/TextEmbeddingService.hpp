@@ -30,6 +30,12 @@ public:
      * @return Normalized vector with `dimension()` values, or all zeros for empty text.
      */
     static std::vector<float> embed(std::string_view text);
+    /**
+     * @brief Split text into the normalized tokens that embed() hashes.
+     * @param text Text to tokenize.
+     * @return Lower-case, singularized tokens of at least two characters.
+     */
+    static std::vector<std::string> tokens(std::string_view text);
     /**
      * @brief Compute cosine similarity between two embedding vectors.
      * @param lhs First vector.
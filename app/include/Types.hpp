@@ -23,6 +23,21 @@ inline bool is_remote_choice(LLMChoice choice) {
 
 enum class FileType {File, Directory};
 
+/// Precision of the KV cache used by local llama contexts.
+enum class KvCacheType {
+    Auto, ///< f16, or q8_0 when the model does not fit in GPU memory.
+    F16,
+    Q8_0,
+    Q4_0
+};
+
+/// Flash-attention mode for local llama contexts.
+enum class FlashAttentionMode {
+    Auto, ///< Let llama.cpp enable it where the backend supports it.
+    On,
+    Off
+};
+
 struct CategorizedFile {
     std::string file_path;
     std::string file_name;
@@ -24,6 +24,11 @@ enum class VisualPromptPolicy {
     LegacyLlava,
     /** @brief General instruction-tuned multimodal prompt wording. */
     StructuredVisionInstruct,
+    /**
+     * @brief Instruction-tuned wording that returns the description and filename in one
+     *        grammar-constrained generation, falling back to separate passes when needed.
+     */
+    StructuredSinglePass,
 };
 
 /**
@@ -3,11 +3,16 @@
 #include "AnalysisEntryRouter.hpp"
 #include "CategorizationProgressDialog.hpp"
 #include "DocumentTextAnalyzer.hpp"
+#include "FileFingerprint.hpp"
 #include "ImageAnalyzerFactory.hpp"
+#include "ImagePrefetcher.hpp"
 #include "ImageRenameMetadataService.hpp"
+#include "LlamaModelRegistry.hpp"
 #include "LlavaImageAnalyzer.hpp"
 #include "MainApp.hpp"
 #include "MediaRenameMetadataService.hpp"
+#include "OrderedPrefetcher.hpp"
+#include "PerceptualHash.hpp"
 #include "Utils.hpp"
 #include "VisualLlmRuntime.hpp"
 
@@ -18,9 +23,11 @@
 #include <cctype>
 #include <cstdlib>
 #include <filesystem>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <stdexcept>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -36,6 +43,48 @@ constexpr int kMinimumPromptBudgetTokens = 256;
 constexpr int kDefaultDocumentOutputTokens = 256;
 constexpr int kLocalDocumentCharsPerToken = 2;
 constexpr int kRemoteDocumentCharsPerToken = 4;
+constexpr std::size_t kVisualPrefetchWorkers = 2;
+constexpr std::size_t kVisualPrefetchLookahead = 3;
+constexpr std::size_t kDocumentPrefetchWorkers = 3;
+constexpr std::size_t kDocumentPrefetchLookahead = 4;
+constexpr int kMaxDocumentPrefetchLookahead = 32;
+
+std::vector<std::optional<std::uint64_t>> compute_perceptual_hashes(const std::vector<std::filesystem::path>& paths,
+                                                                   std::size_t workers,
+                                                                   const std::function<bool()>& should_stop)
+{
+    std::vector<std::optional<std::uint64_t>> hashes(paths.size());
+    std::atomic<std::size_t> next{0};
+    std::vector<std::thread> threads;
+    const std::size_t thread_count = std::min(std::max<std::size_t>(1, workers), paths.size());
+    threads.reserve(thread_count);
+    for (std::size_t t = 0; t < thread_count; ++t) {
+        threads.emplace_back([&]() {
+            for (std::size_t i = next.fetch_add(1); i < paths.size(); i = next.fetch_add(1)) {
+                if (should_stop()) {
+                    return;
+                }
+                hashes[i] = PerceptualHash::compute(paths[i]);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return hashes;
+}
+
+std::string near_duplicate_variant_name(const std::string& source_name,
+                                        const std::string& file_name,
+                                        int ordinal)
+{
+    const auto source = Utils::utf8_to_path(source_name);
+    auto extension = Utils::utf8_to_path(file_name).extension();
+    if (extension.empty()) {
+        extension = source.extension();
+    }
+    return Utils::path_to_utf8(source.stem()) + "_" + std::to_string(ordinal) + Utils::path_to_utf8(extension);
+}
 
 class AnalysisCancelled : public std::runtime_error {
 public:
@@ -851,6 +900,10 @@ void AnalysisCoordinator::execute()
                                                  .arg(percent, 0, 'f', 2)));
             };
             vision_settings.log_visual_output = app_.should_log_prompts();
+            vision_settings.n_threads = app_.settings.get_local_llm_threads();
+            vision_settings.n_threads_batch = app_.settings.get_local_llm_batch_threads();
+            vision_settings.kv_cache_type = app_.settings.get_local_kv_cache_type();
+            vision_settings.flash_attention = app_.settings.get_local_flash_attention();
 
             const bool allow_visual_cpu_fallback =
                 vision_settings.use_gpu && !visual_gpu_override.has_value();
@@ -974,11 +1027,59 @@ void AnalysisCoordinator::execute()
                 return ImageAnalyzerFactory::create(*visual_backend, vision_settings);
             };
 
+            // Identical image content analyzed earlier by the same model is reused wherever the file now lives.
+            const std::string visual_model_id =
+                visual_backend->descriptor ? visual_backend->descriptor->id : std::string();
+            std::unordered_map<std::string, std::string> image_fingerprints;
+            std::unordered_map<std::string, DatabaseManager::CachedImageAnalysis> content_cached_analyses;
+            std::vector<std::string> pending_image_keys;
+            std::vector<std::filesystem::path> pending_image_paths;
+            bool needs_visual_model = false;
+            for (const auto& entry : image_entries) {
+                const std::string key = entry_key(entry);
+                if ((rename_images_only && renamed_files.contains(key)) ||
+                    cached_image_suggestions.contains(key)) {
+                    continue;
+                }
+                if (const auto fingerprint = FileFingerprint::compute(Utils::utf8_to_path(entry.full_path))) {
+                    if (auto cached = app_.db_manager.get_image_analysis(*fingerprint, visual_model_id)) {
+                        content_cached_analyses.emplace(key, std::move(*cached));
+                        continue;
+                    }
+                    image_fingerprints.emplace(key, *fingerprint);
+                }
+                pending_image_keys.push_back(key);
+                pending_image_paths.push_back(Utils::utf8_to_path(entry.full_path));
+                needs_visual_model = true;
+            }
+
+            // Bursts, resized copies and lightly edited exports reuse the analysis of a similar image.
+            std::unordered_map<std::string, std::uint64_t> image_hashes;
+            if (pending_image_paths.size() > 1 &&
+                read_env_bool("AI_FILE_SORTER_NEAR_DUPLICATE_IMAGES").value_or(true)) {
+                const auto hashes = compute_perceptual_hashes(pending_image_paths,
+                                                              kVisualPrefetchWorkers + 1,
+                                                              [this]() { return app_.should_abort_analysis(); });
+                for (std::size_t i = 0; i < hashes.size(); ++i) {
+                    if (hashes[i]) {
+                        image_hashes.emplace(pending_image_keys[i], *hashes[i]);
+                    }
+                }
+            }
+            if (app_.core_logger && !content_cached_analyses.empty()) {
+                app_.core_logger->info("Reusing {} cached image analysis result(s) matched by content",
+                                       content_cached_analyses.size());
+            }
+
             std::unique_ptr<ImageAnalyzer> analyzer;
             bool skip_visual_analysis = false;
             std::string skip_visual_reason;
+            // A text model still resident must not share memory with the visual model.
+            LlamaModelRegistry::instance().release_idle();
             try {
-                analyzer = create_analyzer();
+                if (needs_visual_model) {
+                    analyzer = create_analyzer();
+                }
             } catch (const std::exception& ex) {
                 const bool retry_on_cpu = should_retry_on_cpu(ex);
                 if (app_.core_logger) {
@@ -1059,6 +1160,50 @@ void AnalysisCoordinator::execute()
                     app_.mark_progress_stage_item_skipped(ProgressStageId::ImageAnalysis, entry);
                 }
             } else {
+                // Decode and downscale upcoming images while the visual model works on the current one.
+                std::unordered_map<std::string, std::size_t> prefetch_indices;
+                std::unique_ptr<ImagePrefetcher> image_prefetcher;
+                const int near_duplicate_distance = read_env_int("AI_FILE_SORTER_NEAR_DUPLICATE_DISTANCE")
+                                                        .value_or(PerceptualHash::kDefaultNearDuplicateDistance);
+                const int32_t prefetch_long_side = analyzer ? analyzer->preferred_input_long_side() : 0;
+                if (prefetch_long_side > 0 && read_env_bool("AI_FILE_SORTER_VISUAL_PREFETCH").value_or(true)) {
+                    // Images expected to reuse the analysis of an earlier similar image are not decoded.
+                    PerceptualHash::NearDuplicateIndex expected_sources(near_duplicate_distance);
+                    std::vector<std::filesystem::path> prefetch_paths;
+                    for (const auto& entry : image_entries) {
+                        const std::string key = entry_key(entry);
+                        if ((rename_images_only && renamed_files.contains(key)) ||
+                            cached_image_suggestions.contains(key) ||
+                            content_cached_analyses.contains(key)) {
+                            continue;
+                        }
+                        if (const auto hash_it = image_hashes.find(key); hash_it != image_hashes.end()) {
+                            if (expected_sources.find(hash_it->second)) {
+                                continue;
+                            }
+                            expected_sources.add(key, hash_it->second);
+                        }
+                        prefetch_indices.emplace(key, prefetch_paths.size());
+                        prefetch_paths.push_back(Utils::utf8_to_path(entry.full_path));
+                    }
+                    // Fast mode analyzes the camera's embedded preview when it covers the projector input.
+                    const bool fast_visual_mode = read_env_bool("AI_FILE_SORTER_VISUAL_FAST_MODE")
+                                                      .value_or(app_.settings.get_fast_visual_mode());
+                    const int32_t min_thumbnail_long_side =
+                        fast_visual_mode ? analyzer->minimum_input_long_side() : 0;
+                    if (!prefetch_paths.empty()) {
+                        image_prefetcher = std::make_unique<ImagePrefetcher>(std::move(prefetch_paths),
+                                                                             prefetch_long_side,
+                                                                             kVisualPrefetchWorkers,
+                                                                             kVisualPrefetchLookahead,
+                                                                             min_thumbnail_long_side);
+                    }
+                }
+
+                PerceptualHash::NearDuplicateIndex near_duplicates(near_duplicate_distance);
+                std::unordered_map<std::string, DatabaseManager::CachedImageAnalysis> near_duplicate_sources;
+                std::unordered_map<std::string, int> near_duplicate_counts;
+
                 bool stop_visual_analysis = false;
                 for (size_t index = 0; index < image_entries.size(); ++index) {
                     const auto& entry = image_entries[index];
@@ -1076,6 +1221,7 @@ void AnalysisCoordinator::execute()
                     cache_image_date(entry);
                     app_.mark_progress_stage_item_in_progress(ProgressStageId::ImageAnalysis, entry);
 
+                    std::optional<PreparedImage> prepared_image;
                     while (true) {
                         try {
                             if (has_cached_suggestion) {
@@ -1108,11 +1254,75 @@ void AnalysisCoordinator::execute()
                                 break;
                             }
 
-                            app_.append_progress(to_utf8(
-                                app_.tr("[VISION] Analyzing %1")
-                                    .arg(QString::fromStdString(entry.file_name))));
-                            const auto analysis = analyzer->analyze(entry.full_path);
-                            emit_visual_diagnostics(entry, analysis);
+                            ImageAnalysisResult analysis;
+                            std::optional<DatabaseManager::CachedImageAnalysis> content_hit;
+                            const auto fingerprint_it = image_fingerprints.find(entry_key(entry));
+                            if (const auto it = content_cached_analyses.find(entry_key(entry));
+                                it != content_cached_analyses.end()) {
+                                content_hit = it->second;
+                            } else if (fingerprint_it != image_fingerprints.end()) {
+                                // A duplicate earlier in this run may have been analyzed already.
+                                content_hit = app_.db_manager.get_image_analysis(fingerprint_it->second,
+                                                                                 visual_model_id);
+                            }
+                            const auto hash_it = image_hashes.find(entry_key(entry));
+                            std::optional<PerceptualHash::NearDuplicateIndex::Match> near_match;
+                            if (!content_hit && hash_it != image_hashes.end()) {
+                                near_match = near_duplicates.find(hash_it->second);
+                            }
+                            if (content_hit) {
+                                app_.append_progress(to_utf8(
+                                    app_.tr("[VISION] Reusing analysis of identical image for %1")
+                                        .arg(QString::fromStdString(entry.file_name))));
+                                analysis.description = content_hit->description;
+                                analysis.suggested_name = content_hit->suggested_name;
+                            } else if (near_match) {
+                                const auto& source = near_duplicate_sources.at(near_match->key);
+                                const int ordinal = ++near_duplicate_counts[near_match->key] + 1;
+                                app_.append_progress(to_utf8(
+                                    app_.tr("[VISION] Reusing analysis of a similar image for %1")
+                                        .arg(QString::fromStdString(entry.file_name))));
+                                if (app_.core_logger) {
+                                    app_.core_logger->info("Image '{}' is a near duplicate (distance {}) of '{}'",
+                                                           entry.full_path,
+                                                           near_match->distance,
+                                                           near_match->key);
+                                }
+                                analysis.description = source.description;
+                                analysis.suggested_name =
+                                    near_duplicate_variant_name(source.suggested_name, entry.file_name, ordinal);
+                            } else {
+                                if (!analyzer) {
+                                    analyzer = create_analyzer();
+                                }
+                                app_.append_progress(to_utf8(
+                                    app_.tr("[VISION] Analyzing %1")
+                                        .arg(QString::fromStdString(entry.file_name))));
+                                if (!prepared_image && image_prefetcher) {
+                                    const auto prefetch_it = prefetch_indices.find(entry_key(entry));
+                                    if (prefetch_it != prefetch_indices.end()) {
+                                        prepared_image = image_prefetcher->take(prefetch_it->second);
+                                    }
+                                }
+                                analysis = prepared_image ? analyzer->analyze(*prepared_image)
+                                                          : analyzer->analyze(entry.full_path);
+                                emit_visual_diagnostics(entry, analysis);
+                                if (fingerprint_it != image_fingerprints.end() &&
+                                    !analysis.suggested_name.empty()) {
+                                    app_.db_manager.store_image_analysis(
+                                        fingerprint_it->second,
+                                        visual_model_id,
+                                        DatabaseManager::CachedImageAnalysis{analysis.description,
+                                                                             analysis.suggested_name});
+                                }
+                            }
+                            if (hash_it != image_hashes.end() && !near_match && !analysis.suggested_name.empty()) {
+                                near_duplicates.add(entry_key(entry), hash_it->second);
+                                near_duplicate_sources.insert_or_assign(
+                                    entry_key(entry),
+                                    DatabaseManager::CachedImageAnalysis{analysis.description,
+                                                                         analysis.suggested_name});
+                            }
                             const std::string prompt_name = analysis.suggested_name;
                             const std::string enriched_name = enrich_image_suggestion(entry, prompt_name);
                             const auto prompt_path = build_image_prompt_path(entry.full_path,
@@ -1314,7 +1524,17 @@ void AnalysisCoordinator::execute()
             const size_t char_budget =
                 resolve_document_char_budget(app_.using_local_llm, doc_settings.max_tokens);
             doc_settings.max_characters = std::min(doc_settings.max_characters, char_budget);
+            const int summary_tokens = read_env_int("AI_FILE_SORTER_DOCUMENT_SUMMARY_TOKENS")
+                                           .value_or(app_.settings.get_document_summary_tokens());
+            if (summary_tokens > 0) {
+                const size_t chars_per_token =
+                    app_.using_local_llm ? kLocalDocumentCharsPerToken : kRemoteDocumentCharsPerToken;
+                doc_settings.summary_characters = static_cast<size_t>(summary_tokens) * chars_per_token;
+            }
             DocumentTextAnalyzer doc_analyzer(doc_settings);
+            if (read_env_bool("AI_FILE_SORTER_DOCUMENT_EXCERPT_CACHE").value_or(true)) {
+                doc_analyzer.set_excerpt_cache(&app_.db_manager);
+            }
 
             auto llm = app_.make_llm_client();
             if (!llm) {
@@ -1322,6 +1542,37 @@ void AnalysisCoordinator::execute()
             }
             llm->set_prompt_logging_enabled(app_.should_log_prompts());
 
+            // Extract text for upcoming documents while the LLM works on the current one.
+            std::unordered_map<std::string, std::size_t> text_prefetch_indices;
+            std::vector<std::filesystem::path> text_prefetch_paths;
+            if (read_env_bool("AI_FILE_SORTER_DOCUMENT_PREFETCH").value_or(true)) {
+                for (const auto& entry : document_entries) {
+                    const std::string key = entry_key(entry);
+                    if ((rename_documents_only && renamed_files.contains(key)) ||
+                        cached_document_suggestions.contains(key)) {
+                        continue;
+                    }
+                    text_prefetch_indices.emplace(key, text_prefetch_paths.size());
+                    text_prefetch_paths.push_back(Utils::utf8_to_path(entry.full_path));
+                }
+            }
+            std::unique_ptr<OrderedPrefetcher<std::string>> text_prefetcher;
+            if (text_prefetch_paths.size() > 1) {
+                // Each buffered document holds its extracted text, so the override is kept to a small window.
+                const std::size_t lookahead = static_cast<std::size_t>(
+                    std::clamp(read_env_int("AI_FILE_SORTER_DOCUMENT_PREFETCH_LOOKAHEAD")
+                                   .value_or(static_cast<int>(kDocumentPrefetchLookahead)),
+                               1,
+                               kMaxDocumentPrefetchLookahead));
+                text_prefetcher = std::make_unique<OrderedPrefetcher<std::string>>(
+                    text_prefetch_paths.size(),
+                    [&doc_analyzer, &text_prefetch_paths](std::size_t index) -> std::optional<std::string> {
+                        return doc_analyzer.extract_text(text_prefetch_paths[index]);
+                    },
+                    std::min(kDocumentPrefetchWorkers, lookahead),
+                    lookahead);
+            }
+
             for (const auto& entry : document_entries) {
                 if (update_stop()) {
                     break;
@@ -1334,8 +1585,7 @@ void AnalysisCoordinator::execute()
                 const auto cached_suggestion_it = cached_document_suggestions.find(entry_key(entry));
                 const bool has_cached_suggestion = cached_suggestion_it != cached_document_suggestions.end();
                 if (add_document_date && !document_dates.contains(entry_key(entry))) {
-                    const auto date =
-                        DocumentTextAnalyzer::extract_creation_date(Utils::utf8_to_path(entry.full_path));
+                    const auto date = doc_analyzer.creation_date(Utils::utf8_to_path(entry.full_path));
                     if (date) {
                         document_dates.emplace(entry_key(entry), *date);
                     }
@@ -1373,7 +1623,17 @@ void AnalysisCoordinator::execute()
 
                     app_.append_progress(to_utf8(
                         app_.tr("[DOC] Analyzing %1").arg(QString::fromStdString(entry.file_name))));
-                    const auto analysis = doc_analyzer.analyze(Utils::utf8_to_path(entry.full_path), *llm);
+                    std::optional<std::string> prefetched_text;
+                    if (text_prefetcher) {
+                        if (const auto it = text_prefetch_indices.find(entry_key(entry));
+                            it != text_prefetch_indices.end()) {
+                            prefetched_text = text_prefetcher->take(it->second);
+                        }
+                    }
+                    const auto document_path = Utils::utf8_to_path(entry.full_path);
+                    const auto analysis = prefetched_text
+                                              ? doc_analyzer.analyze_text(document_path, *prefetched_text, *llm)
+                                              : doc_analyzer.analyze(document_path, *llm);
                     const std::string suggested_name =
                         already_renamed ? std::string() : analysis.suggested_name;
                     const std::string ui_suggested_name =
@@ -1815,4 +2075,7 @@ void AnalysisCoordinator::execute()
             app_.post_analysis_failure(std::string("Analysis error: ") + ex.what());
         }
     }
+
+    // Models stay resident between the stages of a run, not between runs.
+    LlamaModelRegistry::instance().release_idle();
 }
@@ -10,12 +10,13 @@
 #include <string_view>
 
 namespace {
-constexpr char kSoftwareCategory[] = "Software";
-constexpr char kInstallersCategory[] = "Installers";
-constexpr char kDriversCategory[] = "Drivers";
-constexpr char kOperatingSystemsCategory[] = "Operating Systems";
-constexpr char kArchivesCategory[] = "Archives";
-constexpr char kDataExportsCategory[] = "Data Exports";
+using ArtifactCategoryPolicy::kArchivesCategory;
+using ArtifactCategoryPolicy::kDataExportsCategory;
+using ArtifactCategoryPolicy::kDriversCategory;
+using ArtifactCategoryPolicy::kInstallersCategory;
+using ArtifactCategoryPolicy::kOperatingSystemsCategory;
+using ArtifactCategoryPolicy::kSoftwareCategory;
+
 constexpr char kOtherCategory[] = "Other";
 constexpr char kGeneralSubcategory[] = "General";
 
@@ -0,0 +1,39 @@
+#include "CategorizationPrompt.hpp"
+
+namespace {
+
+constexpr const char* kRole = "You are a file categorization assistant. ";
+
+constexpr const char* kGuidance =
+    "If it's an installer, describe the type of software it installs. "
+    "Consider the filename, extension, and any directory context provided. If the user prompt includes an "
+    "'Allowed main categories' list, choose the main category from that list only. Use Other only when it is "
+    "listed and none of the other listed main categories clearly fits. ";
+
+constexpr const char* kLabelRules =
+    "Main category must be broad (one or two words, plural). "
+    "Subcategory must be specific, relevant, and must not repeat the main category.";
+
+} // namespace
+
+namespace CategorizationPrompt {
+
+const std::string& single_item_system_prompt()
+{
+    static const std::string kPrompt = std::string(kRole) + kGuidance +
+        "Always reply with one line in the format <Main category> : <Subcategory>. " + kLabelRules;
+    return kPrompt;
+}
+
+const std::string& batch_system_prompt()
+{
+    static const std::string kPrompt = std::string(kRole) +
+        "You receive a numbered list of items and categorize each one on its own. "
+        "Lines indented under an item apply to that item only; context after the list applies to every item. " +
+        kGuidance + kLabelRules +
+        " Reply with only a JSON array holding one object per item, in the order given: "
+        "[{\"id\": <item number>, \"category\": \"<Main category>\", \"subcategory\": \"<Subcategory>\"}].";
+    return kPrompt;
+}
+
+} // namespace CategorizationPrompt
@@ -1,12 +1,15 @@
 #include "CategorizationService.hpp"
 
 #include "ArtifactCategoryPolicy.hpp"
+#include "ConcurrentLLMClient.hpp"
 #include "FileCategoryPolicy.hpp"
+#include "InferenceExecutor.hpp"
 #include "Settings.hpp"
 #include "CategoryLanguage.hpp"
 #include "DatabaseManager.hpp"
 #include "ILLMClient.hpp"
 #include "LLMErrors.hpp"
+#include "RemoteRateLimiter.hpp"
 #include "UserLearningStore.hpp"
 #include "Utils.hpp"
 
@@ -27,15 +30,23 @@
 #include <cstdlib>
 #include <future>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <thread>
 #include <tuple>
+#include <unordered_map>
 #include <vector>
 
 namespace {
 constexpr const char* kLocalTimeoutEnv = "AI_FILE_SORTER_LOCAL_LLM_TIMEOUT";
 constexpr const char* kRemoteTimeoutEnv = "AI_FILE_SORTER_REMOTE_LLM_TIMEOUT";
 constexpr const char* kCustomTimeoutEnv = "AI_FILE_SORTER_CUSTOM_LLM_TIMEOUT";
+constexpr const char* kRemoteConcurrencyEnv = "AI_FILE_SORTER_REMOTE_CONCURRENCY";
+constexpr const char* kRemoteRequestsPerMinuteEnv = "AI_FILE_SORTER_REMOTE_REQUESTS_PER_MINUTE";
+constexpr int kMaxRemoteConcurrency = 16;
+// A client decodes one request at a time, so a single worker keeps requests from overlapping.
+constexpr std::size_t kInferenceWorkers = 1;
+constexpr const char* kFastPathRulesFile = "fast_path_rules.json";
 constexpr size_t kMaxConsistencyHints = 5;
 constexpr size_t kLargeWhitelistPromptThreshold = 30;
 constexpr size_t kMaxLargeWhitelistPromptCandidates = 8;
@@ -1080,6 +1091,113 @@ LabelValidationResult validate_labels(const std::string& category, const std::st
     return {true, {}};
 }
 
+// Reads a non-negative integer from the environment.
+std::optional<int> read_env_count(const char* key) {
+    const char* value = std::getenv(key);
+    if (!value || *value == '\0') {
+        return std::nullopt;
+    }
+    try {
+        const int parsed = std::stoi(value);
+        if (parsed >= 0) {
+            return parsed;
+        }
+    } catch (const std::exception&) {
+    }
+    return std::nullopt;
+}
+
+// Points a client at a job's cancellation flag for the duration of the job.
+class CancellationScope {
+public:
+    CancellationScope(ILLMClient& llm, const std::atomic<bool>& cancelled)
+        : llm_(llm)
+    {
+        llm_.set_cancellation_flag(&cancelled);
+    }
+
+    ~CancellationScope()
+    {
+        llm_.set_cancellation_flag(nullptr);
+    }
+
+    CancellationScope(const CancellationScope&) = delete;
+    CancellationScope& operator=(const CancellationScope&) = delete;
+
+private:
+    ILLMClient& llm_;
+};
+
+/**
+ * @brief Serves categorize_file calls from responses produced by an earlier batched request.
+ *
+ * Responses are keyed by prompt name, path and type only, so an entry whose hint block
+ * changed after the batch was submitted still uses its prefetched answer.
+ */
+class PrefetchingLLMClient : public ILLMClient {
+public:
+    explicit PrefetchingLLMClient(ILLMClient& inner)
+        : inner_(inner) {}
+
+    void store(const CategorizationRequest& request, std::string response)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        responses_[make_key(request.file_name, request.file_path, request.file_type)] = std::move(response);
+    }
+
+    std::string categorize_file(const std::string& file_name,
+                                const std::string& file_path,
+                                FileType file_type,
+                                const std::string& consistency_context) override
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = responses_.find(make_key(file_name, file_path, file_type));
+            if (it != responses_.end()) {
+                std::string response = std::move(it->second);
+                responses_.erase(it);
+                return response;
+            }
+        }
+        return inner_.categorize_file(file_name, file_path, file_type, consistency_context);
+    }
+
+    std::vector<std::string> categorize_files(const std::vector<CategorizationRequest>& requests) override
+    {
+        return inner_.categorize_files(requests);
+    }
+
+    std::size_t max_batch_size() const override
+    {
+        return inner_.max_batch_size();
+    }
+
+    std::string complete_prompt(const std::string& prompt, int max_tokens) override
+    {
+        return inner_.complete_prompt(prompt, max_tokens);
+    }
+
+    void set_prompt_logging_enabled(bool enabled) override
+    {
+        inner_.set_prompt_logging_enabled(enabled);
+    }
+
+    void set_cancellation_flag(const std::atomic<bool>* flag) override
+    {
+        inner_.set_cancellation_flag(flag);
+    }
+
+private:
+    static std::string make_key(const std::string& file_name, const std::string& file_path, FileType file_type)
+    {
+        return file_name + '\n' + file_path + '\n' + (file_type == FileType::Directory ? "D" : "F");
+    }
+
+    ILLMClient& inner_;
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::string> responses_;
+};
+
 }
 
 CategorizationService::CategorizationService(Settings& settings,
@@ -1089,7 +1207,12 @@ CategorizationService::CategorizationService(Settings& settings,
     : settings(settings),
       db_manager(db_manager),
       core_logger(std::move(core_logger)),
-      user_learning_store_(user_learning_store) {}
+      user_learning_store_(user_learning_store),
+      inference_executor_(std::make_unique<InferenceExecutor>(kInferenceWorkers)),
+      fast_path_categorizer_(FastPathCategorizer::from_file(
+          Utils::utf8_to_path(settings.get_config_dir()) / kFastPathRulesFile)) {}
+
+CategorizationService::~CategorizationService() = default;
 
 bool CategorizationService::ensure_remote_credentials(std::string* error_message) const
 {
@@ -1173,13 +1296,93 @@ std::vector<CategorizedFile> CategorizationService::categorize_entries(
         throw std::runtime_error("Failed to create LLM client.");
     }
 
+    if (!is_local_llm) {
+        const int concurrency = std::clamp(
+            read_env_count(kRemoteConcurrencyEnv).value_or(settings.get_remote_concurrency()),
+            1,
+            kMaxRemoteConcurrency);
+        if (concurrency > 1) {
+            // Concurrent requests are submitted as prefetch windows, so results are still
+            // committed in input order and consistency hints stay deterministic.
+            const int requests_per_minute =
+                read_env_count(kRemoteRequestsPerMinuteEnv).value_or(settings.get_remote_requests_per_minute());
+            auto limiter = std::make_shared<RemoteRateLimiter>(requests_per_minute,
+                                                               static_cast<std::size_t>(concurrency));
+            llm = std::make_unique<ConcurrentLLMClient>(std::move(llm),
+                                                        llm_factory,
+                                                        static_cast<std::size_t>(concurrency),
+                                                        std::move(limiter),
+                                                        stop_flag);
+            if (core_logger) {
+                core_logger->info("Categorizing with up to {} concurrent remote request(s){}",
+                                  concurrency,
+                                  requests_per_minute > 0
+                                      ? fmt::format(" at {} request(s)/min", requests_per_minute)
+                                      : std::string());
+            }
+        }
+    }
+
+    refresh_learned_classifier();
+    {
+        // Files may have changed since the previous run, so rule matches are only reused within one run.
+        std::lock_guard<std::mutex> lock(fast_path_mutex_);
+        fast_path_matches_.clear();
+    }
+
+    FilenameClusterPlan cluster_plan;
+    if (settings.get_filename_clustering_enabled()) {
+        // Entries with a prompt override are categorized from their own image description or document
+        // summary, which a sibling's name says nothing about.
+        cluster_plan = FilenameClusterPlan(
+            files,
+            static_cast<std::size_t>(settings.get_cluster_verification_samples()),
+            [&prompt_override](const FileEntry& entry) {
+                return prompt_override && prompt_override(entry).has_value();
+            });
+        if (core_logger && cluster_plan.cluster_count() > 0) {
+            core_logger->info("Grouped sibling files into {} filename cluster(s)", cluster_plan.cluster_count());
+        }
+    }
+
     categorized.reserve(files.size());
     SessionHistoryMap session_history;
+    PrefetchingLLMClient prefetching_llm(*llm);
+
+    // A request abandoned after a timeout may still be using the clients; stop it before they go away.
+    struct ExecutorDrain {
+        InferenceExecutor& executor;
+        ~ExecutorDrain()
+        {
+            executor.cancel_all();
+            executor.wait_idle();
+        }
+    } executor_drain{*inference_executor_};
+
+    const std::size_t batch_size = std::max<std::size_t>(1, llm->max_batch_size());
+    std::size_t prefetched_until = 0;
 
-    for (const auto& entry : files) {
+    for (std::size_t index = 0; index < files.size(); ++index) {
         if (stop_flag.load()) {
             break;
         }
+        const auto& entry = files[index];
+
+        if (batch_size > 1 && index >= prefetched_until) {
+            std::vector<PrefetchedCategorization> prefetched;
+            prefetched_until = prefetch_batch_categorizations(*llm,
+                                                              is_local_llm,
+                                                              files,
+                                                              index,
+                                                              batch_size,
+                                                              prompt_override,
+                                                              session_history,
+                                                              cluster_plan,
+                                                              prefetched);
+            for (auto& [request, response] : prefetched) {
+                prefetching_llm.store(request, std::move(response));
+            }
+        }
 
         if (queue_callback) {
             queue_callback(entry);
@@ -1188,16 +1391,25 @@ std::vector<CategorizedFile> CategorizationService::categorize_entries(
         const std::string suggested_name = suggested_name_provider
             ? suggested_name_provider(entry)
             : std::string();
-        const auto override_value = prompt_override ? prompt_override(entry) : std::nullopt;
-        if (auto categorized_entry = categorize_single_entry(*llm,
-                                                             is_local_llm,
-                                                             entry,
-                                                             override_value,
-                                                             suggested_name,
-                                                             stop_flag,
-                                                             progress_callback,
-                                                             recategorization_callback,
-                                                             session_history)) {
+        std::optional<CategorizedFile> categorized_entry;
+        if (const auto* representative = cluster_plan.representative_result(index)) {
+            categorized_entry = propagate_cluster_result(
+                entry, *representative, suggested_name, progress_callback, session_history);
+        }
+        if (!categorized_entry) {
+            const auto override_value = prompt_override ? prompt_override(entry) : std::nullopt;
+            categorized_entry = categorize_single_entry(prefetching_llm,
+                                                        is_local_llm,
+                                                        entry,
+                                                        override_value,
+                                                        suggested_name,
+                                                        stop_flag,
+                                                        progress_callback,
+                                                        recategorization_callback,
+                                                        session_history);
+            cluster_plan.record_result(index, categorized_entry);
+        }
+        if (categorized_entry) {
             categorized.push_back(*categorized_entry);
         }
 
@@ -1438,6 +1650,47 @@ std::string CategorizationService::build_learned_candidate_context(const std::st
     return oss.str();
 }
 
+std::optional<CategorizationService::CategoryPair> CategorizationService::fit_learned_labels(
+    const std::string& prompt_name,
+    FileType file_type,
+    std::string category,
+    std::string subcategory) const
+{
+    const bool use_whitelist = settings.get_use_whitelist();
+    std::tie(category, subcategory) = normalize_image_category_labels(prompt_name,
+                                                                      file_type,
+                                                                      category,
+                                                                      subcategory,
+                                                                      use_whitelist,
+                                                                      settings.get_allowed_categories());
+    std::tie(category, subcategory) = normalize_document_category_labels(prompt_name,
+                                                                         file_type,
+                                                                         category,
+                                                                         subcategory,
+                                                                         use_whitelist);
+    std::tie(category, subcategory) = normalize_artifact_category_labels(prompt_name,
+                                                                         file_type,
+                                                                         category,
+                                                                         subcategory,
+                                                                         use_whitelist);
+    if (!use_whitelist) {
+        const auto family_selection =
+            FileCategoryPolicy::determine_main_category_selection(prompt_name, file_type);
+        if (!family_selection.categories.empty() &&
+            !is_allowed(category, family_selection.categories)) {
+            return std::nullopt;
+        }
+        return CategoryPair{std::move(category), std::move(subcategory)};
+    }
+    if (!is_allowed(category, settings.get_allowed_categories())) {
+        return std::nullopt;
+    }
+    if (!subcategory.empty() && !is_allowed(subcategory, settings.get_allowed_subcategories())) {
+        return std::nullopt;
+    }
+    return CategoryPair{std::move(category), std::move(subcategory)};
+}
+
 DatabaseManager::ResolvedCategory CategorizationService::prefer_learned_candidate_for_generic_result(
     const DatabaseManager::ResolvedCategory& resolved,
     const std::string& prompt_name,
@@ -1462,40 +1715,11 @@ DatabaseManager::ResolvedCategory CategorizationService::prefer_learned_candidat
     }
 
     auto candidate = candidates.front();
-    std::tie(candidate.category, candidate.subcategory) = normalize_image_category_labels(prompt_name,
-                                                                                          file_type,
-                                                                                          candidate.category,
-                                                                                          candidate.subcategory,
-                                                                                          settings.get_use_whitelist(),
-                                                                                          settings.get_allowed_categories());
-    std::tie(candidate.category, candidate.subcategory) = normalize_document_category_labels(prompt_name,
-                                                                                             file_type,
-                                                                                             candidate.category,
-                                                                                             candidate.subcategory,
-                                                                                             settings.get_use_whitelist());
-    std::tie(candidate.category, candidate.subcategory) = normalize_artifact_category_labels(prompt_name,
-                                                                                             file_type,
-                                                                                             candidate.category,
-                                                                                             candidate.subcategory,
-                                                                                             settings.get_use_whitelist());
-    const auto allowed_categories = settings.get_allowed_categories();
-    const auto allowed_subcategories = settings.get_allowed_subcategories();
-    if (!settings.get_use_whitelist()) {
-        const auto family_selection =
-            FileCategoryPolicy::determine_main_category_selection(prompt_name, file_type);
-        if (!family_selection.categories.empty() &&
-            !is_allowed(candidate.category, family_selection.categories)) {
-            return resolved;
-        }
-    }
-    if (settings.get_use_whitelist() && !is_allowed(candidate.category, allowed_categories)) {
-        return resolved;
-    }
-    if (settings.get_use_whitelist() &&
-        !candidate.subcategory.empty() &&
-        !is_allowed(candidate.subcategory, allowed_subcategories)) {
+    const auto fitted = fit_learned_labels(prompt_name, file_type, candidate.category, candidate.subcategory);
+    if (!fitted) {
         return resolved;
     }
+    std::tie(candidate.category, candidate.subcategory) = *fitted;
 
     const bool generic_category = is_low_information_label(resolved.category);
     const bool same_category = to_lower_copy_str(resolved.category) ==
@@ -1816,18 +2040,7 @@ std::optional<CategorizedFile> CategorizationService::categorize_single_entry(
     const std::string prompt_path = prompt_override ? prompt_override->path : entry.full_path;
     const std::string prompt_path_display = Utils::abbreviate_user_path(prompt_path);
     const bool use_consistency_hints = settings.get_use_consistency_hints();
-    const bool rich_image_context = has_image_description_context(prompt_path);
-    const std::string extension = extract_extension(entry.file_name);
-    const std::string signature = make_file_signature(entry.type, extension);
-    std::string hint_block;
-    if (use_consistency_hints && !rich_image_context) {
-        const auto hints = collect_consistency_hints(signature, session_history, extension, entry.type);
-        hint_block = format_hint_block(hints);
-    }
-    const std::string combined_context = build_combined_context(hint_block,
-                                                                prompt_name,
-                                                                prompt_path,
-                                                                entry.type);
+    const std::string combined_context = build_entry_context(entry, prompt_name, prompt_path, session_history);
 
     DatabaseManager::ResolvedCategory resolved;
     bool retried_after_backoff = false;
@@ -1897,6 +2110,137 @@ std::optional<CategorizedFile> CategorizationService::categorize_single_entry(
     return result;
 }
 
+std::optional<CategorizedFile> CategorizationService::propagate_cluster_result(
+    const FileEntry& entry,
+    const CategorizedFile& representative,
+    const std::string& suggested_name,
+    const ProgressCallback& progress_callback,
+    SessionHistoryMap& session_history) const
+{
+    const std::filesystem::path entry_path = Utils::utf8_to_path(entry.full_path);
+    const std::string dir_path = Utils::path_to_utf8(entry_path.parent_path());
+    // Cached corrections and deterministic rules are more specific than a sibling's result.
+    if (has_valid_cached_categorization(dir_path, entry) || match_fast_path(entry)) {
+        return std::nullopt;
+    }
+
+    const DatabaseManager::ResolvedCategory resolved{
+        representative.taxonomy_id,
+        representative.canonical_category.empty() ? representative.category : representative.canonical_category,
+        representative.canonical_subcategory.empty() ? representative.subcategory
+                                                     : representative.canonical_subcategory};
+    update_storage_with_result(entry,
+                               dir_path,
+                               resolved,
+                               representative.used_consistency_hints,
+                               suggested_name,
+                               session_history);
+
+    const DatabaseManager::ResolvedCategory display_resolved{
+        representative.taxonomy_id, representative.category, representative.subcategory};
+    emit_progress_message(progress_callback,
+                          "CLUSTER",
+                          entry.file_name,
+                          display_resolved,
+                          Utils::abbreviate_user_path(entry.full_path),
+                          representative.file_name);
+
+    CategorizedFile result = representative;
+    result.file_path = dir_path;
+    result.file_name = entry.file_name;
+    result.type = entry.type;
+    result.from_cache = false;
+    result.suggested_name = suggested_name;
+    result.learning_context.clear();
+    return result;
+}
+
+std::string CategorizationService::build_entry_context(const FileEntry& entry,
+                                                       const std::string& prompt_name,
+                                                       const std::string& prompt_path,
+                                                       const SessionHistoryMap& session_history) const
+{
+    const bool rich_image_context = has_image_description_context(prompt_path);
+    const std::string extension = extract_extension(entry.file_name);
+    const std::string signature = make_file_signature(entry.type, extension);
+    std::string hint_block;
+    if (settings.get_use_consistency_hints() && !rich_image_context) {
+        const auto hints = collect_consistency_hints(signature, session_history, extension, entry.type);
+        hint_block = format_hint_block(hints);
+    }
+    return build_combined_context(hint_block, prompt_name, prompt_path, entry.type);
+}
+
+std::size_t CategorizationService::prefetch_batch_categorizations(
+    ILLMClient& llm,
+    bool is_local_llm,
+    const std::vector<FileEntry>& files,
+    std::size_t start_index,
+    std::size_t batch_size,
+    const PromptOverrideProvider& prompt_override,
+    const SessionHistoryMap& session_history,
+    const FilenameClusterPlan& cluster_plan,
+    std::vector<PrefetchedCategorization>& prefetched) const
+{
+    if (!is_local_llm && !ensure_remote_credentials()) {
+        return files.size();
+    }
+
+    std::vector<ILLMClient::CategorizationRequest> requests;
+    requests.reserve(batch_size);
+    std::size_t index = start_index;
+    for (; index < files.size() && requests.size() < batch_size; ++index) {
+        const auto& entry = files[index];
+        const std::filesystem::path entry_path = Utils::utf8_to_path(entry.full_path);
+        const std::string dir_path = Utils::path_to_utf8(entry_path.parent_path());
+        if (cluster_plan.will_propagate(index) ||
+            has_valid_cached_categorization(dir_path, entry) || match_fast_path(entry)) {
+            continue;
+        }
+        const auto override_value = prompt_override ? prompt_override(entry) : std::nullopt;
+        const std::string prompt_name = override_value ? override_value->name : entry.file_name;
+        const std::string prompt_path = override_value ? override_value->path : entry.full_path;
+        const std::string prompt_path_display = Utils::abbreviate_user_path(prompt_path);
+        if (match_learned_classifier(entry, prompt_path_display)) {
+            continue;
+        }
+        requests.push_back({prompt_name,
+                            prompt_path_display,
+                            entry.type,
+                            build_entry_context(entry, prompt_name, prompt_path, session_history)});
+    }
+
+    if (requests.size() < 2) {
+        return index;
+    }
+
+    try {
+        const int timeout_seconds = resolve_llm_timeout(is_local_llm) * static_cast<int>(requests.size());
+        auto submission = inference_executor_->submit([&llm, requests](const std::atomic<bool>& cancelled) {
+            CancellationScope scope(llm, cancelled);
+            return llm.categorize_files(requests);
+        });
+        if (submission.result.wait_for(std::chrono::seconds(timeout_seconds)) == std::future_status::timeout) {
+            submission.cancel->store(true);
+            throw std::runtime_error("Timed out waiting for batched LLM response");
+        }
+        const auto responses = submission.result.get();
+        for (std::size_t i = 0; i < requests.size() && i < responses.size(); ++i) {
+            if (!responses[i].empty()) {
+                prefetched.push_back({requests[i], responses[i]});
+            }
+        }
+        if (core_logger) {
+            core_logger->debug("Prefetched {} batched categorization(s)", requests.size());
+        }
+    } catch (const std::exception& ex) {
+        if (core_logger) {
+            core_logger->warn("Batched categorization failed ({}); categorizing entries individually", ex.what());
+        }
+    }
+    return index;
+}
+
 std::string CategorizationService::build_combined_context(const std::string& hint_block,
                                                           const std::string& prompt_name,
                                                           const std::string& prompt_path,
@@ -2152,6 +2496,31 @@ DatabaseManager::ResolvedCategory CategorizationService::run_categorization_with
     const ProgressCallback& progress_callback,
     const std::string& combined_context) const
 {
+    // Cached results still win, so user corrections are never overridden by a rule.
+    if (auto match = match_fast_path(entry); match && !has_valid_cached_categorization(dir_path, entry)) {
+        const auto resolved = db_manager.resolve_category(match->category, match->subcategory);
+        if (core_logger) {
+            core_logger->debug("Fast-path rule '{}' categorized '{}'", match->rule_name, entry.file_name);
+        }
+        const auto display_resolved = localize_resolved_category(llm, resolved);
+        emit_progress_message(progress_callback, "RULE", entry.file_name, display_resolved, display_path, prompt_path);
+        return resolved;
+    }
+
+    if (auto prediction = match_learned_classifier(entry, prompt_path);
+        prediction && !has_valid_cached_categorization(dir_path, entry)) {
+        const auto resolved = db_manager.resolve_category(prediction->category, prediction->subcategory);
+        if (core_logger) {
+            core_logger->debug("Learned classifier categorized '{}' with confidence {:.2f} from {} approval(s)",
+                               entry.file_name,
+                               prediction->confidence,
+                               prediction->support);
+        }
+        const auto display_resolved = localize_resolved_category(llm, resolved);
+        emit_progress_message(progress_callback, "LEARNED", entry.file_name, display_resolved, display_path, prompt_path);
+        return resolved;
+    }
+
     return categorize_with_cache(llm,
                                  is_local_llm,
                                  entry.file_name,
@@ -2164,6 +2533,79 @@ DatabaseManager::ResolvedCategory CategorizationService::run_categorization_with
                                  combined_context);
 }
 
+std::optional<FastPathCategorizer::Match> CategorizationService::match_fast_path(const FileEntry& entry) const
+{
+    if (!settings.get_fast_path_rules_enabled()) {
+        return std::nullopt;
+    }
+    std::optional<FastPathCategorizer::Match> match;
+    {
+        std::lock_guard<std::mutex> lock(fast_path_mutex_);
+        auto it = fast_path_matches_.find(entry.full_path);
+        if (it == fast_path_matches_.end()) {
+            it = fast_path_matches_.emplace(
+                entry.full_path,
+                fast_path_categorizer_.match(entry.file_name, entry.full_path, entry.type)).first;
+        }
+        match = it->second;
+    }
+    if (!match) {
+        return std::nullopt;
+    }
+    if (settings.get_use_whitelist() &&
+        (!is_allowed(match->category, settings.get_allowed_categories()) ||
+         !is_allowed(match->subcategory, settings.get_allowed_subcategories()))) {
+        return std::nullopt;
+    }
+    return match;
+}
+
+void CategorizationService::refresh_learned_classifier() const
+{
+    if (settings.get_learned_classifier_threshold() <= 0 ||
+        !user_learning_store_ || !user_learning_store_->is_open()) {
+        return;
+    }
+    const auto examples = user_learning_store_->approved_examples();
+    std::lock_guard<std::mutex> lock(learned_classifier_mutex_);
+    learned_classifier_.sync(examples);
+}
+
+std::optional<LearnedCategoryClassifier::Prediction> CategorizationService::match_learned_classifier(
+    const FileEntry& entry,
+    const std::string& prompt_path) const
+{
+    const int threshold = settings.get_learned_classifier_threshold();
+    if (threshold <= 0 || !user_learning_store_ || !user_learning_store_->is_open()) {
+        return std::nullopt;
+    }
+
+    std::optional<LearnedCategoryClassifier::Prediction> prediction;
+    {
+        std::lock_guard<std::mutex> lock(learned_classifier_mutex_);
+        prediction = learned_classifier_.predict(
+            LearnedCategoryClassifier::feature_text(entry.file_name, extract_learning_context_text(prompt_path)));
+    }
+    if (!prediction || prediction->confidence * 100.0 < threshold) {
+        return std::nullopt;
+    }
+    // The answer skips the LLM, so it must pass the same family and normalization rules as a model result.
+    const auto fitted = fit_learned_labels(entry.file_name, entry.type, prediction->category, prediction->subcategory);
+    if (!fitted || fitted->second.empty()) {
+        return std::nullopt;
+    }
+    std::tie(prediction->category, prediction->subcategory) = *fitted;
+    return prediction;
+}
+
+bool CategorizationService::has_valid_cached_categorization(const std::string& dir_path,
+                                                            const FileEntry& entry) const
+{
+    const auto cached = db_manager.get_categorization_from_db(dir_path, entry.file_name, entry.type);
+    return cached.size() >= 2 &&
+           validate_labels(Utils::sanitize_path_label(cached[0]), Utils::sanitize_path_label(cached[1])).valid;
+}
+
 std::optional<CategorizedFile> CategorizationService::handle_empty_result(
     const FileEntry& entry,
     const std::string& dir_path,
@@ -2238,13 +2680,15 @@ std::string CategorizationService::run_llm_with_timeout(
 {
     const int timeout_seconds = resolve_llm_timeout(is_local_llm);
 
-    auto future = start_llm_future(llm, item_name, item_path, file_type, consistency_context);
+    auto submission = start_llm_future(llm, item_name, item_path, file_type, consistency_context);
 
-    if (future.wait_for(std::chrono::seconds(timeout_seconds)) == std::future_status::timeout) {
+    if (submission.result.wait_for(std::chrono::seconds(timeout_seconds)) == std::future_status::timeout) {
+        // Ask the client to abandon the request so the next one does not queue behind it.
+        submission.cancel->store(true);
         throw std::runtime_error("Timed out waiting for LLM response");
     }
 
-    return future.get();
+    return submission.result.get();
 }
 
 int CategorizationService::resolve_llm_timeout(bool is_local_llm) const
@@ -2281,29 +2725,18 @@ int CategorizationService::resolve_llm_timeout(bool is_local_llm) const
     return timeout_seconds;
 }
 
-std::future<std::string> CategorizationService::start_llm_future(
+InferenceExecutor::Submission<std::string> CategorizationService::start_llm_future(
     ILLMClient& llm,
     const std::string& item_name,
     const std::string& item_path,
     FileType file_type,
     const std::string& consistency_context) const
 {
-    auto promise = std::make_shared<std::promise<std::string>>();
-    std::future<std::string> future = promise->get_future();
-
-    std::thread([&llm, promise, item_name, item_path, file_type, consistency_context]() mutable {
-        try {
-            promise->set_value(llm.categorize_file(item_name, item_path, file_type, consistency_context));
-        } catch (...) {
-            try {
-                promise->set_exception(std::current_exception());
-            } catch (...) {
-                // no-op
-            }
-        }
-    }).detach();
-
-    return future;
+    return inference_executor_->submit(
+        [&llm, item_name, item_path, file_type, consistency_context](const std::atomic<bool>& cancelled) {
+            CancellationScope scope(llm, cancelled);
+            return llm.categorize_file(item_name, item_path, file_type, consistency_context);
+        });
 }
 
 std::vector<CategorizationService::CategoryPair> CategorizationService::collect_consistency_hints(
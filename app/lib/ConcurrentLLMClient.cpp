@@ -0,0 +1,212 @@
+#include "ConcurrentLLMClient.hpp"
+
+#include "LLMErrors.hpp"
+#include "Logger.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <future>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+// Matches the wait CategorizationService applies when the server gives no delay.
+constexpr int kDefaultRetryAfterSeconds = 60;
+
+} // namespace
+
+ConcurrentLLMClient::ConcurrentLLMClient(std::unique_ptr<ILLMClient> primary,
+                                         Factory factory,
+                                         std::size_t concurrency,
+                                         std::shared_ptr<RemoteRateLimiter> limiter,
+                                         const std::atomic<bool>& stop_flag)
+    : factory_(std::move(factory)),
+      concurrency_(std::max<std::size_t>(1, concurrency)),
+      limiter_(std::move(limiter)),
+      stop_flag_(stop_flag)
+{
+    clients_.push_back(std::move(primary));
+    // The calling thread serves the first slot; the others run on reused workers.
+    if (concurrency_ > 1) {
+        slot_executor_ = std::make_unique<InferenceExecutor>(concurrency_ - 1);
+    }
+}
+
+ConcurrentLLMClient::~ConcurrentLLMClient() = default;
+
+std::string ConcurrentLLMClient::categorize_file(const std::string& file_name,
+                                                 const std::string& file_path,
+                                                 FileType file_type,
+                                                 const std::string& consistency_context)
+{
+    acquire_or_throw();
+    try {
+        return clients_.front()->categorize_file(file_name, file_path, file_type, consistency_context);
+    } catch (const BackoffError& backoff) {
+        pause_after(backoff.retry_after_seconds());
+        throw;
+    }
+}
+
+std::vector<std::string> ConcurrentLLMClient::categorize_files(const std::vector<CategorizationRequest>& requests)
+{
+    std::vector<std::string> responses(requests.size());
+    const std::size_t chunk_size = inner_batch_size();
+    const std::size_t chunk_count = (requests.size() + chunk_size - 1) / chunk_size;
+    std::atomic<std::size_t> next{0};
+
+    auto run_slot = [&](std::size_t slot, const std::atomic<bool>& cancel) {
+        ILLMClient* client = client_for_slot(slot);
+        if (!client) {
+            return;
+        }
+        for (std::size_t chunk = next++; chunk < chunk_count; chunk = next++) {
+            if (cancel.load() || (cancellation_flag_ && cancellation_flag_->load())) {
+                return;
+            }
+            // Once the server asks us to back off, the remaining items are left to the
+            // caller, which waits out the delay with progress feedback and cancellation.
+            if (!limiter_->acquire(stop_flag_)) {
+                return;
+            }
+            const std::size_t begin = chunk * chunk_size;
+            const std::size_t end = std::min(begin + chunk_size, requests.size());
+            try {
+                if (end - begin == 1) {
+                    const auto& request = requests[begin];
+                    responses[begin] = client->categorize_file(request.file_name,
+                                                               request.file_path,
+                                                               request.file_type,
+                                                               request.consistency_context);
+                    continue;
+                }
+                const std::vector<CategorizationRequest> chunk_requests(requests.begin() + begin,
+                                                                       requests.begin() + end);
+                auto chunk_responses = client->categorize_files(chunk_requests);
+                for (std::size_t i = 0; i < chunk_responses.size() && begin + i < end; ++i) {
+                    responses[begin + i] = std::move(chunk_responses[i]);
+                }
+            } catch (const BackoffError& backoff) {
+                pause_after(backoff.retry_after_seconds());
+                return;
+            } catch (const std::exception& ex) {
+                if (auto logger = Logger::get_logger("core_logger")) {
+                    logger->debug("Concurrent categorization of '{}' failed: {}",
+                                  requests[begin].file_name,
+                                  ex.what());
+                }
+            }
+        }
+    };
+
+    const std::size_t slots = std::min(concurrency_, chunk_count);
+    std::vector<InferenceExecutor::Submission<void>> submissions;
+    submissions.reserve(slots > 0 ? slots - 1 : 0);
+    for (std::size_t slot = 1; slot < slots; ++slot) {
+        submissions.push_back(slot_executor_->submit(
+            [&run_slot, slot](const std::atomic<bool>& cancel) { run_slot(slot, cancel); }));
+    }
+    const std::atomic<bool> not_cancelled{false};
+    run_slot(0, not_cancelled);
+    // run_slot handles its own errors, so waiting is enough; the responses are filled in place.
+    for (auto& submission : submissions) {
+        submission.result.wait();
+    }
+    return responses;
+}
+
+std::size_t ConcurrentLLMClient::max_batch_size() const
+{
+    return concurrency_ * inner_batch_size();
+}
+
+std::string ConcurrentLLMClient::complete_prompt(const std::string& prompt, int max_tokens)
+{
+    acquire_or_throw();
+    try {
+        return clients_.front()->complete_prompt(prompt, max_tokens);
+    } catch (const BackoffError& backoff) {
+        pause_after(backoff.retry_after_seconds());
+        throw;
+    }
+}
+
+void ConcurrentLLMClient::set_prompt_logging_enabled(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(clients_mutex_);
+    prompt_logging_enabled_ = enabled;
+    for (auto& client : clients_) {
+        if (client) {
+            client->set_prompt_logging_enabled(enabled);
+        }
+    }
+}
+
+void ConcurrentLLMClient::set_cancellation_flag(const std::atomic<bool>* flag)
+{
+    std::lock_guard<std::mutex> lock(clients_mutex_);
+    cancellation_flag_ = flag;
+    for (auto& client : clients_) {
+        if (client) {
+            client->set_cancellation_flag(flag);
+        }
+    }
+}
+
+std::size_t ConcurrentLLMClient::inner_batch_size() const
+{
+    // Every slot's client comes from the same factory, so the primary's batch size applies to all.
+    return std::max<std::size_t>(1, clients_.front()->max_batch_size());
+}
+
+ILLMClient* ConcurrentLLMClient::client_for_slot(std::size_t slot)
+{
+    std::lock_guard<std::mutex> lock(clients_mutex_);
+    while (clients_.size() <= slot) {
+        std::unique_ptr<ILLMClient> client;
+        try {
+            client = factory_ ? factory_() : nullptr;
+        } catch (const std::exception& ex) {
+            if (auto logger = Logger::get_logger("core_logger")) {
+                logger->warn("Failed to create an additional remote LLM client: {}", ex.what());
+            }
+        }
+        if (!client) {
+            return nullptr;
+        }
+        client->set_prompt_logging_enabled(prompt_logging_enabled_);
+        client->set_cancellation_flag(cancellation_flag_);
+        clients_.push_back(std::move(client));
+    }
+    return clients_[slot].get();
+}
+
+void ConcurrentLLMClient::acquire_or_throw()
+{
+    throw_if_paused();
+    if (!limiter_->acquire(stop_flag_)) {
+        throw_if_paused();
+        throw std::runtime_error("Remote request cancelled");
+    }
+}
+
+void ConcurrentLLMClient::throw_if_paused() const
+{
+    const auto remaining = limiter_->pause_remaining();
+    if (remaining <= RemoteRateLimiter::Clock::duration::zero()) {
+        return;
+    }
+    const auto seconds = std::chrono::ceil<std::chrono::seconds>(remaining).count();
+    throw BackoffError("Remote rate limit reached", static_cast<int>(seconds));
+}
+
+void ConcurrentLLMClient::pause_after(int retry_after_seconds)
+{
+    const int seconds = retry_after_seconds > 0 ? retry_after_seconds : kDefaultRetryAfterSeconds;
+    limiter_->pause(std::chrono::seconds(seconds));
+    if (auto logger = Logger::get_logger("core_logger")) {
+        logger->warn("Remote rate limit reached; pausing requests for {}s", seconds);
+    }
+}
@@ -225,6 +225,24 @@ std::optional<CategorizedFile> build_categorized_entry(sqlite3_stmt* stmt) {
     return entry;
 }
 
+std::optional<std::string> column_text_or_null(sqlite3_stmt* stmt, int column)
+{
+    if (sqlite3_column_type(stmt, column) == SQLITE_NULL) {
+        return std::nullopt;
+    }
+    const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, column));
+    return std::string(text ? text : "");
+}
+
+void bind_text_or_null(sqlite3_stmt* stmt, int index, const std::optional<std::string>& value)
+{
+    if (value) {
+        sqlite3_bind_text(stmt, index, value->c_str(), -1, SQLITE_TRANSIENT);
+    } else {
+        sqlite3_bind_null(stmt, index);
+    }
+}
+
 } // namespace
 
 DatabaseManager::DatabaseManager(std::string config_dir)
@@ -239,7 +257,11 @@ DatabaseManager::DatabaseManager(std::string config_dir)
         return;
     }
 
-    if (sqlite3_open(db_file.c_str(), &db) != SQLITE_OK) {
+    // Document prefetch workers read and write the excerpt cache through this connection.
+    if (sqlite3_open_v2(db_file.c_str(),
+                        &db,
+                        SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX,
+                        nullptr) != SQLITE_OK) {
         db_log(spdlog::level::err, "Can't open database: {}", sqlite3_errmsg(db));
         db = nullptr;
         return;
@@ -249,6 +271,8 @@ DatabaseManager::DatabaseManager(std::string config_dir)
 
     initialize_schema();
     initialize_taxonomy_schema();
+    initialize_image_analysis_schema();
+    initialize_document_excerpt_schema();
     load_taxonomy_cache();
     if (migrate_legacy_taxonomy_labels()) {
         load_taxonomy_cache();
@@ -421,6 +445,48 @@ void DatabaseManager::initialize_taxonomy_schema() {
     }
 }
 
+void DatabaseManager::initialize_image_analysis_schema() {
+    if (!db) return;
+
+    const char *create_table_sql = R"(
+        CREATE TABLE IF NOT EXISTS image_analysis_cache (
+            content_fingerprint TEXT NOT NULL,
+            model_id TEXT NOT NULL,
+            description TEXT NOT NULL,
+            suggested_name TEXT,
+            timestamp DATETIME DEFAULT CURRENT_TIMESTAMP,
+            PRIMARY KEY(content_fingerprint, model_id)
+        );
+    )";
+
+    char *error_msg = nullptr;
+    if (sqlite3_exec(db, create_table_sql, nullptr, nullptr, &error_msg) != SQLITE_OK) {
+        db_log(spdlog::level::err, "Failed to create image_analysis_cache table: {}", error_msg);
+        sqlite3_free(error_msg);
+    }
+}
+
+void DatabaseManager::initialize_document_excerpt_schema() {
+    if (!db) return;
+
+    const char *create_table_sql = R"(
+        CREATE TABLE IF NOT EXISTS document_excerpt_cache (
+            file_identity TEXT NOT NULL,
+            extractor_key TEXT NOT NULL,
+            excerpt TEXT,
+            creation_date TEXT,
+            timestamp DATETIME DEFAULT CURRENT_TIMESTAMP,
+            PRIMARY KEY(file_identity, extractor_key)
+        );
+    )";
+
+    char *error_msg = nullptr;
+    if (sqlite3_exec(db, create_table_sql, nullptr, nullptr, &error_msg) != SQLITE_OK) {
+        db_log(spdlog::level::err, "Failed to create document_excerpt_cache table: {}", error_msg);
+        sqlite3_free(error_msg);
+    }
+}
+
 void DatabaseManager::load_taxonomy_cache() {
     taxonomy_entries.clear();
     canonical_lookup.clear();
@@ -1720,6 +1786,8 @@ bool DatabaseManager::clear_all_categorizations(bool clear_taxonomy)
           "DELETE FROM category_alias;"
           "DELETE FROM category_taxonomy;"
           "DELETE FROM file_categorization;"
+          "DELETE FROM image_analysis_cache;"
+          "DELETE FROM document_excerpt_cache;"
         : "DELETE FROM file_categorization;";
     if (sqlite3_exec(db, delete_sql, nullptr, nullptr, &error_msg) != SQLITE_OK) {
         db_log(spdlog::level::err,
@@ -1770,6 +1838,133 @@ bool DatabaseManager::clear_all_categorizations(bool clear_taxonomy)
     return true;
 }
 
+std::optional<DatabaseManager::CachedImageAnalysis>
+DatabaseManager::get_image_analysis(const std::string& content_fingerprint,
+                                    const std::string& model_id) const {
+    if (!db || content_fingerprint.empty()) {
+        return std::nullopt;
+    }
+
+    const char* sql =
+        "SELECT description, suggested_name FROM image_analysis_cache "
+        "WHERE content_fingerprint = ? AND model_id = ? LIMIT 1;";
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        db_log(spdlog::level::err, "Failed to prepare image analysis lookup: {}", sqlite3_errmsg(db));
+        return std::nullopt;
+    }
+
+    sqlite3_bind_text(stmt, 1, content_fingerprint.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 2, model_id.c_str(), -1, SQLITE_TRANSIENT);
+
+    std::optional<CachedImageAnalysis> result;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char* description = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        const char* suggested_name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        result = CachedImageAnalysis{description ? description : "",
+                                     suggested_name ? suggested_name : ""};
+    }
+    sqlite3_finalize(stmt);
+    return result;
+}
+
+bool DatabaseManager::store_image_analysis(const std::string& content_fingerprint,
+                                           const std::string& model_id,
+                                           const CachedImageAnalysis& analysis) {
+    if (!db || content_fingerprint.empty()) {
+        return false;
+    }
+
+    const char* sql = R"(
+        INSERT INTO image_analysis_cache (content_fingerprint, model_id, description, suggested_name)
+        VALUES (?, ?, ?, ?)
+        ON CONFLICT(content_fingerprint, model_id)
+        DO UPDATE SET
+            description = excluded.description,
+            suggested_name = excluded.suggested_name,
+            timestamp = CURRENT_TIMESTAMP;
+    )";
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        db_log(spdlog::level::err, "Failed to prepare image analysis insert: {}", sqlite3_errmsg(db));
+        return false;
+    }
+
+    sqlite3_bind_text(stmt, 1, content_fingerprint.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 2, model_id.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 3, analysis.description.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 4, analysis.suggested_name.c_str(), -1, SQLITE_TRANSIENT);
+
+    const bool success = sqlite3_step(stmt) == SQLITE_DONE;
+    if (!success) {
+        db_log(spdlog::level::err, "Failed to cache image analysis: {}", sqlite3_errmsg(db));
+    }
+    sqlite3_finalize(stmt);
+    return success;
+}
+
+std::optional<DatabaseManager::CachedDocumentExcerpt>
+DatabaseManager::get_document_excerpt(const std::string& file_identity,
+                                      const std::string& extractor_key) const {
+    if (!db || file_identity.empty()) {
+        return std::nullopt;
+    }
+
+    const char* sql =
+        "SELECT excerpt, creation_date FROM document_excerpt_cache "
+        "WHERE file_identity = ? AND extractor_key = ? LIMIT 1;";
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        db_log(spdlog::level::err, "Failed to prepare document excerpt lookup: {}", sqlite3_errmsg(db));
+        return std::nullopt;
+    }
+
+    sqlite3_bind_text(stmt, 1, file_identity.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 2, extractor_key.c_str(), -1, SQLITE_TRANSIENT);
+
+    std::optional<CachedDocumentExcerpt> result;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        result = CachedDocumentExcerpt{column_text_or_null(stmt, 0), column_text_or_null(stmt, 1)};
+    }
+    sqlite3_finalize(stmt);
+    return result;
+}
+
+bool DatabaseManager::store_document_excerpt(const std::string& file_identity,
+                                             const std::string& extractor_key,
+                                             const CachedDocumentExcerpt& entry) {
+    if (!db || file_identity.empty()) {
+        return false;
+    }
+
+    const char* sql = R"(
+        INSERT INTO document_excerpt_cache (file_identity, extractor_key, excerpt, creation_date)
+        VALUES (?, ?, ?, ?)
+        ON CONFLICT(file_identity, extractor_key)
+        DO UPDATE SET
+            excerpt = COALESCE(excluded.excerpt, excerpt),
+            creation_date = COALESCE(excluded.creation_date, creation_date),
+            timestamp = CURRENT_TIMESTAMP;
+    )";
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        db_log(spdlog::level::err, "Failed to prepare document excerpt insert: {}", sqlite3_errmsg(db));
+        return false;
+    }
+
+    sqlite3_bind_text(stmt, 1, file_identity.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 2, extractor_key.c_str(), -1, SQLITE_TRANSIENT);
+    bind_text_or_null(stmt, 3, entry.excerpt);
+    bind_text_or_null(stmt, 4, entry.creation_date);
+
+    const bool success = sqlite3_step(stmt) == SQLITE_DONE;
+    if (!success) {
+        db_log(spdlog::level::err, "Failed to cache document excerpt: {}", sqlite3_errmsg(db));
+    }
+    sqlite3_finalize(stmt);
+    return success;
+}
+
 bool DatabaseManager::has_categorization_style_conflict(const std::string& dir_path,
                                                         bool desired_style,
                                                         bool recursive) const {
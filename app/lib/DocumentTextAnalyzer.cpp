@@ -1,5 +1,7 @@
 #include "DocumentTextAnalyzer.hpp"
 
+#include "DatabaseManager.hpp"
+#include "FileFingerprint.hpp"
 #include "ILLMClient.hpp"
 #include "Utils.hpp"
 
@@ -15,9 +17,6 @@
 #if defined(AI_FILE_SORTER_USE_LIBZIP)
 #include <zip.h>
 #endif
-#if defined(AI_FILE_SORTER_USE_PUGIXML)
-#include <pugixml.hpp>
-#endif
 
 #if __has_include(<jsoncpp/json/json.h>)
 #include <jsoncpp/json/json.h>
@@ -30,12 +29,17 @@
 #include <array>
 #include <algorithm>
 #include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
 #include <fstream>
 #include <initializer_list>
+#include <mutex>
 #include <regex>
 #include <sstream>
 #include <stdexcept>
 #include <string_view>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -43,6 +47,8 @@ namespace {
 constexpr size_t kMaxProcessOutput = 200000;
 constexpr std::size_t kZipMemberReadBufferBytes = 4096;
 constexpr int kPdfiumTextChunkChars = 4096;
+// Bump when extraction output changes so cached excerpts from older builds are ignored.
+constexpr int kExcerptExtractorVersion = 3;
 
 QString path_to_qstring(const std::filesystem::path& path) {
     const std::string utf8 = Utils::path_to_utf8(path);
@@ -105,71 +111,214 @@ std::vector<std::string> split_words(const QString& value) {
     return words;
 }
 
-std::string strip_xml_tags(const std::string& xml) {
-    std::string output;
-    output.reserve(xml.size());
-    bool in_tag = false;
-    for (char ch : xml) {
+// Collects the character data of an XML stream chunk by chunk, without building a DOM,
+// and stops once max_chars bytes of text have been gathered. Each text run is followed by
+// a space so adjacent cells and runs stay separated.
+class XmlTextCollector {
+public:
+    explicit XmlTextCollector(size_t max_chars)
+        : max_chars_(max_chars) {
+        text_.reserve(std::min<size_t>(max_chars, kZipMemberReadBufferBytes * 4));
+    }
+
+    bool full() const { return text_.size() >= max_chars_; }
+
+    /**
+     * @brief Consumes the next chunk of XML.
+     * @return False once the character budget is reached and further input is pointless.
+     */
+    bool feed(const char* data, size_t size) {
+        for (size_t i = 0; i < size && !full(); ++i) {
+            consume(data[i]);
+        }
+        return !full();
+    }
+
+    std::string finish() {
+        flush_entity();
+        end_run();
+        if (text_.size() > max_chars_) {
+            text_.resize(max_chars_);
+        }
+        return std::move(text_);
+    }
+
+private:
+    enum class Section { Text, Tag, Comment, CData };
+
+    void consume(char ch) {
+        switch (section_) {
+            case Section::Tag:
+                consume_tag(ch);
+                return;
+            case Section::Comment:
+                consume_comment(ch);
+                return;
+            case Section::CData:
+                consume_cdata(ch);
+                return;
+            case Section::Text:
+                break;
+        }
         if (ch == '<') {
-            in_tag = true;
-            continue;
+            flush_entity();
+            end_run();
+            section_ = Section::Tag;
+            markup_prefix_.clear();
+            matching_prefix_ = true;
+            return;
         }
-        if (ch == '>') {
-            in_tag = false;
-            continue;
+        if (in_entity_) {
+            if (ch == ';') {
+                in_entity_ = false;
+                append(decode_entity(entity_));
+            } else if (entity_.size() < kMaxEntityLength) {
+                entity_.push_back(ch);
+            } else {
+                flush_entity();
+                append(std::string_view(&ch, 1));
+            }
+            return;
         }
-        if (!in_tag) {
-            output.push_back(ch);
+        if (ch == '&') {
+            in_entity_ = true;
+            entity_.clear();
+            return;
         }
+        append(std::string_view(&ch, 1));
     }
-    return output;
-}
 
-void replace_all(std::string& value, std::string_view from, std::string_view to) {
-    if (from.empty()) {
-        return;
+    void consume_tag(char ch) {
+        if (matching_prefix_) {
+            markup_prefix_.push_back(ch);
+            if (markup_prefix_.size() == 1) {
+                // Declarations and processing instructions may hold unbalanced quotes.
+                track_quotes_ = ch != '!' && ch != '?';
+            }
+            if (markup_prefix_ == kCommentOpen || markup_prefix_ == kCDataOpen) {
+                section_ = markup_prefix_ == kCommentOpen ? Section::Comment : Section::CData;
+                closing_run_ = 0;
+                return;
+            }
+            if (kCommentOpen.starts_with(markup_prefix_) || kCDataOpen.starts_with(markup_prefix_)) {
+                return;
+            }
+            matching_prefix_ = false;
+        }
+        if (quote_ != 0) {
+            if (ch == quote_) {
+                quote_ = 0;
+            }
+        } else if (ch == '>') {
+            section_ = Section::Text;
+        } else if (track_quotes_ && (ch == '"' || ch == '\'')) {
+            quote_ = ch;
+        }
     }
-    size_t pos = 0;
-    while ((pos = value.find(from.data(), pos, from.size())) != std::string::npos) {
-        value.replace(pos, from.size(), to.data(), to.size());
-        pos += to.size();
+
+    // A comment ends only at "-->", so a '>' inside it is not a tag end.
+    void consume_comment(char ch) {
+        if (ch == '>' && closing_run_ >= 2) {
+            section_ = Section::Text;
+        }
+        closing_run_ = ch == '-' ? closing_run_ + 1 : 0;
     }
-}
 
-std::string decode_basic_entities(std::string value) {
-    replace_all(value, "&amp;", "&");
-    replace_all(value, "&lt;", "<");
-    replace_all(value, "&gt;", ">");
-    replace_all(value, "&quot;", "\"");
-    replace_all(value, "&apos;", "'");
-    return value;
-}
+    // CDATA content is literal text: markup and entities inside it are not interpreted.
+    void consume_cdata(char ch) {
+        if (ch == ']') {
+            ++closing_run_;
+            return;
+        }
+        if (ch == '>' && closing_run_ >= 2) {
+            append(std::string(closing_run_ - 2, ']'));
+            section_ = Section::Text;
+            return;
+        }
+        append(std::string(closing_run_, ']'));
+        closing_run_ = 0;
+        append(std::string_view(&ch, 1));
+    }
 
-#if defined(AI_FILE_SORTER_USE_PUGIXML)
-void append_node_text(const pugi::xml_node& node, std::string& out) {
-    if (node.type() == pugi::node_pcdata || node.type() == pugi::node_cdata) {
-        out.append(node.value());
-        out.push_back(' ');
+    void append(std::string_view value) {
+        if (value.empty()) {
+            return;
+        }
+        text_.append(value.data(), value.size());
+        run_open_ = true;
     }
-    for (const auto& child : node.children()) {
-        append_node_text(child, out);
+
+    void end_run() {
+        if (run_open_) {
+            text_.push_back(' ');
+            run_open_ = false;
+        }
+    }
+
+    void flush_entity() {
+        if (!in_entity_) {
+            return;
+        }
+        in_entity_ = false;
+        append("&");
+        append(entity_);
+    }
+
+    static std::string decode_entity(const std::string& name) {
+        if (name == "amp") return "&";
+        if (name == "lt") return "<";
+        if (name == "gt") return ">";
+        if (name == "quot") return "\"";
+        if (name == "apos") return "'";
+        if (name.size() > 1 && name[0] == '#') {
+            const bool hex = name[1] == 'x' || name[1] == 'X';
+            const std::string digits = name.substr(hex ? 2 : 1);
+            uint32_t code = 0;
+            const auto [end, error] =
+                std::from_chars(digits.data(), digits.data() + digits.size(), code, hex ? 16 : 10);
+            if (error == std::errc() && end == digits.data() + digits.size() && code > 0 && code <= 0x10FFFF) {
+                return encode_utf8(code);
+            }
+        }
+        return "&" + name + ";";
     }
-}
-#endif
 
-std::string extract_xml_text(const std::string& xml) {
-#if defined(AI_FILE_SORTER_USE_PUGIXML)
-    pugi::xml_document doc;
-    pugi::xml_parse_result result = doc.load_string(xml.c_str(), pugi::parse_default | pugi::parse_ws_pcdata);
-    if (result) {
+    static std::string encode_utf8(uint32_t code) {
         std::string out;
-        out.reserve(xml.size());
-        append_node_text(doc, out);
+        if (code < 0x80) {
+            out.push_back(static_cast<char>(code));
+        } else if (code < 0x800) {
+            out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        } else if (code < 0x10000) {
+            out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        } else {
+            out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        }
         return out;
     }
-#endif
-    return strip_xml_tags(xml);
-}
+
+    static constexpr size_t kMaxEntityLength = 10;
+    static constexpr std::string_view kCommentOpen = "!--";
+    static constexpr std::string_view kCDataOpen = "![CDATA[";
+
+    size_t max_chars_;
+    std::string text_;
+    std::string entity_;
+    std::string markup_prefix_;
+    Section section_{Section::Text};
+    bool matching_prefix_{false};
+    size_t closing_run_{0};
+    bool track_quotes_{true};
+    char quote_{0};
+    bool in_entity_{false};
+    bool run_open_{false};
+};
 
 std::optional<std::string> run_process(const QString& program,
                                        const QStringList& args,
@@ -240,6 +389,74 @@ std::optional<std::string> extract_zip_member_libzip(const std::filesystem::path
 }
 #endif
 
+#if defined(AI_FILE_SORTER_USE_LIBZIP)
+std::optional<std::string> extract_zip_member_text_libzip(const std::filesystem::path& path,
+                                                          std::initializer_list<QString> members,
+                                                          size_t max_chars) {
+    int error_code = 0;
+    const std::string archive_path = Utils::path_to_utf8(path);
+    zip_t* archive = zip_open(archive_path.c_str(), ZIP_RDONLY, &error_code);
+    if (!archive) {
+        return std::nullopt;
+    }
+    std::optional<std::string> result;
+    for (const auto& member : members) {
+        const QByteArray member_name = member.toUtf8();
+        zip_file_t* file = zip_fopen(archive, member_name.constData(), 0);
+        if (!file) {
+            continue;
+        }
+        XmlTextCollector collector(max_chars);
+        std::array<char, kZipMemberReadBufferBytes> buffer{};
+        zip_int64_t read = 0;
+        while ((read = zip_fread(file, buffer.data(), buffer.size())) > 0) {
+            if (!collector.feed(buffer.data(), static_cast<size_t>(read))) {
+                break;
+            }
+        }
+        zip_fclose(file);
+        std::string text = collector.finish();
+        if (!text.empty()) {
+            result = std::move(text);
+            break;
+        }
+    }
+    zip_close(archive);
+    return result;
+}
+#endif
+
+/**
+ * @brief Streams the first member with text out of an OOXML/ODF archive, stopping at max_chars.
+ */
+std::optional<std::string> extract_zip_member_text(const std::filesystem::path& path,
+                                                   std::initializer_list<QString> members,
+                                                   size_t max_chars,
+                                                   int timeout_ms)
+{
+#if defined(AI_FILE_SORTER_USE_LIBZIP)
+    if (auto text = extract_zip_member_text_libzip(path, members, max_chars)) {
+        return text;
+    }
+#endif
+    const auto unzip = find_executable(QStringLiteral("unzip"));
+    if (!unzip) {
+        return std::nullopt;
+    }
+    const QString file_path = path_to_qstring(path);
+    for (const auto& member : members) {
+        if (auto output = run_process(*unzip, {QStringLiteral("-p"), file_path, member}, timeout_ms)) {
+            XmlTextCollector collector(max_chars);
+            collector.feed(output->data(), output->size());
+            std::string text = collector.finish();
+            if (!text.empty()) {
+                return text;
+            }
+        }
+    }
+    return std::nullopt;
+}
+
 std::optional<std::string> extract_zip_member(const std::filesystem::path& path,
                                               std::initializer_list<QString> members,
                                               int timeout_ms)
@@ -320,32 +537,22 @@ std::optional<std::string> extract_docx_date(const std::filesystem::path& path)
     return std::nullopt;
 }
 
-std::optional<std::string> extract_pdf_date(const std::filesystem::path& path) {
-    const QString file_path = path_to_qstring(path);
-    if (const auto pdfinfo = find_executable(QStringLiteral("pdfinfo"))) {
-        if (auto output = run_process(*pdfinfo, {file_path}, 4000)) {
-            std::istringstream iss(*output);
-            std::string line;
-            while (std::getline(iss, line)) {
-                if (line.rfind("CreationDate", 0) == 0 || line.rfind("Creation Date", 0) == 0) {
-                    if (auto parsed = normalize_date(line)) {
-                        return parsed;
-                    }
-                }
-            }
-        }
+std::string extract_pdf_text_pdftotext(const std::filesystem::path& path, size_t max_chars) {
+    const auto pdftotext = find_executable(QStringLiteral("pdftotext"));
+    if (!pdftotext) {
+        return {};
     }
-
-    std::string raw = read_file_prefix(path, 200000);
-    if (raw.empty()) {
-        return std::nullopt;
+    const QString file_path = path_to_qstring(path);
+    auto output = run_process(*pdftotext,
+                              {QStringLiteral("-layout"), QStringLiteral("-q"), file_path, QStringLiteral("-")},
+                              15000);
+    if (!output) {
+        return {};
     }
-    static const std::regex kCreation(R"(/CreationDate\s*\(([^\)]*)\))");
-    std::smatch match;
-    if (std::regex_search(raw, match, kCreation)) {
-        return normalize_date(match.str(1));
+    if (output->size() > max_chars) {
+        output->resize(max_chars);
     }
-    return std::nullopt;
+    return *output;
 }
 
 #if defined(AI_FILE_SORTER_USE_PDFIUM)
@@ -360,15 +567,24 @@ PdfiumLibraryGuard& pdfium_library() {
     return guard;
 }
 
-std::string extract_pdf_text_pdfium(const std::filesystem::path& path, size_t max_chars) {
+// PDFium is not thread-safe, so concurrent extractions take turns here.
+std::mutex& pdfium_mutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+// Returns std::nullopt when PDFium cannot open the file (damaged or unsupported), so another extractor can try.
+std::optional<std::string> extract_pdf_text_pdfium(const std::filesystem::path& path, size_t max_chars) {
+    std::lock_guard<std::mutex> lock(pdfium_mutex());
     pdfium_library();
     const std::string pdf_path = Utils::path_to_utf8(path);
     FPDF_DOCUMENT doc = FPDF_LoadDocument(pdf_path.c_str(), nullptr);
     if (!doc) {
-        return {};
+        return std::nullopt;
     }
     const int page_count = FPDF_GetPageCount(doc);
     std::string result;
+    std::vector<unsigned short> buffer(static_cast<size_t>(kPdfiumTextChunkChars + 1));
     for (int i = 0; i < page_count && result.size() < max_chars; ++i) {
         FPDF_PAGE page = FPDF_LoadPage(doc, i);
         if (!page) {
@@ -383,8 +599,9 @@ std::string extract_pdf_text_pdfium(const std::filesystem::path& path, size_t ma
         const int chunk = kPdfiumTextChunkChars;
         int offset = 0;
         while (offset < total_chars && result.size() < max_chars) {
-            const int take = std::min(chunk, total_chars - offset);
-            std::vector<unsigned short> buffer(static_cast<size_t>(take + 1));
+            // Never ask for more characters than the remaining byte budget can hold.
+            const int budget = static_cast<int>(std::min<size_t>(max_chars - result.size(), chunk));
+            const int take = std::min(budget, total_chars - offset);
             const int extracted = FPDFText_GetText(text_page, offset, take, buffer.data());
             if (extracted <= 0) {
                 break;
@@ -405,8 +622,70 @@ std::string extract_pdf_text_pdfium(const std::filesystem::path& path, size_t ma
     FPDF_CloseDocument(doc);
     return result;
 }
+
+std::optional<std::string> extract_pdf_date_pdfium(const std::filesystem::path& path) {
+    std::lock_guard<std::mutex> lock(pdfium_mutex());
+    pdfium_library();
+    const std::string pdf_path = Utils::path_to_utf8(path);
+    FPDF_DOCUMENT doc = FPDF_LoadDocument(pdf_path.c_str(), nullptr);
+    if (!doc) {
+        return std::nullopt;
+    }
+    std::optional<std::string> date;
+    for (const char* tag : {"CreationDate", "ModDate"}) {
+        // Returns the byte length of the UTF-16LE value including its terminator.
+        const unsigned long bytes = FPDF_GetMetaText(doc, tag, nullptr, 0);
+        if (bytes <= sizeof(unsigned short)) {
+            continue;
+        }
+        std::vector<unsigned short> buffer(bytes / sizeof(unsigned short));
+        FPDF_GetMetaText(doc, tag, buffer.data(), bytes);
+        const QString value = QString::fromUtf16(reinterpret_cast<const char16_t*>(buffer.data()),
+                                                 static_cast<qsizetype>(buffer.size() - 1));
+        date = normalize_date(value.toStdString());
+        if (date) {
+            break;
+        }
+    }
+    FPDF_CloseDocument(doc);
+    return date;
+}
 #endif
 
+std::optional<std::string> extract_pdf_date(const std::filesystem::path& path) {
+#if defined(AI_FILE_SORTER_USE_PDFIUM)
+    if (auto date = extract_pdf_date_pdfium(path)) {
+        return date;
+    }
+#else
+    const QString file_path = path_to_qstring(path);
+    if (const auto pdfinfo = find_executable(QStringLiteral("pdfinfo"))) {
+        if (auto output = run_process(*pdfinfo, {file_path}, 4000)) {
+            std::istringstream iss(*output);
+            std::string line;
+            while (std::getline(iss, line)) {
+                if (line.rfind("CreationDate", 0) == 0 || line.rfind("Creation Date", 0) == 0) {
+                    if (auto parsed = normalize_date(line)) {
+                        return parsed;
+                    }
+                }
+            }
+        }
+    }
+#endif
+
+    std::string raw = read_file_prefix(path, 200000);
+    if (raw.empty()) {
+        return std::nullopt;
+    }
+    static const std::regex kCreation(R"(/CreationDate\s*\(([^\)]*)\))");
+    std::smatch match;
+    if (std::regex_search(raw, match, kCreation)) {
+        return normalize_date(match.str(1));
+    }
+    return std::nullopt;
+}
+
 const std::unordered_set<std::string> kDocumentExtensions = {
     ".txt", ".md", ".markdown", ".rtf", ".csv", ".tsv", ".log", ".json", ".xml", ".yml", ".yaml",
     ".ini", ".cfg", ".conf", ".html", ".htm", ".tex", ".rst", ".pdf", ".docx", ".xlsx", ".pptx",
@@ -492,6 +771,147 @@ std::string first_words(const std::string& text, size_t max_words) {
     return result;
 }
 
+// Sentences without punctuation (tables, lists) are cut near this length on a word boundary.
+constexpr size_t kMaxSentenceChars = 240;
+// The opening sentence often names the document, so it gets a small head start.
+constexpr double kLeadingSentenceBonus = 1.25;
+
+std::vector<std::string> split_sentences(const std::string& text) {
+    std::vector<std::string> sentences;
+    std::string current;
+    auto flush = [&]() {
+        const auto first = current.find_first_not_of(" \t\r\n");
+        if (first != std::string::npos) {
+            const auto last = current.find_last_not_of(" \t\r\n");
+            sentences.push_back(current.substr(first, last - first + 1));
+        }
+        current.clear();
+    };
+
+    for (size_t i = 0; i < text.size(); ++i) {
+        const char ch = text[i];
+        const char next = i + 1 < text.size() ? text[i + 1] : '\n';
+        const bool is_space = std::isspace(static_cast<unsigned char>(ch)) != 0;
+        if (ch == '\n' && (next == '\n' || next == '\r')) {
+            flush();
+            continue;
+        }
+        if (is_space && current.size() >= kMaxSentenceChars) {
+            flush();
+            continue;
+        }
+        current.push_back(is_space ? ' ' : ch);
+        if ((ch == '.' || ch == '!' || ch == '?') &&
+            std::isspace(static_cast<unsigned char>(next)) != 0) {
+            flush();
+        }
+    }
+    flush();
+    return sentences;
+}
+
+std::vector<std::string> sentence_terms(const std::string& sentence) {
+    std::vector<std::string> terms;
+    std::string word;
+    auto flush = [&]() {
+        if (word.size() >= 3 && kStopwords.find(word) == kStopwords.end()) {
+            terms.push_back(word);
+        }
+        word.clear();
+    };
+    for (const char ch : sentence) {
+        const auto byte = static_cast<unsigned char>(ch);
+        if (std::isalnum(byte) || byte >= 0x80) {
+            word.push_back(static_cast<char>(std::tolower(byte)));
+        } else {
+            flush();
+        }
+    }
+    flush();
+    return terms;
+}
+
+/**
+ * Picks the sentences that best cover the document's vocabulary.
+ * Each term is weighted by how often the document uses it times how few
+ * sentences contain it (TF-IDF), so words that appear in nearly every
+ * sentence count for little. Sentences are ranked by the weight of their
+ * distinct terms, normalised for length, then taken greedily until the
+ * budget is full and returned in their original order.
+ */
+std::string select_key_sentences(const std::string& text, size_t max_chars) {
+    if (text.size() <= max_chars) {
+        return text;
+    }
+
+    const std::vector<std::string> sentences = split_sentences(text);
+    std::vector<std::vector<std::string>> terms;
+    terms.reserve(sentences.size());
+    std::unordered_map<std::string, size_t> term_counts;
+    std::unordered_map<std::string, size_t> sentence_counts;
+    for (const auto& sentence : sentences) {
+        terms.push_back(sentence_terms(sentence));
+        std::unordered_set<std::string> seen;
+        for (const auto& term : terms.back()) {
+            ++term_counts[term];
+            if (seen.insert(term).second) {
+                ++sentence_counts[term];
+            }
+        }
+    }
+
+    const double sentence_total = static_cast<double>(sentences.size());
+    std::vector<std::pair<double, size_t>> ranked;
+    ranked.reserve(sentences.size());
+    for (size_t i = 0; i < sentences.size(); ++i) {
+        if (terms[i].empty()) {
+            continue;
+        }
+        std::unordered_set<std::string> seen;
+        double score = 0.0;
+        for (const auto& term : terms[i]) {
+            if (!seen.insert(term).second) {
+                continue;
+            }
+            const double idf = std::log(sentence_total / static_cast<double>(sentence_counts[term]));
+            score += static_cast<double>(term_counts[term]) * idf;
+        }
+        score /= std::sqrt(static_cast<double>(terms[i].size()));
+        if (i == 0) {
+            score *= kLeadingSentenceBonus;
+        }
+        ranked.emplace_back(score, i);
+    }
+    std::stable_sort(ranked.begin(), ranked.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first > rhs.first;
+    });
+
+    std::vector<size_t> chosen;
+    size_t used = 0;
+    for (const auto& [score, index] : ranked) {
+        const size_t cost = sentences[index].size() + (chosen.empty() ? 0 : 1);
+        if (used + cost > max_chars) {
+            continue;
+        }
+        chosen.push_back(index);
+        used += cost;
+    }
+    if (chosen.empty()) {
+        return truncate_excerpt(text, max_chars);
+    }
+
+    std::sort(chosen.begin(), chosen.end());
+    std::string summary;
+    summary.reserve(used);
+    for (const size_t index : chosen) {
+        if (!summary.empty()) {
+            summary.push_back(' ');
+        }
+        summary += sentences[index];
+    }
+    return summary;
+}
+
 } // namespace
 
 DocumentTextAnalyzer::DocumentTextAnalyzer()
@@ -516,14 +936,23 @@ DocumentTextAnalyzer::DocumentTextAnalyzer(Settings settings)
 
 DocumentAnalysisResult DocumentTextAnalyzer::analyze(const std::filesystem::path& document_path,
                                                      ILLMClient& llm) const
+{
+    return analyze_text(document_path, extract_text(document_path), llm);
+}
+
+DocumentAnalysisResult DocumentTextAnalyzer::analyze_text(const std::filesystem::path& document_path,
+                                                          const std::string& raw_text,
+                                                          ILLMClient& llm) const
 {
     DocumentAnalysisResult result;
-    const std::string raw_text = extract_text(document_path);
     if (raw_text.empty()) {
         throw std::runtime_error("No extractable text");
     }
 
-    const std::string excerpt = truncate_excerpt(raw_text, settings_.max_characters);
+    std::string excerpt = truncate_excerpt(raw_text, settings_.max_characters);
+    if (settings_.summary_characters > 0 && excerpt.size() > settings_.summary_characters) {
+        excerpt = select_key_sentences(excerpt, settings_.summary_characters);
+    }
     const std::string prompt = build_prompt(excerpt, Utils::path_to_utf8(document_path.filename()));
     const std::string response = llm.complete_prompt(prompt, settings_.max_tokens);
 
@@ -574,6 +1003,61 @@ std::optional<std::string> DocumentTextAnalyzer::extract_creation_date(const std
 }
 
 std::string DocumentTextAnalyzer::extract_text(const std::filesystem::path& path) const {
+    std::optional<std::string> identity;
+    if (excerpt_cache_) {
+        identity = FileFingerprint::identity(path);
+    }
+    if (identity) {
+        const auto cached = excerpt_cache_->get_document_excerpt(*identity, excerpt_cache_key());
+        if (cached && cached->excerpt) {
+            return *cached->excerpt;
+        }
+    }
+
+    std::string text = extract_text_uncached(path);
+    // An empty excerpt usually means extraction failed (locked file, missing pdftotext), so retry next time.
+    if (identity && !text.empty()) {
+        excerpt_cache_->store_document_excerpt(*identity,
+                                               excerpt_cache_key(),
+                                               DatabaseManager::CachedDocumentExcerpt{text, std::nullopt});
+    }
+    return text;
+}
+
+std::optional<std::string> DocumentTextAnalyzer::creation_date(const std::filesystem::path& path) const {
+    std::optional<std::string> identity;
+    if (excerpt_cache_) {
+        identity = FileFingerprint::identity(path);
+    }
+    if (identity) {
+        const auto cached = excerpt_cache_->get_document_excerpt(*identity, excerpt_cache_key());
+        if (cached && cached->creation_date) {
+            if (cached->creation_date->empty()) {
+                return std::nullopt;
+            }
+            return cached->creation_date;
+        }
+    }
+
+    auto date = extract_creation_date(path);
+    if (identity) {
+        excerpt_cache_->store_document_excerpt(*identity,
+                                               excerpt_cache_key(),
+                                               DatabaseManager::CachedDocumentExcerpt{std::nullopt,
+                                                                                      date.value_or(std::string())});
+    }
+    return date;
+}
+
+void DocumentTextAnalyzer::set_excerpt_cache(DatabaseManager* cache) {
+    excerpt_cache_ = cache;
+}
+
+std::string DocumentTextAnalyzer::excerpt_cache_key() const {
+    return "v" + std::to_string(kExcerptExtractorVersion) + ":" + std::to_string(settings_.max_characters);
+}
+
+std::string DocumentTextAnalyzer::extract_text_uncached(const std::filesystem::path& path) const {
     if (!path.has_extension()) {
         return {};
     }
@@ -584,88 +1068,39 @@ std::string DocumentTextAnalyzer::extract_text(const std::filesystem::path& path
         return collapse_whitespace(text);
     }
 
+    auto zip_text = [&](std::initializer_list<QString> members) -> std::string {
+        const auto text = extract_zip_member_text(path, members, settings_.max_characters, 7000);
+        return text ? collapse_whitespace(*text) : std::string();
+    };
+
     if (ext == ".pdf") {
 #if defined(AI_FILE_SORTER_USE_PDFIUM)
-        if (auto output = extract_pdf_text_pdfium(path, settings_.max_characters); !output.empty()) {
-            return collapse_whitespace(output);
+        // A PDF without a text layer yields nothing from pdftotext either, so no process is spawned
+        // unless PDFium could not open the file at all.
+        if (auto text = extract_pdf_text_pdfium(path, settings_.max_characters)) {
+            return collapse_whitespace(*text);
         }
 #endif
-        const auto pdftotext = find_executable(QStringLiteral("pdftotext"));
-        if (!pdftotext) {
-            return {};
-        }
-        const QString file_path = path_to_qstring(path);
-        auto output = run_process(*pdftotext,
-                                  {QStringLiteral("-layout"), QStringLiteral("-q"), file_path, QStringLiteral("-")},
-                                  15000);
-        if (!output) {
-            return {};
-        }
-        if (output->size() > settings_.max_characters) {
-            output->resize(settings_.max_characters);
-        }
-        return collapse_whitespace(*output);
+        return collapse_whitespace(extract_pdf_text_pdftotext(path, settings_.max_characters));
     }
 
     if (ext == ".docx") {
-        auto xml = extract_zip_member(path, {QStringLiteral("word/document.xml")}, 7000);
-        if (!xml) {
-            return {};
-        }
-        std::string text = extract_xml_text(*xml);
-        text = decode_basic_entities(text);
-        if (text.size() > settings_.max_characters) {
-            text.resize(settings_.max_characters);
-        }
-        return collapse_whitespace(text);
+        return zip_text({QStringLiteral("word/document.xml")});
     }
 
     if (ext == ".xlsx") {
-        auto xml = extract_zip_member(
-            path,
-            {QStringLiteral("xl/sharedStrings.xml"),
-             QStringLiteral("xl/worksheets/sheet1.xml"),
-             QStringLiteral("xl/worksheets/sheet2.xml")},
-            7000);
-        if (!xml) {
-            return {};
-        }
-        std::string text = extract_xml_text(*xml);
-        text = decode_basic_entities(text);
-        if (text.size() > settings_.max_characters) {
-            text.resize(settings_.max_characters);
-        }
-        return collapse_whitespace(text);
+        return zip_text({QStringLiteral("xl/sharedStrings.xml"),
+                         QStringLiteral("xl/worksheets/sheet1.xml"),
+                         QStringLiteral("xl/worksheets/sheet2.xml")});
     }
 
     if (ext == ".pptx") {
-        auto xml = extract_zip_member(
-            path,
-            {QStringLiteral("ppt/slides/slide1.xml"),
-             QStringLiteral("ppt/slides/slide2.xml")},
-            7000);
-        if (!xml) {
-            return {};
-        }
-        std::string text = extract_xml_text(*xml);
-        text = decode_basic_entities(text);
-        if (text.size() > settings_.max_characters) {
-            text.resize(settings_.max_characters);
-        }
-        return collapse_whitespace(text);
+        return zip_text({QStringLiteral("ppt/slides/slide1.xml"),
+                         QStringLiteral("ppt/slides/slide2.xml")});
     }
 
     if (ext == ".odt" || ext == ".ods" || ext == ".odp") {
-        auto xml = extract_zip_member(path, {QStringLiteral("content.xml")}, 7000);
-        if (!xml) {
-            return {};
-        }
-        std::string text = extract_xml_text(*xml);
-        text = decode_basic_entities(text);
-        if (text.size() > settings_.max_characters) {
-            text.resize(settings_.max_characters);
-        }
-        return collapse_whitespace(text);
+        return zip_text({QStringLiteral("content.xml")});
     }
 
     return {};
@@ -784,3 +1219,23 @@ std::string DocumentTextAnalyzer::normalize_filename(const std::string& base,
     }
     return ext.empty() ? base : base + ext;
 }
+
+#ifdef AI_FILE_SORTER_TEST_BUILD
+namespace DocumentTextAnalyzerTestAccess {
+std::pair<std::string, std::size_t> collect_xml_text(const std::vector<std::string>& chunks, std::size_t max_chars) {
+    XmlTextCollector collector(max_chars);
+    std::size_t consumed = 0;
+    for (const auto& chunk : chunks) {
+        ++consumed;
+        if (!collector.feed(chunk.data(), chunk.size())) {
+            break;
+        }
+    }
+    return {collector.finish(), consumed};
+}
+
+std::string select_key_sentences(const std::string& text, std::size_t max_chars) {
+    return ::select_key_sentences(text, max_chars);
+}
+}
+#endif
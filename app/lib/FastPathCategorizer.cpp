@@ -0,0 +1,261 @@
+#include "FastPathCategorizer.hpp"
+
+#include "ArtifactCategoryPolicy.hpp"
+#include "Logger.hpp"
+#include "Utils.hpp"
+
+#if __has_include(<jsoncpp/json/json.h>)
+#include <jsoncpp/json/json.h>
+#elif __has_include(<json/json.h>)
+#include <json/json.h>
+#else
+#error "jsoncpp headers not found. Install jsoncpp development files."
+#endif
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <initializer_list>
+#include <system_error>
+#include <utility>
+
+namespace {
+
+std::string to_lower_copy(std::string value)
+{
+    std::transform(value.begin(), value.end(), value.begin(), [](unsigned char ch) {
+        return static_cast<char>(std::tolower(ch));
+    });
+    return value;
+}
+
+bool ends_with(const std::string& value, const std::string& suffix)
+{
+    return value.size() >= suffix.size() &&
+           value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Builds a byte string that may contain NULs.
+std::string signature(std::initializer_list<unsigned char> bytes)
+{
+    return std::string(bytes.begin(), bytes.end());
+}
+
+std::optional<std::string> parse_hex(const std::string& text)
+{
+    std::string digits;
+    for (unsigned char ch : text) {
+        if (std::isxdigit(ch)) {
+            digits.push_back(static_cast<char>(ch));
+        } else if (!std::isspace(ch)) {
+            return std::nullopt;
+        }
+    }
+    if (digits.size() % 2 != 0) {
+        return std::nullopt;
+    }
+    std::string bytes;
+    bytes.reserve(digits.size() / 2);
+    for (std::size_t i = 0; i < digits.size(); i += 2) {
+        bytes.push_back(static_cast<char>(std::stoi(digits.substr(i, 2), nullptr, 16)));
+    }
+    return bytes;
+}
+
+bool has_magic(const std::filesystem::path& path, std::uintmax_t size, const FastPathCategorizer::Rule& rule)
+{
+    std::uintmax_t offset = 0;
+    if (rule.magic_offset < 0) {
+        const auto back = static_cast<std::uintmax_t>(-rule.magic_offset);
+        if (back > size) {
+            return false;
+        }
+        offset = size - back;
+    } else {
+        offset = static_cast<std::uintmax_t>(rule.magic_offset);
+    }
+    if (offset + rule.magic.size() > size) {
+        return false;
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in || !in.seekg(static_cast<std::streamoff>(offset))) {
+        return false;
+    }
+    std::string bytes(rule.magic.size(), '\0');
+    in.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    return in.gcount() == static_cast<std::streamsize>(bytes.size()) && bytes == rule.magic;
+}
+
+std::optional<FastPathCategorizer::Rule> parse_rule(const Json::Value& value)
+{
+    if (!value.isObject()) {
+        return std::nullopt;
+    }
+    FastPathCategorizer::Rule rule;
+    rule.name = value.get("name", "").asString();
+    rule.category = value.get("category", "").asString();
+    rule.subcategory = value.get("subcategory", "").asString();
+    rule.name_pattern = value.get("name_pattern", "").asString();
+    for (const auto& extension : value["extensions"]) {
+        if (extension.isString() && !extension.asString().empty()) {
+            std::string suffix = to_lower_copy(extension.asString());
+            rule.extensions.push_back(suffix.front() == '.' ? suffix : "." + suffix);
+        }
+    }
+    if (value["min_size"].isUInt64()) {
+        rule.min_size = value["min_size"].asUInt64();
+    }
+    if (value["max_size"].isUInt64()) {
+        rule.max_size = value["max_size"].asUInt64();
+    }
+    if (value.isMember("magic")) {
+        const auto magic = parse_hex(value["magic"].asString());
+        if (!magic) {
+            return std::nullopt;
+        }
+        rule.magic = *magic;
+    }
+    if (value["magic_offset"].isInt64()) {
+        rule.magic_offset = value["magic_offset"].asInt64();
+    }
+    if (rule.name.empty()) {
+        rule.name = rule.category + " / " + rule.subcategory;
+    }
+    return rule;
+}
+
+} // namespace
+
+FastPathCategorizer::FastPathCategorizer(std::vector<Rule> rules)
+{
+    rules_.reserve(rules.size());
+    for (auto& rule : rules) {
+        const bool selective = !rule.extensions.empty() || !rule.name_pattern.empty();
+        if (!selective || rule.category.empty() || rule.subcategory.empty()) {
+            if (auto logger = Logger::get_logger("core_logger")) {
+                logger->warn("Ignoring fast-path rule '{}': it needs an extension or name pattern and both labels",
+                             rule.name);
+            }
+            continue;
+        }
+        CompiledRule compiled{std::move(rule), std::nullopt};
+        if (!compiled.rule.name_pattern.empty()) {
+            try {
+                compiled.pattern.emplace(compiled.rule.name_pattern,
+                                         std::regex::ECMAScript | std::regex::icase);
+            } catch (const std::regex_error& ex) {
+                if (auto logger = Logger::get_logger("core_logger")) {
+                    logger->warn("Ignoring fast-path rule '{}': invalid name pattern ({})",
+                                 compiled.rule.name,
+                                 ex.what());
+                }
+                continue;
+            }
+        }
+        rules_.push_back(std::move(compiled));
+    }
+}
+
+FastPathCategorizer FastPathCategorizer::from_file(const std::filesystem::path& file)
+{
+    std::vector<Rule> rules;
+    bool use_builtin_rules = true;
+
+    std::ifstream in(file, std::ios::binary);
+    if (in) {
+        Json::CharReaderBuilder reader_builder;
+        Json::Value root;
+        std::string errors;
+        if (Json::parseFromStream(reader_builder, in, &root, &errors) && root.isObject()) {
+            use_builtin_rules = root.get("use_builtin_rules", true).asBool();
+            for (const auto& value : root["rules"]) {
+                if (auto rule = parse_rule(value)) {
+                    rules.push_back(std::move(*rule));
+                } else if (auto logger = Logger::get_logger("core_logger")) {
+                    logger->warn("Ignoring malformed fast-path rule in '{}'", Utils::path_to_utf8(file));
+                }
+            }
+        } else if (auto logger = Logger::get_logger("core_logger")) {
+            logger->warn("Ignoring unreadable fast-path rules file '{}': {}", Utils::path_to_utf8(file), errors);
+        }
+    }
+
+    if (use_builtin_rules) {
+        auto builtin = default_rules();
+        rules.insert(rules.end(),
+                     std::make_move_iterator(builtin.begin()),
+                     std::make_move_iterator(builtin.end()));
+    }
+    return FastPathCategorizer(std::move(rules));
+}
+
+std::vector<FastPathCategorizer::Rule> FastPathCategorizer::default_rules()
+{
+    using ArtifactCategoryPolicy::kArchivesCategory;
+    using ArtifactCategoryPolicy::kSoftwareCategory;
+
+    const std::string zip = signature({'P', 'K', 0x03, 0x04});
+    return {
+        {"TrueType font", {".ttf"}, "", std::nullopt, std::nullopt,
+         signature({0x00, 0x01, 0x00, 0x00}), 0, "Fonts", "TrueType"},
+        {"OpenType font", {".otf"}, "", std::nullopt, std::nullopt, "OTTO", 0, "Fonts", "OpenType"},
+        {"WOFF font", {".woff"}, "", std::nullopt, std::nullopt, "wOFF", 0, "Fonts", "Web Fonts"},
+        {"WOFF2 font", {".woff2"}, "", std::nullopt, std::nullopt, "wOF2", 0, "Fonts", "Web Fonts"},
+        {"ISO disk image", {".iso"}, "", std::nullopt, std::nullopt, "CD001", 32769, kSoftwareCategory, "Disk Images"},
+        {"Zip archive", {".zip"}, "", std::nullopt, std::nullopt, zip, 0, kArchivesCategory, "Zip"},
+        {"7-Zip archive", {".7z"}, "", std::nullopt, std::nullopt,
+         signature({'7', 'z', 0xBC, 0xAF, 0x27, 0x1C}), 0, kArchivesCategory, "7-Zip"},
+        {"RAR archive", {".rar"}, "", std::nullopt, std::nullopt,
+         signature({'R', 'a', 'r', '!', 0x1A, 0x07}), 0, kArchivesCategory, "RAR"},
+        {"Gzip tarball", {".tar.gz", ".tgz"}, "", std::nullopt, std::nullopt,
+         signature({0x1F, 0x8B}), 0, kArchivesCategory, "Tarballs"},
+        {"Tar archive", {".tar"}, "", std::nullopt, std::nullopt, "ustar", 257, kArchivesCategory, "Tarballs"},
+    };
+}
+
+std::optional<FastPathCategorizer::Match> FastPathCategorizer::match(const std::string& file_name,
+                                                                     const std::string& full_path,
+                                                                     FileType file_type) const
+{
+    if (file_type != FileType::File || rules_.empty()) {
+        return std::nullopt;
+    }
+
+    const std::string lower_name = to_lower_copy(file_name);
+    const std::filesystem::path path = Utils::utf8_to_path(full_path);
+    std::optional<std::uintmax_t> size;
+    bool size_read = false;
+
+    for (const auto& [rule, pattern] : rules_) {
+        if (!rule.extensions.empty() &&
+            std::none_of(rule.extensions.begin(), rule.extensions.end(), [&](const std::string& extension) {
+                return ends_with(lower_name, extension);
+            })) {
+            continue;
+        }
+        if (pattern && !std::regex_search(file_name, *pattern)) {
+            continue;
+        }
+
+        const bool needs_content = rule.min_size || rule.max_size || !rule.magic.empty();
+        if (needs_content) {
+            if (!size_read) {
+                std::error_code ec;
+                const auto file_size = std::filesystem::file_size(path, ec);
+                if (!ec) {
+                    size = file_size;
+                }
+                size_read = true;
+            }
+            if (!size ||
+                (rule.min_size && *size < *rule.min_size) ||
+                (rule.max_size && *size > *rule.max_size) ||
+                (!rule.magic.empty() && !has_magic(path, *size, rule))) {
+                continue;
+            }
+        }
+        return Match{rule.name, rule.category, rule.subcategory};
+    }
+    return std::nullopt;
+}
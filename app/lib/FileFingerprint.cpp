@@ -0,0 +1,100 @@
+#include "FileFingerprint.hpp"
+
+#include "Utils.hpp"
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <system_error>
+#include <vector>
+
+#include <fmt/format.h>
+
+#if !defined(_WIN32)
+#include <sys/stat.h>
+#endif
+
+namespace FileFingerprint {
+
+namespace {
+
+constexpr std::uint64_t kFnvOffsetBasis = 1469598103934665603ULL;
+constexpr std::uint64_t kFnvPrime = 1099511628211ULL;
+
+std::uint64_t fnv1a_append(std::uint64_t hash, const char* data, std::size_t size)
+{
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+} // namespace
+
+std::optional<std::string> compute(const std::filesystem::path& path)
+{
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(path, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return std::nullopt;
+    }
+
+    std::uint64_t hash = kFnvOffsetBasis;
+    std::vector<char> buffer(kSampleBlockBytes);
+    const std::uint64_t block = kSampleBlockBytes;
+    // Small files are hashed in full; larger ones by their head, middle and tail blocks.
+    const std::array<std::uint64_t, 3> offsets{
+        0,
+        size > 3 * block ? (size / 2) - (block / 2) : block,
+        size > 3 * block ? size - block : 2 * block};
+    for (const auto offset : offsets) {
+        if (offset >= size) {
+            break;
+        }
+        in.seekg(static_cast<std::streamoff>(offset));
+        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        const auto read = in.gcount();
+        if (read <= 0) {
+            return std::nullopt;
+        }
+        hash = fnv1a_append(hash, buffer.data(), static_cast<std::size_t>(read));
+        in.clear();
+    }
+
+    return fmt::format("{}:{:016x}", size, hash);
+}
+
+std::optional<std::string> identity(const std::filesystem::path& path)
+{
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(path, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    const auto modified = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    const auto modified_ticks = modified.time_since_epoch().count();
+
+#if !defined(_WIN32)
+    struct stat info {};
+    if (::stat(path.c_str(), &info) == 0) {
+        return fmt::format("{}:{}:{}:{}",
+                           static_cast<std::uint64_t>(info.st_dev),
+                           static_cast<std::uint64_t>(info.st_ino),
+                           size,
+                           modified_ticks);
+    }
+#endif
+    const auto absolute = std::filesystem::absolute(path, ec);
+    return fmt::format("{}:{}:{}", Utils::path_to_utf8(ec ? path : absolute), size, modified_ticks);
+}
+
+} // namespace FileFingerprint
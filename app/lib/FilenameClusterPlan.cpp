@@ -0,0 +1,165 @@
+#include "FilenameClusterPlan.hpp"
+
+#include "Utils.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <regex>
+#include <unordered_map>
+
+namespace {
+
+constexpr std::size_t kMinimumLiteralLetters = 2;
+
+std::string to_lower_copy(std::string value)
+{
+    std::transform(value.begin(), value.end(), value.begin(), [](unsigned char ch) {
+        return static_cast<char>(std::tolower(ch));
+    });
+    return value;
+}
+
+// Replaces the most specific patterns first so a UUID or date is not split into digit runs.
+std::string collapse_variable_parts(const std::string& stem)
+{
+    static const std::regex kUuid("[0-9a-f]{8}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{12}");
+    static const std::regex kHash("(^|[^0-9a-z])[0-9a-f]{16,}(?=[^0-9a-z]|$)");
+    static const std::regex kDate("(19|20)\\d{2}([-_.]?)(0[1-9]|1[0-2])\\2(0[1-9]|[12]\\d|3[01])"
+                                  "|(0[1-9]|[12]\\d|3[01])([-_.])(0[1-9]|1[0-2])\\6(19|20)\\d{2}");
+    static const std::regex kDigits("\\d+");
+
+    std::string result = std::regex_replace(stem, kUuid, "{uuid}");
+    result = std::regex_replace(result, kHash, "$1{hash}");
+    result = std::regex_replace(result, kDate, "{date}");
+    return std::regex_replace(result, kDigits, "{n}");
+}
+
+std::size_t count_literal_letters(const std::string& pattern)
+{
+    std::size_t letters = 0;
+    bool in_placeholder = false;
+    for (unsigned char ch : pattern) {
+        if (ch == '{') {
+            in_placeholder = true;
+        } else if (ch == '}') {
+            in_placeholder = false;
+        } else if (!in_placeholder && (std::isalpha(ch) || ch >= 128)) {
+            ++letters;
+        }
+    }
+    return letters;
+}
+
+std::string label_of(const std::string& canonical, const std::string& display)
+{
+    return canonical.empty() ? display : canonical;
+}
+
+bool same_labels(const CategorizedFile& lhs, const CategorizedFile& rhs)
+{
+    return label_of(lhs.canonical_category, lhs.category) == label_of(rhs.canonical_category, rhs.category) &&
+           label_of(lhs.canonical_subcategory, lhs.subcategory) ==
+               label_of(rhs.canonical_subcategory, rhs.subcategory);
+}
+
+} // namespace
+
+FilenameClusterPlan::FilenameClusterPlan(const std::vector<FileEntry>& files,
+                                         std::size_t verification_samples,
+                                         const std::function<bool(const FileEntry&)>& excluded)
+    : membership_(files.size()),
+      verification_samples_(verification_samples)
+{
+    std::unordered_map<std::string, std::vector<std::size_t>> groups;
+    std::vector<std::string> order;
+    for (std::size_t index = 0; index < files.size(); ++index) {
+        const auto& entry = files[index];
+        if (entry.type != FileType::File || (excluded && excluded(entry))) {
+            continue;
+        }
+        const auto name_template = make_template(entry.file_name);
+        if (!name_template) {
+            continue;
+        }
+        const std::string dir_path = Utils::path_to_utf8(Utils::utf8_to_path(entry.full_path).parent_path());
+        std::string key = dir_path + '\x1f' + *name_template;
+        auto [it, inserted] = groups.try_emplace(key);
+        if (inserted) {
+            order.push_back(std::move(key));
+        }
+        it->second.push_back(index);
+    }
+
+    for (const auto& key : order) {
+        const auto& members = groups[key];
+        // A cluster needs at least one member left over after the representative and the samples.
+        if (members.size() < verification_samples_ + 2) {
+            continue;
+        }
+        for (std::size_t rank = 0; rank < members.size(); ++rank) {
+            membership_[members[rank]] = Membership{clusters_.size(), rank};
+        }
+        clusters_.emplace_back();
+    }
+}
+
+std::optional<std::string> FilenameClusterPlan::make_template(const std::string& file_name)
+{
+    const std::string lower = to_lower_copy(file_name);
+    const auto dot = lower.find_last_of('.');
+    const bool has_extension = dot != std::string::npos && dot > 0;
+    const std::string stem = has_extension ? lower.substr(0, dot) : lower;
+    const std::string extension = has_extension ? lower.substr(dot) : std::string();
+
+    const std::string stem_template = collapse_variable_parts(stem);
+    if (stem_template == stem || count_literal_letters(stem_template) < kMinimumLiteralLetters) {
+        return std::nullopt;
+    }
+    return stem_template + extension;
+}
+
+const CategorizedFile* FilenameClusterPlan::representative_result(std::size_t index) const
+{
+    if (index >= membership_.size() || !membership_[index]) {
+        return nullptr;
+    }
+    const auto& [cluster_index, rank] = *membership_[index];
+    const Cluster& cluster = clusters_[cluster_index];
+    if (cluster.dissolved || rank <= verification_samples_ || !cluster.representative ||
+        cluster.verified < verification_samples_) {
+        return nullptr;
+    }
+    return &*cluster.representative;
+}
+
+bool FilenameClusterPlan::will_propagate(std::size_t index) const
+{
+    if (index >= membership_.size() || !membership_[index]) {
+        return false;
+    }
+    const auto& [cluster_index, rank] = *membership_[index];
+    return !clusters_[cluster_index].dissolved && rank > verification_samples_;
+}
+
+void FilenameClusterPlan::record_result(std::size_t index, const std::optional<CategorizedFile>& result)
+{
+    if (index >= membership_.size() || !membership_[index]) {
+        return;
+    }
+    const auto& [cluster_index, rank] = *membership_[index];
+    Cluster& cluster = clusters_[cluster_index];
+    if (cluster.dissolved || rank > verification_samples_) {
+        return;
+    }
+    if (rank == 0) {
+        cluster.representative = result;
+        cluster.dissolved = !result.has_value();
+        return;
+    }
+    if (!result || !cluster.representative || !same_labels(*result, *cluster.representative)) {
+        cluster.dissolved = true;
+        return;
+    }
+    ++cluster.verified;
+}
@@ -1,7 +1,9 @@
 #include "GeminiClient.hpp"
 
+#include "CategorizationPrompt.hpp"
 #include "Logger.hpp"
 #include "LLMErrors.hpp"
+#include "RemoteBatchPrompt.hpp"
 #include "Utils.hpp"
 
 #include <curl/curl.h>
@@ -16,6 +18,8 @@
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <iostream>
 #include <sstream>
@@ -26,6 +30,9 @@
 
 namespace {
 
+// Per-item transfer timeout; batched prompts get one slot per item.
+constexpr long kRequestTimeoutSeconds = 5L;
+
 size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::string* response)
 {
     const size_t total_size = size * nmemb;
@@ -33,6 +40,13 @@ size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::string* res
     return total_size;
 }
 
+// Aborts the transfer once the request's cancellation flag is raised.
+int CancelProgressCallback(void* data, curl_off_t, curl_off_t, curl_off_t, curl_off_t)
+{
+    const auto* cancelled = static_cast<const std::atomic<bool>*>(data);
+    return cancelled && cancelled->load() ? 1 : 0;
+}
+
 std::string escape_json(const std::string& input) {
     std::string out;
     out.reserve(input.size() * 2);
@@ -121,11 +135,13 @@ CurlRequest create_curl_request(const std::shared_ptr<spdlog::logger>& logger)
 void configure_request_payload(CurlRequest& request,
                                const std::string& api_url,
                                const std::string& payload,
-                               std::string& response_buffer)
+                               long timeout_seconds,
+                               std::string& response_buffer,
+                               const std::atomic<bool>* cancelled)
 {
     curl_easy_setopt(request.handle, CURLOPT_URL, api_url.c_str());
     curl_easy_setopt(request.handle, CURLOPT_POST, 1L);
-    curl_easy_setopt(request.handle, CURLOPT_TIMEOUT, 5L);
+    curl_easy_setopt(request.handle, CURLOPT_TIMEOUT, timeout_seconds);
 
     request.headers = curl_slist_append(request.headers, "Content-Type: application/json");
     curl_easy_setopt(request.handle, CURLOPT_HTTPHEADER, request.headers);
@@ -133,6 +149,11 @@ void configure_request_payload(CurlRequest& request,
     curl_easy_setopt(request.handle, CURLOPT_POSTFIELDS, payload.c_str());
     curl_easy_setopt(request.handle, CURLOPT_WRITEFUNCTION, WriteCallback);
     curl_easy_setopt(request.handle, CURLOPT_WRITEDATA, &response_buffer);
+    if (cancelled) {
+        curl_easy_setopt(request.handle, CURLOPT_NOPROGRESS, 0L);
+        curl_easy_setopt(request.handle, CURLOPT_XFERINFOFUNCTION, CancelProgressCallback);
+        curl_easy_setopt(request.handle, CURLOPT_XFERINFODATA, const_cast<std::atomic<bool>*>(cancelled));
+    }
 }
 
 long perform_request(CurlRequest& request, const std::shared_ptr<spdlog::logger>& logger)
@@ -235,7 +256,12 @@ void GeminiClient::set_prompt_logging_enabled(bool enabled)
     prompt_logging_enabled_ = enabled;
 }
 
-std::string GeminiClient::send_api_request(const std::string& json_payload)
+void GeminiClient::set_cancellation_flag(const std::atomic<bool>* flag)
+{
+    cancellation_flag_.store(flag);
+}
+
+std::string GeminiClient::send_api_request(const std::string& json_payload, std::size_t item_count)
 {
     if (api_key_.empty()) {
         throw std::runtime_error("Missing Gemini API key.");
@@ -262,7 +288,12 @@ std::string GeminiClient::send_api_request(const std::string& json_payload)
 
         try {
             CurlRequest request = create_curl_request(logger);
-            configure_request_payload(request, api_url, json_payload, response_string);
+            configure_request_payload(request,
+                                      api_url,
+                                      json_payload,
+                                      kRequestTimeoutSeconds * static_cast<long>(std::max<std::size_t>(1, item_count)),
+                                      response_string,
+                                      cancellation_flag_.load());
             const long http_code = perform_request(request, logger);
             if (http_code == 404 && i + 1 < api_versions.size()) {
                 // Fallback to next version (e.g., v1beta) on 404.
@@ -316,6 +347,42 @@ std::string GeminiClient::categorize_file(const std::string& file_name,
     return category;
 }
 
+std::vector<std::string> GeminiClient::categorize_files(const std::vector<CategorizationRequest>& requests)
+{
+    if (batch_size_ <= 1) {
+        return ILLMClient::categorize_files(requests);
+    }
+    return RemoteBatchPrompt::categorize(
+        requests,
+        batch_size_,
+        [this](const std::string& system_prompt, const std::string& user_prompt, std::size_t item_count) {
+            if (prompt_logging_enabled_) {
+                std::cout << "\n[DEV][PROMPT] Batched categorization request\n" << user_prompt << "\n";
+            }
+            std::string reply = send_api_request(make_generic_payload(system_prompt, user_prompt, 0), item_count);
+            if (prompt_logging_enabled_) {
+                std::cout << "[DEV][RESPONSE] Batched categorization reply\n" << reply << "\n";
+            }
+            return reply;
+        },
+        [this](const CategorizationRequest& request) {
+            return categorize_file(request.file_name,
+                                   request.file_path,
+                                   request.file_type,
+                                   request.consistency_context);
+        });
+}
+
+std::size_t GeminiClient::max_batch_size() const
+{
+    return batch_size_;
+}
+
+void GeminiClient::set_batch_size(std::size_t size)
+{
+    batch_size_ = std::clamp<std::size_t>(size, 1, RemoteBatchPrompt::kMaxBatchSize);
+}
+
 std::string GeminiClient::make_categorization_payload(const std::string& file_name,
                                                       const std::string& file_path,
                                                       FileType file_type,
@@ -344,13 +411,7 @@ std::string GeminiClient::make_categorization_payload(const std::string& file_na
     }
 
     last_prompt_ = prompt;
-    const std::string system_prompt =
-        "You are a file categorization assistant. If it's an installer, describe the type of software it installs. "
-        "Consider the filename, extension, and any directory context provided. If the user prompt includes an "
-        "'Allowed main categories' list, choose the main category from that list only. Use Other only when it is "
-        "listed and none of the other listed main categories clearly fits. Always reply with one line in the "
-        "format <Main category> : <Subcategory>. Main category must be broad (one or two words, plural). "
-        "Subcategory must be specific, relevant, and must not repeat the main category.";
+    const std::string& system_prompt = CategorizationPrompt::single_item_system_prompt();
 
     std::ostringstream payload;
     const std::string merged_prompt = system_prompt + "\n\n" + prompt;
@@ -0,0 +1,120 @@
+#include "GpuLayerProfileCache.hpp"
+
+#include "Logger.hpp"
+#include "Utils.hpp"
+
+#if __has_include(<jsoncpp/json/json.h>)
+#include <jsoncpp/json/json.h>
+#elif __has_include(<json/json.h>)
+#include <json/json.h>
+#else
+#error "jsoncpp headers not found. Install jsoncpp development files."
+#endif
+
+#include <fstream>
+#include <system_error>
+#include <utility>
+
+namespace {
+
+constexpr std::uint64_t kMemoryBucketMiB = 512;
+constexpr std::uint64_t kBytesPerMiB = 1024ull * 1024ull;
+
+std::string entry_key(const GpuLayerProfileCache::Key& key)
+{
+    return key.backend + "|" + std::to_string(key.memory_bucket_mib) + "|" + key.model_identity;
+}
+
+Json::Value read_profiles(const std::filesystem::path& file)
+{
+    std::ifstream in(file, std::ios::binary);
+    if (!in) {
+        return Json::Value(Json::objectValue);
+    }
+    Json::CharReaderBuilder reader_builder;
+    Json::Value root;
+    std::string errors;
+    if (!Json::parseFromStream(reader_builder, in, &root, &errors) || !root.isObject()) {
+        if (auto logger = Logger::get_logger("core_logger")) {
+            logger->warn("Ignoring unreadable GPU layer profile cache '{}': {}",
+                         Utils::path_to_utf8(file), errors);
+        }
+        return Json::Value(Json::objectValue);
+    }
+    return root;
+}
+
+bool write_profiles(const std::filesystem::path& file, const Json::Value& root)
+{
+    std::error_code ec;
+    if (file.has_parent_path()) {
+        std::filesystem::create_directories(file.parent_path(), ec);
+    }
+    std::filesystem::path temp_path = file;
+    temp_path += ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        Json::StreamWriterBuilder builder;
+        builder["indentation"] = "  ";
+        out << Json::writeString(builder, root);
+        if (!out) {
+            return false;
+        }
+    }
+    std::filesystem::rename(temp_path, file, ec);
+    if (ec) {
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+std::mutex GpuLayerProfileCache::file_mutex_;
+
+GpuLayerProfileCache::GpuLayerProfileCache(std::filesystem::path file)
+    : file_(std::move(file))
+{
+}
+
+std::optional<int> GpuLayerProfileCache::lookup(const Key& key) const
+{
+    std::lock_guard<std::mutex> lock(file_mutex_);
+    const Json::Value root = read_profiles(file_);
+    const Json::Value& entry = root[entry_key(key)];
+    if (!entry.isObject() || !entry["n_gpu_layers"].isInt()) {
+        return std::nullopt;
+    }
+    return entry["n_gpu_layers"].asInt();
+}
+
+bool GpuLayerProfileCache::store(const Key& key, int n_gpu_layers)
+{
+    std::lock_guard<std::mutex> lock(file_mutex_);
+    Json::Value root = read_profiles(file_);
+    Json::Value entry(Json::objectValue);
+    entry["n_gpu_layers"] = n_gpu_layers;
+    root[entry_key(key)] = entry;
+    return write_profiles(file_, root);
+}
+
+bool GpuLayerProfileCache::forget(const Key& key)
+{
+    std::lock_guard<std::mutex> lock(file_mutex_);
+    Json::Value root = read_profiles(file_);
+    if (!root.isMember(entry_key(key))) {
+        return true;
+    }
+    root.removeMember(entry_key(key));
+    return write_profiles(file_, root);
+}
+
+std::uint64_t GpuLayerProfileCache::memory_bucket_mib(std::uint64_t total_bytes)
+{
+    const std::uint64_t total_mib = total_bytes / kBytesPerMiB;
+    return (total_mib / kMemoryBucketMiB) * kMemoryBucketMiB;
+}
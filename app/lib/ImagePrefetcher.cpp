@@ -0,0 +1,126 @@
+#include "ImagePrefetcher.hpp"
+
+#include "ImageRenameMetadataService.hpp"
+#include "Utils.hpp"
+
+#include <QImage>
+#include <QImageReader>
+#include <QSize>
+#include <QString>
+#include <QTransform>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <utility>
+
+ImagePrefetcher::ImagePrefetcher(std::vector<std::filesystem::path> paths,
+                                 int32_t max_long_side,
+                                 std::size_t workers,
+                                 std::size_t lookahead,
+                                 int32_t min_thumbnail_long_side)
+    : paths_(std::move(paths)),
+      max_long_side_(std::max<int32_t>(0, max_long_side)),
+      min_thumbnail_long_side_(std::max<int32_t>(0, min_thumbnail_long_side)),
+      queue_(paths_.size(),
+             [this](std::size_t index) { return decode(paths_[index], max_long_side_, min_thumbnail_long_side_); },
+             workers,
+             lookahead)
+{
+}
+
+std::optional<PreparedImage> ImagePrefetcher::take(std::size_t index)
+{
+    return queue_.take(index);
+}
+
+namespace {
+
+/**
+ * @brief Decodes the embedded camera preview when it is large enough to stand in for the image.
+ * @param path Image whose preview is read.
+ * @param min_long_side Smallest acceptable preview long side in pixels.
+ * @return Upright preview, or a null image when the full image has to be decoded.
+ */
+QImage decode_embedded_thumbnail(const std::filesystem::path& path, int32_t min_long_side)
+{
+    const auto thumbnail = ImageRenameMetadataService::extract_embedded_thumbnail(path);
+    if (!thumbnail) {
+        return QImage();
+    }
+    QImage preview = QImage::fromData(thumbnail->jpeg.data(), static_cast<int>(thumbnail->jpeg.size()), "JPG");
+    if (preview.isNull() || std::max(preview.width(), preview.height()) < min_long_side) {
+        return QImage();
+    }
+    // Previews are stored unrotated; mirrored orientations are rare enough to take the full decode.
+    switch (thumbnail->orientation) {
+        case 1:
+            return preview;
+        case 3:
+            return preview.transformed(QTransform().rotate(180));
+        case 6:
+            return preview.transformed(QTransform().rotate(90));
+        case 8:
+            return preview.transformed(QTransform().rotate(270));
+        default:
+            return QImage();
+    }
+}
+
+std::optional<PreparedImage> to_prepared_image(const std::filesystem::path& path,
+                                               QImage decoded,
+                                               int32_t max_long_side,
+                                               std::chrono::steady_clock::time_point started)
+{
+    if (decoded.isNull()) {
+        return std::nullopt;
+    }
+    if (max_long_side > 0 && std::max(decoded.width(), decoded.height()) > max_long_side) {
+        decoded = decoded.scaled(max_long_side, max_long_side, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    decoded = decoded.convertToFormat(QImage::Format_RGB888);
+    if (decoded.isNull() || decoded.width() <= 0 || decoded.height() <= 0) {
+        return std::nullopt;
+    }
+
+    PreparedImage image;
+    image.path = path;
+    image.width = static_cast<uint32_t>(decoded.width());
+    image.height = static_cast<uint32_t>(decoded.height());
+    const std::size_t row_bytes = static_cast<std::size_t>(image.width) * 3;
+    image.rgb.resize(row_bytes * image.height);
+    for (uint32_t y = 0; y < image.height; ++y) {
+        std::memcpy(image.rgb.data() + row_bytes * y, decoded.constScanLine(static_cast<int>(y)), row_bytes);
+    }
+    image.decode_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    return image;
+}
+
+} // namespace
+
+std::optional<PreparedImage> ImagePrefetcher::decode(const std::filesystem::path& path,
+                                                     int32_t max_long_side,
+                                                     int32_t min_thumbnail_long_side)
+{
+    const auto started = std::chrono::steady_clock::now();
+    if (min_thumbnail_long_side > 0) {
+        QImage preview = decode_embedded_thumbnail(path, min_thumbnail_long_side);
+        if (!preview.isNull()) {
+            return to_prepared_image(path, std::move(preview), max_long_side, started);
+        }
+    }
+
+    QImageReader reader(QString::fromStdString(Utils::path_to_utf8(path)));
+    // Match the embedded-preview path, which is rotated to the EXIF orientation as well.
+    reader.setAutoTransform(true);
+    const QSize source_size = reader.size();
+    if (max_long_side > 0 && source_size.isValid()) {
+        const int long_side = std::max(source_size.width(), source_size.height());
+        if (long_side > max_long_side) {
+            // Setting the scaled size lets the JPEG reader decode at a reduced DCT scale.
+            reader.setScaledSize(source_size.scaled(max_long_side, max_long_side, Qt::KeepAspectRatio));
+        }
+    }
+
+    return to_prepared_image(path, reader.read(), max_long_side, started);
+}
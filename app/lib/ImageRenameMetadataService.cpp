@@ -51,6 +51,14 @@ constexpr uint16_t kTagGpsLatitudeRef = 0x0001;
 constexpr uint16_t kTagGpsLatitude = 0x0002;
 constexpr uint16_t kTagGpsLongitudeRef = 0x0003;
 constexpr uint16_t kTagGpsLongitude = 0x0004;
+constexpr uint16_t kTagOrientation = 0x0112;
+constexpr uint16_t kTagThumbnailOffset = 0x0201;
+constexpr uint16_t kTagThumbnailLength = 0x0202;
+constexpr uint16_t kTagMpEntry = 0xB002;
+constexpr char kMpfPrefix[] = "MPF";
+constexpr size_t kMpEntrySize = 16;
+// Camera previews are VGA to Full-HD JPEGs; a larger entry is the full image or a corrupt index.
+constexpr uint32_t kMaxMpfPreviewBytes = 8 * 1024 * 1024;
 
 struct TiffEntry {
     uint16_t tag{0};
@@ -103,7 +111,17 @@ bool read_exact(std::ifstream& in, uint8_t* data, size_t size)
     return in.good();
 }
 
-std::optional<std::vector<uint8_t>> read_jpeg_exif_payload(const std::filesystem::path& image_path)
+struct JpegAppSegment {
+    std::vector<uint8_t> payload;
+    /** File offset of the first payload byte. */
+    std::streamoff file_offset{0};
+};
+
+// Returns the payload (after the identifier) of the first APPn segment that starts with `identifier`.
+std::optional<JpegAppSegment> read_jpeg_app_segment(const std::filesystem::path& image_path,
+                                                    uint8_t app_marker,
+                                                    const char* identifier,
+                                                    size_t identifier_size)
 {
     std::ifstream in(image_path, std::ios::binary);
     if (!in) {
@@ -155,16 +173,18 @@ std::optional<std::vector<uint8_t>> read_jpeg_exif_payload(const std::filesystem
         }
 
         const size_t payload_size = static_cast<size_t>(segment_length - 2);
-        if (marker == 0xE1) {
+        if (marker == app_marker) {
+            const std::streamoff payload_offset = in.tellg();
             std::vector<uint8_t> payload(payload_size);
             if (!read_exact(in, payload.data(), payload.size())) {
                 break;
             }
 
-            if (payload.size() >= sizeof(kExifPrefix) - 1 &&
-                std::memcmp(payload.data(), kExifPrefix, sizeof(kExifPrefix) - 1) == 0) {
-                return std::vector<uint8_t>(payload.begin() + static_cast<std::ptrdiff_t>(sizeof(kExifPrefix) - 1),
-                                            payload.end());
+            if (payload.size() >= identifier_size && std::memcmp(payload.data(), identifier, identifier_size) == 0) {
+                return JpegAppSegment{
+                    std::vector<uint8_t>(payload.begin() + static_cast<std::ptrdiff_t>(identifier_size),
+                                         payload.end()),
+                    payload_offset + static_cast<std::streamoff>(identifier_size)};
             }
             continue;
         }
@@ -178,6 +198,15 @@ std::optional<std::vector<uint8_t>> read_jpeg_exif_payload(const std::filesystem
     return std::nullopt;
 }
 
+std::optional<std::vector<uint8_t>> read_jpeg_exif_payload(const std::filesystem::path& image_path)
+{
+    auto segment = read_jpeg_app_segment(image_path, 0xE1, kExifPrefix, sizeof(kExifPrefix) - 1);
+    if (!segment) {
+        return std::nullopt;
+    }
+    return std::move(segment->payload);
+}
+
 std::optional<std::vector<uint8_t>> read_file_bytes(const std::filesystem::path& path)
 {
     std::ifstream in(path, std::ios::binary | std::ios::ate);
@@ -874,6 +903,134 @@ std::optional<std::string> pick_place_name(const Json::Value& root)
     return std::nullopt;
 }
 
+std::optional<uint32_t> read_integer_entry(const std::vector<uint8_t>& tiff,
+                                           bool little_endian,
+                                           const TiffEntry* entry)
+{
+    if (!entry || entry->count != 1) {
+        return std::nullopt;
+    }
+    if (entry->type == 3) {
+        const auto value = read_u16(tiff, entry->raw_offset + 8, little_endian);
+        return value ? std::optional<uint32_t>(*value) : std::nullopt;
+    }
+    if (entry->type == 4) {
+        return entry->value_or_offset;
+    }
+    return std::nullopt;
+}
+
+int parse_tiff_orientation(const std::vector<uint8_t>& tiff)
+{
+    if (!looks_like_tiff_payload(tiff)) {
+        return 1;
+    }
+    const bool little_endian = tiff[0] == 'I';
+    const auto ifd0_offset = read_u32(tiff, 4, little_endian);
+    std::vector<TiffEntry> ifd0_entries;
+    if (!ifd0_offset || !parse_ifd_entries(tiff, little_endian, *ifd0_offset, ifd0_entries)) {
+        return 1;
+    }
+    const auto orientation = read_integer_entry(tiff, little_endian, find_entry(ifd0_entries, kTagOrientation));
+    return orientation && *orientation >= 1 && *orientation <= 8 ? static_cast<int>(*orientation) : 1;
+}
+
+std::optional<ImageRenameMetadataService::EmbeddedThumbnail> parse_tiff_thumbnail(const std::vector<uint8_t>& tiff)
+{
+    if (!looks_like_tiff_payload(tiff)) {
+        return std::nullopt;
+    }
+    const bool little_endian = tiff[0] == 'I';
+
+    const auto ifd0_offset = read_u32(tiff, 4, little_endian);
+    std::vector<TiffEntry> ifd0_entries;
+    if (!ifd0_offset || !parse_ifd_entries(tiff, little_endian, *ifd0_offset, ifd0_entries)) {
+        return std::nullopt;
+    }
+
+    // IFD1 follows IFD0's entries and holds the thumbnail location.
+    const auto ifd1_offset =
+        read_u32(tiff, static_cast<size_t>(*ifd0_offset) + 2 + ifd0_entries.size() * 12, little_endian);
+    std::vector<TiffEntry> ifd1_entries;
+    if (!ifd1_offset || *ifd1_offset == 0 ||
+        !parse_ifd_entries(tiff, little_endian, *ifd1_offset, ifd1_entries)) {
+        return std::nullopt;
+    }
+
+    const auto offset = read_integer_entry(tiff, little_endian, find_entry(ifd1_entries, kTagThumbnailOffset));
+    const auto length = read_integer_entry(tiff, little_endian, find_entry(ifd1_entries, kTagThumbnailLength));
+    if (!offset || !length || *length < 4 ||
+        static_cast<uint64_t>(*offset) + *length > tiff.size()) {
+        return std::nullopt;
+    }
+    const auto begin = tiff.begin() + static_cast<std::ptrdiff_t>(*offset);
+    if (begin[0] != 0xFF || begin[1] != 0xD8) {
+        return std::nullopt;
+    }
+
+    ImageRenameMetadataService::EmbeddedThumbnail thumbnail;
+    thumbnail.jpeg.assign(begin, begin + static_cast<std::ptrdiff_t>(*length));
+    thumbnail.orientation = parse_tiff_orientation(tiff);
+    return thumbnail;
+}
+
+/**
+ * @brief Reads the largest preview image listed in a JPEG's Multi-Picture Format (APP2) index.
+ *
+ * Most cameras store a VGA or Full-HD preview after the primary image and list it in the MPF
+ * index, while the EXIF IFD1 thumbnail is limited to about 160x120.
+ */
+std::optional<std::vector<uint8_t>> read_jpeg_mpf_preview(const std::filesystem::path& image_path)
+{
+    // The identifier includes the terminating NUL ("MPF\0").
+    const auto segment = read_jpeg_app_segment(image_path, 0xE2, kMpfPrefix, sizeof(kMpfPrefix));
+    if (!segment || !looks_like_tiff_payload(segment->payload)) {
+        return std::nullopt;
+    }
+    const auto& mpf = segment->payload;
+    const bool little_endian = mpf[0] == 'I';
+    const auto index_offset = read_u32(mpf, 4, little_endian);
+    std::vector<TiffEntry> index_entries;
+    if (!index_offset || !parse_ifd_entries(mpf, little_endian, *index_offset, index_entries)) {
+        return std::nullopt;
+    }
+    const TiffEntry* mp_entry = find_entry(index_entries, kTagMpEntry);
+    if (!mp_entry || mp_entry->count < 2 * kMpEntrySize ||
+        static_cast<uint64_t>(mp_entry->value_or_offset) + mp_entry->count > mpf.size()) {
+        return std::nullopt;
+    }
+
+    // Entry 0 is the primary image; later entries hold previews with offsets relative to the MPF header.
+    uint32_t best_size = 0;
+    uint32_t best_offset = 0;
+    for (size_t entry = 1; entry < mp_entry->count / kMpEntrySize; ++entry) {
+        const size_t base = mp_entry->value_or_offset + entry * kMpEntrySize;
+        const auto size = read_u32(mpf, base + 4, little_endian);
+        const auto offset = read_u32(mpf, base + 8, little_endian);
+        if (size && offset && *offset != 0 && *size > best_size && *size <= kMaxMpfPreviewBytes) {
+            best_size = *size;
+            best_offset = *offset;
+        }
+    }
+    if (best_size < 4) {
+        return std::nullopt;
+    }
+
+    std::error_code ec;
+    const auto file_size = std::filesystem::file_size(image_path, ec);
+    if (ec || static_cast<uint64_t>(segment->file_offset) + best_offset + best_size > file_size) {
+        return std::nullopt;
+    }
+
+    std::ifstream in(image_path, std::ios::binary);
+    in.seekg(segment->file_offset + static_cast<std::streamoff>(best_offset));
+    std::vector<uint8_t> preview(best_size);
+    if (!in || !read_exact(in, preview.data(), preview.size()) || preview[0] != 0xFF || preview[1] != 0xD8) {
+        return std::nullopt;
+    }
+    return preview;
+}
+
 } // namespace
 
 ImageRenameMetadataService::ImageRenameMetadataService(std::string config_dir)
@@ -1177,6 +1334,21 @@ std::optional<std::string> ImageRenameMetadataService::extract_capture_date(
     return extract_exif_metadata(image_path).capture_date;
 }
 
+std::optional<ImageRenameMetadataService::EmbeddedThumbnail>
+ImageRenameMetadataService::extract_embedded_thumbnail(const std::filesystem::path& image_path)
+{
+    const auto exif_tiff = read_jpeg_exif_payload(image_path);
+    std::optional<EmbeddedThumbnail> thumbnail;
+    if (exif_tiff) {
+        thumbnail = parse_tiff_thumbnail(*exif_tiff);
+    }
+    if (auto preview = read_jpeg_mpf_preview(image_path);
+        preview && (!thumbnail || preview->size() > thumbnail->jpeg.size())) {
+        thumbnail = EmbeddedThumbnail{std::move(*preview), exif_tiff ? parse_tiff_orientation(*exif_tiff) : 1};
+    }
+    return thumbnail;
+}
+
 std::string ImageRenameMetadataService::apply_prefix_to_filename(
     const std::string& suggested_name,
     const std::optional<std::string>& date_prefix,
@@ -0,0 +1,88 @@
+#include "InferenceExecutor.hpp"
+
+#include <algorithm>
+
+InferenceExecutor::InferenceExecutor(std::size_t workers)
+{
+    const std::size_t worker_count = std::max<std::size_t>(1, workers);
+    workers_.reserve(worker_count);
+    for (std::size_t i = 0; i < worker_count; ++i) {
+        workers_.emplace_back([this]() { worker_loop(); });
+    }
+}
+
+InferenceExecutor::~InferenceExecutor()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cancel_all();
+    work_cv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void InferenceExecutor::cancel_all()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& task : queue_) {
+        task.cancel->store(true);
+    }
+    for (auto& cancel : running_) {
+        cancel->store(true);
+    }
+}
+
+void InferenceExecutor::wait_idle()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this]() { return queue_.empty() && running_.empty(); });
+}
+
+void InferenceExecutor::enqueue(std::function<void()> run, CancellationFlag cancel)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(Task{std::move(run), std::move(cancel)});
+    }
+    work_cv_.notify_one();
+}
+
+void InferenceExecutor::worker_loop()
+{
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_cv_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            task = std::move(queue_.front());
+            queue_.pop_front();
+            if (task.cancel->load()) {
+                // Dropping the task breaks its promise, which the waiting future reports.
+                task = Task{};
+                if (queue_.empty() && running_.empty()) {
+                    idle_cv_.notify_all();
+                }
+                continue;
+            }
+            running_.push_back(task.cancel);
+        }
+
+        task.run();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_.erase(std::find(running_.begin(), running_.end(), task.cancel));
+            if (queue_.empty() && running_.empty()) {
+                idle_cv_.notify_all();
+            }
+        }
+    }
+}
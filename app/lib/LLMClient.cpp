@@ -1,7 +1,10 @@
 #include "LLMClient.hpp"
+#include "CategorizationPrompt.hpp"
 #include "Types.hpp"
 #include "Utils.hpp"
 #include "Logger.hpp"
+#include "LLMErrors.hpp"
+#include "RemoteBatchPrompt.hpp"
 #include <curl/curl.h>
 #include <cstdlib>
 #include <filesystem>
@@ -16,6 +19,9 @@
 #include <iostream>
 #include <sstream>
 #include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
 #include <string>
 #include <utility>
 
@@ -27,6 +33,13 @@ static size_t WriteCallback(void *contents, size_t size, size_t nmemb, std::stri
     return totalSize;
 }
 
+// Aborts the transfer once the request's cancellation flag is raised.
+static int CancelProgressCallback(void* data, curl_off_t, curl_off_t, curl_off_t, curl_off_t)
+{
+    const auto* cancelled = static_cast<const std::atomic<bool>*>(data);
+    return cancelled && cancelled->load() ? 1 : 0;
+}
+
 namespace {
 std::string trim_ws(const std::string& value);
 
@@ -95,6 +108,56 @@ bool ends_with(const std::string& value, const std::string& suffix) {
     return std::equal(suffix.rbegin(), suffix.rend(), value.rbegin());
 }
 
+// Delay the server asked for in a 429 response, as sent in the response headers.
+struct RetryAfterHeaders {
+    std::string seconds;
+    std::string milliseconds;
+};
+
+bool header_name_equals(const std::string& line, const std::string& name)
+{
+    if (line.size() <= name.size() || line[name.size()] != ':') {
+        return false;
+    }
+    return std::equal(name.begin(), name.end(), line.begin(), [](char lhs, char rhs) {
+        return std::tolower(static_cast<unsigned char>(lhs)) == std::tolower(static_cast<unsigned char>(rhs));
+    });
+}
+
+size_t HeaderCallback(char* buffer, size_t size, size_t nitems, RetryAfterHeaders* headers)
+{
+    const size_t total_size = size * nitems;
+    const std::string line(buffer, total_size);
+    if (header_name_equals(line, "retry-after")) {
+        headers->seconds = trim_ws(line.substr(line.find(':') + 1));
+    } else if (header_name_equals(line, "retry-after-ms")) {
+        headers->milliseconds = trim_ws(line.substr(line.find(':') + 1));
+    }
+    return total_size;
+}
+
+// Only the delay-seconds form of Retry-After is honored; HTTP dates fall back to the default wait.
+int resolve_retry_after_seconds(const RetryAfterHeaders& headers)
+{
+    const auto parse = [](const std::string& value, double scale) {
+        try {
+            size_t consumed = 0;
+            const double parsed = std::stod(value, &consumed);
+            if (consumed == value.size() && parsed > 0.0) {
+                return static_cast<int>(std::ceil(parsed * scale));
+            }
+        } catch (const std::exception&) {
+        }
+        return 0;
+    };
+    if (!headers.milliseconds.empty()) {
+        if (const int seconds = parse(headers.milliseconds, 0.001); seconds > 0) {
+            return seconds;
+        }
+    }
+    return headers.seconds.empty() ? 0 : parse(headers.seconds, 1.0);
+}
+
 struct CurlRequest {
     CURL* handle{nullptr};
     curl_slist* headers{nullptr};
@@ -168,7 +231,9 @@ void configure_request_payload(CurlRequest& request,
                                const std::string& payload,
                                const std::string& api_key,
                                long timeout_seconds,
-                               std::string& response_buffer)
+                               std::string& response_buffer,
+                               RetryAfterHeaders& retry_after,
+                               const std::atomic<bool>* cancelled)
 {
     curl_easy_setopt(request.handle, CURLOPT_URL, api_url.c_str());
     curl_easy_setopt(request.handle, CURLOPT_POST, 1L);
@@ -184,6 +249,13 @@ void configure_request_payload(CurlRequest& request,
     curl_easy_setopt(request.handle, CURLOPT_POSTFIELDS, payload.c_str());
     curl_easy_setopt(request.handle, CURLOPT_WRITEFUNCTION, WriteCallback);
     curl_easy_setopt(request.handle, CURLOPT_WRITEDATA, &response_buffer);
+    curl_easy_setopt(request.handle, CURLOPT_HEADERFUNCTION, HeaderCallback);
+    curl_easy_setopt(request.handle, CURLOPT_HEADERDATA, &retry_after);
+    if (cancelled) {
+        curl_easy_setopt(request.handle, CURLOPT_NOPROGRESS, 0L);
+        curl_easy_setopt(request.handle, CURLOPT_XFERINFOFUNCTION, CancelProgressCallback);
+        curl_easy_setopt(request.handle, CURLOPT_XFERINFODATA, const_cast<std::atomic<bool>*>(cancelled));
+    }
 }
 
 long perform_request(CurlRequest& request, const std::shared_ptr<spdlog::logger>& logger)
@@ -250,7 +322,13 @@ void LLMClient::set_prompt_logging_enabled(bool enabled)
 }
 
 
-std::string LLMClient::send_api_request(std::string json_payload) {
+void LLMClient::set_cancellation_flag(const std::atomic<bool>* flag)
+{
+    cancellation_flag.store(flag);
+}
+
+
+std::string LLMClient::send_api_request(std::string json_payload, std::size_t item_count) {
     std::string response_string;
     const std::string api_url = resolve_api_url();
     auto logger = Logger::get_logger("core_logger");
@@ -260,9 +338,24 @@ std::string LLMClient::send_api_request(std::string json_payload) {
     }
 
     CurlRequest request = create_curl_request(logger);
-    configure_request_payload(request, api_url, json_payload, api_key, resolve_timeout_seconds(base_url), response_string);
+    RetryAfterHeaders retry_after;
+    configure_request_payload(request,
+                              api_url,
+                              json_payload,
+                              api_key,
+                              resolve_timeout_seconds(base_url) * static_cast<long>(std::max<std::size_t>(1, item_count)),
+                              response_string,
+                              retry_after,
+                              cancellation_flag.load());
 
     const long http_code = perform_request(request, logger);
+    if (http_code == 429) {
+        const int retry_seconds = resolve_retry_after_seconds(retry_after);
+        if (logger) {
+            logger->warn("Remote LLM rate limit reached (retry after {}s)", retry_seconds);
+        }
+        throw BackoffError("Rate Limit Error: Remote LLM server returned HTTP 429.", retry_seconds);
+    }
     return parse_category_response(response_string, http_code, logger);
 }
 
@@ -323,6 +416,45 @@ std::string LLMClient::categorize_file(const std::string& file_name,
 }
 
 
+std::vector<std::string> LLMClient::categorize_files(const std::vector<CategorizationRequest>& requests)
+{
+    if (batch_size <= 1) {
+        return ILLMClient::categorize_files(requests);
+    }
+    return RemoteBatchPrompt::categorize(
+        requests,
+        batch_size,
+        [this](const std::string& system_prompt, const std::string& user_prompt, std::size_t item_count) {
+            if (prompt_logging_enabled) {
+                std::cout << "\n[DEV][PROMPT] Batched categorization request\n" << user_prompt << "\n";
+            }
+            std::string reply = send_api_request(make_generic_payload(system_prompt, user_prompt, 0), item_count);
+            if (prompt_logging_enabled) {
+                std::cout << "[DEV][RESPONSE] Batched categorization reply\n" << reply << "\n";
+            }
+            return reply;
+        },
+        [this](const CategorizationRequest& request) {
+            return categorize_file(request.file_name,
+                                   request.file_path,
+                                   request.file_type,
+                                   request.consistency_context);
+        });
+}
+
+
+std::size_t LLMClient::max_batch_size() const
+{
+    return batch_size;
+}
+
+
+void LLMClient::set_batch_size(std::size_t size)
+{
+    batch_size = std::clamp<std::size_t>(size, 1, RemoteBatchPrompt::kMaxBatchSize);
+}
+
+
 std::string LLMClient::make_payload(const std::string& file_name,
                                     const std::string& file_path,
                                     const FileType file_type,
@@ -354,13 +486,7 @@ std::string LLMClient::make_payload(const std::string& file_name,
 
     last_prompt = prompt;
     const std::string escaped_prompt = escape_json(prompt);
-    const std::string system_prompt =
-        "You are a file categorization assistant. If it's an installer, describe the type of software it installs. "
-        "Consider the filename, extension, and any directory context provided. If the user prompt includes an "
-        "'Allowed main categories' list, choose the main category from that list only. Use Other only when it is "
-        "listed and none of the other listed main categories clearly fits. Always reply with one line in the "
-        "format <Main category> : <Subcategory>. Main category must be broad (one or two words, plural). "
-        "Subcategory must be specific, relevant, and must not repeat the main category.";
+    const std::string& system_prompt = CategorizationPrompt::single_item_system_prompt();
     const std::string escaped_system = escape_json(system_prompt);
 
     std::ostringstream payload;
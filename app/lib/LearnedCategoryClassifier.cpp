@@ -0,0 +1,259 @@
+#include "LearnedCategoryClassifier.hpp"
+
+#include "TextEmbeddingService.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <unordered_set>
+#include <utility>
+
+namespace {
+
+constexpr float kLearningRate = 1.0f;
+constexpr float kWeightDecay = 1e-4f;
+constexpr std::size_t kFitEpochs = 30;
+constexpr std::size_t kIncrementalSteps = 8;
+
+std::string label_key(const std::string& category, const std::string& subcategory)
+{
+    return category + '\x1f' + subcategory;
+}
+
+bool is_whitelist_import(const UserLearningStore::ApprovedExample& example)
+{
+    return example.source.rfind("whitelist:", 0) == 0;
+}
+
+bool has_features(const std::vector<float>& features)
+{
+    return std::any_of(features.begin(), features.end(), [](float value) { return value != 0.0f; });
+}
+
+// Numbers such as years and counters are shared by unrelated files, so only worded tokens count as evidence.
+std::vector<std::string> word_tokens(const std::string& text)
+{
+    auto tokens = TextEmbeddingService::tokens(text);
+    tokens.erase(std::remove_if(tokens.begin(),
+                                tokens.end(),
+                                [](const std::string& token) {
+                                    return std::none_of(token.begin(), token.end(), [](unsigned char ch) {
+                                        return std::isalpha(ch) || ch >= 128;
+                                    });
+                                }),
+                 tokens.end());
+    return tokens;
+}
+
+std::string strip_extension(const std::string& file_name)
+{
+    constexpr std::size_t kMaxExtensionLength = 5;
+    const auto dot = file_name.find_last_of('.');
+    if (dot == std::string::npos || dot == 0 || file_name.size() - dot - 1 > kMaxExtensionLength ||
+        dot + 1 == file_name.size()) {
+        return file_name;
+    }
+    const bool alphanumeric = std::all_of(file_name.begin() + static_cast<std::ptrdiff_t>(dot) + 1,
+                                          file_name.end(),
+                                          [](unsigned char ch) { return std::isalnum(ch); });
+    return alphanumeric ? file_name.substr(0, dot) : file_name;
+}
+
+} // namespace
+
+std::string LearnedCategoryClassifier::feature_text(const std::string& file_name, const std::string& context_text)
+{
+    const std::string stem = strip_extension(file_name);
+    if (context_text.empty()) {
+        return stem;
+    }
+    return stem + "\n" + context_text;
+}
+
+void LearnedCategoryClassifier::sync(const std::vector<UserLearningStore::ApprovedExample>& examples)
+{
+    std::vector<const UserLearningStore::ApprovedExample*> added;
+    std::unordered_set<int> present;
+    bool needs_refit = false;
+    for (const auto& example : examples) {
+        if (is_whitelist_import(example) || example.category.empty() || example.subcategory.empty()) {
+            continue;
+        }
+        present.insert(example.id);
+        const auto it = synced_examples_.find(example.id);
+        if (it == synced_examples_.end()) {
+            added.push_back(&example);
+            continue;
+        }
+        const Label& label = labels_[examples_[it->second].label];
+        if (label.category != example.category || label.subcategory != example.subcategory) {
+            needs_refit = true;
+        }
+    }
+    // Removed examples cannot be unlearned, and a full fit is better when most of the history is new.
+    if (present.size() != synced_examples_.size() + added.size() || added.size() > synced_examples_.size()) {
+        needs_refit = true;
+    }
+
+    if (needs_refit) {
+        clear();
+        for (const auto& example : examples) {
+            if (is_whitelist_import(example) || example.category.empty() || example.subcategory.empty()) {
+                continue;
+            }
+            synced_examples_[example.id] = add_example(
+                feature_text(example.file_name, example.context_text), example.category, example.subcategory);
+        }
+        fit();
+        return;
+    }
+
+    for (const auto* example : added) {
+        const std::size_t index = add_example(
+            feature_text(example->file_name, example->context_text), example->category, example->subcategory);
+        synced_examples_[example->id] = index;
+        learn(index);
+    }
+}
+
+void LearnedCategoryClassifier::train(const std::string& text,
+                                      const std::string& category,
+                                      const std::string& subcategory)
+{
+    if (category.empty() || subcategory.empty()) {
+        return;
+    }
+    learn(add_example(text, category, subcategory));
+}
+
+std::optional<LearnedCategoryClassifier::Prediction> LearnedCategoryClassifier::predict(const std::string& text) const
+{
+    if (labels_.size() < 2) {
+        return std::nullopt;
+    }
+    const auto features = TextEmbeddingService::embed(text);
+    if (!has_features(features)) {
+        return std::nullopt;
+    }
+
+    const auto probs = probabilities(features);
+    const auto best = static_cast<std::size_t>(std::distance(probs.begin(),
+                                                             std::max_element(probs.begin(), probs.end())));
+    const Label& label = labels_[best];
+    if (label.support < kMinimumExamplesPerLabel) {
+        return std::nullopt;
+    }
+    double runner_up = 0.0;
+    for (std::size_t k = 0; k < probs.size(); ++k) {
+        if (k != best) {
+            runner_up = std::max(runner_up, probs[k]);
+        }
+    }
+    if (probs[best] - runner_up < kMinimumMargin) {
+        return std::nullopt;
+    }
+    // Hashed features collide, so a confident score alone does not show the file resembles the examples.
+    const auto tokens = word_tokens(text);
+    if (std::none_of(tokens.begin(), tokens.end(), [&label](const std::string& token) {
+            return label.tokens.contains(token);
+        })) {
+        return std::nullopt;
+    }
+    return Prediction{label.category, label.subcategory, probs[best], label.support};
+}
+
+void LearnedCategoryClassifier::clear()
+{
+    labels_.clear();
+    label_index_.clear();
+    examples_.clear();
+    synced_examples_.clear();
+    replay_state_ = 1;
+}
+
+std::size_t LearnedCategoryClassifier::label_for(const std::string& category, const std::string& subcategory)
+{
+    const auto [it, inserted] = label_index_.emplace(label_key(category, subcategory), labels_.size());
+    if (inserted) {
+        labels_.push_back(
+            Label{category, subcategory, std::vector<float>(TextEmbeddingService::dimension(), 0.0f), 0, {}});
+    }
+    return it->second;
+}
+
+std::size_t LearnedCategoryClassifier::add_example(const std::string& text,
+                                                   const std::string& category,
+                                                   const std::string& subcategory)
+{
+    const std::size_t label = label_for(category, subcategory);
+    ++labels_[label].support;
+    for (auto& token : word_tokens(text)) {
+        labels_[label].tokens.insert(std::move(token));
+    }
+    examples_.push_back(Example{TextEmbeddingService::embed(text), label});
+    return examples_.size() - 1;
+}
+
+// One stochastic gradient step of the cross-entropy loss for a single example.
+void LearnedCategoryClassifier::learn_step(std::size_t example_index)
+{
+    const Example& example = examples_[example_index];
+    if (!has_features(example.features)) {
+        return;
+    }
+    const auto probs = probabilities(example.features);
+    for (std::size_t k = 0; k < labels_.size(); ++k) {
+        const float gradient = static_cast<float>(probs[k]) - (k == example.label ? 1.0f : 0.0f);
+        auto& weights = labels_[k].weights;
+        for (std::size_t i = 0; i < weights.size(); ++i) {
+            weights[i] -= kLearningRate * (gradient * example.features[i] + kWeightDecay * weights[i]);
+        }
+    }
+}
+
+// Learns a new example, replaying earlier ones so older labels are not forgotten.
+void LearnedCategoryClassifier::learn(std::size_t example_index)
+{
+    for (std::size_t step = 0; step < kIncrementalSteps; ++step) {
+        learn_step(example_index);
+        if (example_index > 0) {
+            replay_state_ = replay_state_ * 1103515245u + 12345u;
+            learn_step((replay_state_ >> 16) % example_index);
+        }
+    }
+}
+
+void LearnedCategoryClassifier::fit()
+{
+    std::vector<std::size_t> order(examples_.size());
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    // A fixed seed keeps refits reproducible; shuffling stops long runs of one label from dominating an epoch.
+    std::minstd_rand generator(replay_state_);
+    for (std::size_t epoch = 0; epoch < kFitEpochs; ++epoch) {
+        std::shuffle(order.begin(), order.end(), generator);
+        for (const std::size_t index : order) {
+            learn_step(index);
+        }
+    }
+}
+
+std::vector<double> LearnedCategoryClassifier::probabilities(const std::vector<float>& features) const
+{
+    std::vector<double> scores(labels_.size(), 0.0);
+    for (std::size_t k = 0; k < labels_.size(); ++k) {
+        const auto& weights = labels_[k].weights;
+        scores[k] = std::inner_product(weights.begin(), weights.end(), features.begin(), 0.0);
+    }
+    const double max_score = scores.empty() ? 0.0 : *std::max_element(scores.begin(), scores.end());
+    double total = 0.0;
+    for (auto& score : scores) {
+        score = std::exp(score - max_score);
+        total += score;
+    }
+    for (auto& score : scores) {
+        score /= total;
+    }
+    return scores;
+}
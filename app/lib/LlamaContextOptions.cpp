@@ -0,0 +1,58 @@
+#include "LlamaContextOptions.hpp"
+
+namespace LlamaContextOptions {
+
+namespace {
+
+ggml_type to_ggml_type(KvCacheType cache_type, bool memory_constrained)
+{
+    switch (cache_type) {
+        case KvCacheType::Q8_0: return GGML_TYPE_Q8_0;
+        case KvCacheType::Q4_0: return GGML_TYPE_Q4_0;
+        case KvCacheType::F16: return GGML_TYPE_F16;
+        case KvCacheType::Auto:
+        default:
+            return memory_constrained ? GGML_TYPE_Q8_0 : GGML_TYPE_F16;
+    }
+}
+
+llama_flash_attn_type to_flash_attn_type(FlashAttentionMode mode)
+{
+    switch (mode) {
+        case FlashAttentionMode::On: return LLAMA_FLASH_ATTN_TYPE_ENABLED;
+        case FlashAttentionMode::Off: return LLAMA_FLASH_ATTN_TYPE_DISABLED;
+        case FlashAttentionMode::Auto:
+        default:
+            return LLAMA_FLASH_ATTN_TYPE_AUTO;
+    }
+}
+
+} // namespace
+
+KvCacheConfig resolve(KvCacheType cache_type, FlashAttentionMode flash_attention, bool memory_constrained)
+{
+    KvCacheConfig config;
+    config.flash_attn = to_flash_attn_type(flash_attention);
+    config.type_k = to_ggml_type(cache_type, memory_constrained);
+    config.type_v = config.flash_attn == LLAMA_FLASH_ATTN_TYPE_DISABLED ? GGML_TYPE_F16 : config.type_k;
+    return config;
+}
+
+void apply(llama_context_params& params, const KvCacheConfig& config)
+{
+    params.type_k = config.type_k;
+    params.type_v = config.type_v;
+    params.flash_attn_type = config.flash_attn;
+}
+
+const char* type_label(ggml_type type)
+{
+    switch (type) {
+        case GGML_TYPE_Q8_0: return "q8_0";
+        case GGML_TYPE_Q4_0: return "q4_0";
+        case GGML_TYPE_F16: return "f16";
+        default: return "other";
+    }
+}
+
+} // namespace LlamaContextOptions
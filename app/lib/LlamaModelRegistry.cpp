@@ -0,0 +1,102 @@
+#include "LlamaModelRegistry.hpp"
+
+#include "Logger.hpp"
+
+#include <algorithm>
+#include <utility>
+
+LlamaModelRegistry::LlamaModelRegistry(Loader loader, Releaser releaser)
+    : loader_(std::move(loader)),
+      releaser_(std::move(releaser))
+{
+}
+
+LlamaModelRegistry& LlamaModelRegistry::instance()
+{
+    static LlamaModelRegistry registry(
+        [](const std::string& path, const llama_model_params& params) {
+            return llama_model_load_from_file(path.c_str(), params);
+        },
+        [](llama_model* model) {
+            llama_model_free(model);
+        });
+    return registry;
+}
+
+std::optional<LlamaModelRegistry::Lookup> LlamaModelRegistry::find(const std::string& path,
+                                                                   const std::string& backend)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& entry : entries_) {
+        if (entry.path == path && entry.backend == backend) {
+            return Lookup{entry.model, entry.n_gpu_layers};
+        }
+    }
+    return std::nullopt;
+}
+
+LlamaModelRegistry::ModelHandle LlamaModelRegistry::acquire(const std::string& path,
+                                                            const std::string& backend,
+                                                            const llama_model_params& params)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& entry : entries_) {
+        if (entry.path == path && entry.backend == backend && entry.n_gpu_layers == params.n_gpu_layers) {
+            return entry.model;
+        }
+    }
+
+    release_idle_locked();
+
+    llama_model* raw = loader_ ? loader_(path, params) : nullptr;
+    if (!raw) {
+        return nullptr;
+    }
+
+    ModelHandle handle(raw, releaser_);
+    entries_.push_back(Entry{path, backend, params.n_gpu_layers, handle});
+    if (auto logger = Logger::get_logger("core_logger")) {
+        logger->debug("Model registry now holds {} resident model(s)", entries_.size());
+    }
+    return handle;
+}
+
+void LlamaModelRegistry::release_idle()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    release_idle_locked();
+}
+
+void LlamaModelRegistry::release_all()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (entries_.empty()) {
+        return;
+    }
+    if (auto logger = Logger::get_logger("core_logger")) {
+        logger->info("Releasing {} resident model(s)", entries_.size());
+    }
+    entries_.clear();
+}
+
+std::size_t LlamaModelRegistry::resident_count() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+void LlamaModelRegistry::release_idle_locked()
+{
+    const auto logger = Logger::get_logger("core_logger");
+    entries_.erase(std::remove_if(entries_.begin(), entries_.end(), [&logger](const Entry& entry) {
+                       if (entry.model.use_count() > 1) {
+                           return false;
+                       }
+                       if (logger) {
+                           logger->info("Releasing idle model '{}' (backend {}, n_gpu_layers={})",
+                                        entry.path, entry.backend, entry.n_gpu_layers);
+                       }
+                       return true;
+                   }),
+                   entries_.end());
+}
@@ -1,6 +1,7 @@
 #include "LlavaImageAnalyzer.hpp"
 
 #include "Logger.hpp"
+#include "LlamaContextOptions.hpp"
 #include "LlamaModelParams.hpp"
 #include "Utils.hpp"
 
@@ -73,6 +74,7 @@ constexpr int32_t kVisualBatchRetrySize = 256;
 constexpr int32_t kVisualBatchEmergencySize = 128;
 constexpr int32_t kVisualReducedContextTokens = 2048;
 constexpr int32_t kVisualMinimumContextTokens = 1024;
+constexpr int32_t kMinimumPreparedImageLongSide = 1024;
 constexpr int32_t kVisualGpuLayerRetryScaleNumerator = 3;
 constexpr int32_t kVisualGpuLayerRetryScaleDenominator = 4;
 constexpr int32_t kMinimumVisualGpuLayerRetryCount = 1;
@@ -148,7 +150,8 @@ PromptRequest build_description_request(VisualPromptPolicy policy) {
             << "Description:";
         return {"", oss.str()};
     }
-    case VisualPromptPolicy::StructuredVisionInstruct: {
+    case VisualPromptPolicy::StructuredVisionInstruct:
+    case VisualPromptPolicy::StructuredSinglePass: {
         std::ostringstream oss;
         oss << "Analyze this image for file organization.\n"
             << "<__media__>\n"
@@ -185,7 +188,8 @@ PromptRequest build_filename_request(VisualPromptPolicy policy, std::string_view
             << "Filename:";
         return {"", oss.str()};
     }
-    case VisualPromptPolicy::StructuredVisionInstruct: {
+    case VisualPromptPolicy::StructuredVisionInstruct:
+    case VisualPromptPolicy::StructuredSinglePass: {
         std::ostringstream oss;
         oss << "Create a short filename stem from this image description.\n"
             << "Description: " << description << "\n\n"
@@ -207,6 +211,76 @@ PromptRequest build_filename_request(VisualPromptPolicy policy, std::string_view
     return {"", ""};
 }
 
+constexpr int32_t kSinglePassFilenameTokens = 24;
+
+// Keeps the single-pass reply parseable: one description line, then a filename stem.
+// The description is capped so a rambling reply cannot use up n_predict before the filename line,
+// and the stem allows the three words the prompt asks for.
+constexpr const char* kSinglePassGrammar = R"gbnf(
+root ::= "Description: " description "\nFilename: " stem
+description ::= [^\n]{1,400}
+stem ::= [a-z0-9]+ ("_" [a-z0-9]+){0,2}
+)gbnf";
+
+bool uses_single_pass(VisualPromptPolicy policy) {
+    return policy == VisualPromptPolicy::StructuredSinglePass;
+}
+
+PromptRequest build_single_pass_request(VisualPromptPolicy policy) {
+    if (!uses_single_pass(policy)) {
+        return {"", ""};
+    }
+    std::ostringstream oss;
+    oss << "Analyze this image for file organization.\n"
+        << "<__media__>\n"
+        << "Reply with exactly two lines:\n"
+        << "Description: one concise description that captures the file type or scene, the main subject, "
+        << "the setting or context, any visible text, and concrete details that would help with "
+        << "categorization or naming.\n"
+        << "Filename: a filename stem of at most 3 lowercase words joined with underscores, "
+        << "preferring concrete nouns, without an extension.";
+    return {
+        "You describe images for file organization and retrieval and name them with short "
+        "filesystem-safe filename stems.",
+        oss.str()
+    };
+}
+
+struct SinglePassReply {
+    std::string description;
+    std::string filename;
+};
+
+std::string_view trim_view(std::string_view value) {
+    const auto first = value.find_first_not_of(" \t\r\n");
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    const auto last = value.find_last_not_of(" \t\r\n");
+    return value.substr(first, last - first + 1);
+}
+
+std::optional<SinglePassReply> parse_single_pass_reply(std::string_view reply) {
+    constexpr std::string_view kDescriptionLabel = "Description:";
+    constexpr std::string_view kFilenameLabel = "Filename:";
+
+    reply = trim_view(reply);
+    if (reply.starts_with(kDescriptionLabel)) {
+        reply.remove_prefix(kDescriptionLabel.size());
+    }
+    SinglePassReply parsed;
+    const auto filename_pos = reply.find(kFilenameLabel);
+    if (filename_pos != std::string_view::npos) {
+        parsed.filename = std::string(trim_view(reply.substr(filename_pos + kFilenameLabel.size())));
+        reply = reply.substr(0, filename_pos);
+    }
+    parsed.description = std::string(trim_view(reply));
+    if (parsed.description.empty()) {
+        return std::nullopt;
+    }
+    return parsed;
+}
+
 #if defined(AI_FILE_SORTER_MTMD_LOG_CALLBACK)
 bool is_mtmd_prompt_log_line(std::string_view line) {
     return line.starts_with("add_text:");
@@ -802,6 +876,26 @@ std::optional<int32_t> extract_visual_block_count_gguf(const std::string& model_
     }
     return infer_visual_block_count_from_tensors(ctx);
 }
+
+std::optional<int32_t> read_projector_image_size(const std::string& mmproj_path) {
+    if (!has_gguf_magic(mmproj_path)) {
+        return std::nullopt;
+    }
+
+    gguf_init_params params{};
+    params.no_alloc = true;
+    gguf_context* ctx = gguf_init_from_file(mmproj_path.c_str(), params);
+    if (!ctx) {
+        return std::nullopt;
+    }
+
+    auto cleanup = std::unique_ptr<gguf_context, GgufCtxDeleter>(ctx);
+    const int64_t id = gguf_find_key(ctx, "clip.vision.image_size");
+    if (id < 0) {
+        return std::nullopt;
+    }
+    return read_visual_gguf_numeric(ctx, id);
+}
 #endif
 
 std::optional<int32_t> extract_visual_block_count_from_scan(const std::string& model_path) {
@@ -1127,8 +1221,28 @@ struct ChunkDeleter {
     }
 };
 
+struct SamplerDeleter {
+    void operator()(llama_sampler* ptr) const {
+        if (ptr) {
+            llama_sampler_free(ptr);
+        }
+    }
+};
+
 using BitmapPtr = std::unique_ptr<mtmd_bitmap, BitmapDeleter>;
 using ChunkPtr = std::unique_ptr<mtmd_input_chunks, ChunkDeleter>;
+using SamplerPtr = std::unique_ptr<llama_sampler, SamplerDeleter>;
+
+llama_sampler* make_grammar_sampler(const llama_vocab* vocab, const char* grammar) {
+    llama_sampler* grammar_sampler = llama_sampler_init_grammar(vocab, grammar, "root");
+    if (!grammar_sampler) {
+        return nullptr;
+    }
+    llama_sampler* chain = llama_sampler_chain_init(llama_sampler_chain_default_params());
+    llama_sampler_chain_add(chain, grammar_sampler);
+    llama_sampler_chain_add(chain, llama_sampler_init_greedy());
+    return chain;
+}
 
 llama_token greedy_sample(const float* logits, int vocab_size, float temperature) {
     const float temp = std::max(temperature, 1e-3f);
@@ -1276,6 +1390,18 @@ std::string filename_system_prompt(VisualPromptPolicy policy) {
 std::string filename_user_prompt(VisualPromptPolicy policy, std::string_view description) {
     return build_filename_request(policy, description).user_prompt;
 }
+
+std::string single_pass_user_prompt(VisualPromptPolicy policy) {
+    return build_single_pass_request(policy).user_prompt;
+}
+
+std::optional<std::pair<std::string, std::string>> parse_single_pass_reply(std::string_view reply) {
+    auto parsed = ::parse_single_pass_reply(reply);
+    if (!parsed) {
+        return std::nullopt;
+    }
+    return std::make_pair(std::move(parsed->description), std::move(parsed->filename));
+}
 }
 #endif
 
@@ -1301,6 +1427,9 @@ LlavaImageAnalyzer::LlavaImageAnalyzer(const std::filesystem::path& model_path,
     if (settings_.n_threads <= 0) {
         settings_.n_threads = static_cast<int32_t>(std::max(1u, std::thread::hardware_concurrency()));
     }
+    if (settings_.n_threads_batch <= 0) {
+        settings_.n_threads_batch = settings_.n_threads;
+    }
 
 #ifndef AI_FILE_SORTER_HAS_MTMD
     (void)model_path;
@@ -1384,6 +1513,9 @@ LlavaImageAnalyzer::LlavaImageAnalyzer(const std::filesystem::path& model_path,
     }
 
     text_gpu_enabled_ = settings_.use_gpu && model_params.n_gpu_layers != 0;
+    gpu_memory_constrained_ =
+        text_gpu_enabled_ && model_params.n_gpu_layers > 0 &&
+        model_params.n_gpu_layers < llama_model_n_layer(model_);
     context_tokens_ = settings_.n_ctx;
     batch_size_ = resolve_default_visual_batch_size(text_gpu_enabled_, backend_name);
 
@@ -1404,7 +1536,7 @@ LlavaImageAnalyzer::LlavaImageAnalyzer(const std::filesystem::path& model_path,
 
         mtmd_context_params mm_params = mtmd_context_params_default();
         mm_params.use_gpu = use_gpu;
-        mm_params.n_threads = settings_.n_threads;
+        mm_params.n_threads = settings_.n_threads_batch;
         vision_ctx_ = mtmd_init_from_file(mmproj_path_utf8.c_str(), model_, mm_params);
         if (!vision_ctx_) {
             return false;
@@ -1443,6 +1575,8 @@ LlavaImageAnalyzer::LlavaImageAnalyzer(const std::filesystem::path& model_path,
         cleanup();
         throw;
     }
+    projector_image_size_ = read_projector_image_size(mmproj_path_utf8).value_or(0);
+    single_pass_enabled_ = read_env_bool("AI_FILE_SORTER_VISUAL_SINGLE_PASS").value_or(true);
 #endif
 }
 
@@ -1470,6 +1604,14 @@ void LlavaImageAnalyzer::initialize_context() {
     const int32_t initial_batch =
         batch_size_ > 0 ? batch_size_ : kDefaultVisualCpuBatchSize;
 
+    const auto kv_config = LlamaContextOptions::resolve(
+        settings_.kv_cache_type, settings_.flash_attention, gpu_memory_constrained_);
+    if (logger) {
+        logger->info("Visual KV cache K={} V={}",
+                     LlamaContextOptions::type_label(kv_config.type_k),
+                     LlamaContextOptions::type_label(kv_config.type_v));
+    }
+
     auto try_init_context = [&](int32_t n_ctx, int32_t n_batch) -> bool {
         if (context_) {
             llama_free(context_);
@@ -1484,10 +1626,15 @@ void LlavaImageAnalyzer::initialize_context() {
         ctx_params.n_batch = bounded_batch;
         ctx_params.n_ubatch = bounded_batch;
         ctx_params.n_threads = settings_.n_threads;
-        ctx_params.n_threads_batch = settings_.n_threads;
+        ctx_params.n_threads_batch = settings_.n_threads_batch;
+        LlamaContextOptions::apply(ctx_params, kv_config);
         context_ = llama_init_from_model(model_, ctx_params);
+        if (!context_ && ctx_params.type_v != GGML_TYPE_F16) {
+            ctx_params.type_v = GGML_TYPE_F16;
+            context_ = llama_init_from_model(model_, ctx_params);
+        }
         if (context_) {
-            llama_set_n_threads(context_, settings_.n_threads, settings_.n_threads);
+            llama_set_n_threads(context_, settings_.n_threads, settings_.n_threads_batch);
         }
         return context_ != nullptr;
     };
@@ -1577,34 +1724,103 @@ ImageAnalysisResult LlavaImageAnalyzer::analyze(const std::filesystem::path& ima
     (void)image_path;
     throw std::runtime_error("Visual LLM support is not available in this build.");
 #else
-    auto logger = Logger::get_logger("core_logger");
     const auto analysis_started = std::chrono::steady_clock::now();
     const std::string image_path_utf8 = Utils::path_to_utf8(image_path);
-    const auto bitmap_started = std::chrono::steady_clock::now();
     BitmapPtr bitmap(mtmd_helper_bitmap_init_from_file(vision_ctx_, image_path_utf8.c_str()));
     if (!bitmap) {
         throw std::runtime_error("Failed to load image for visual analysis: " + image_path_utf8);
     }
+    const double bitmap_load_ms = elapsed_ms(analysis_started, std::chrono::steady_clock::now());
+    return analyze_bitmap(bitmap.get(), image_path, bitmap_load_ms, analysis_started);
+#endif
+}
+
+ImageAnalysisResult LlavaImageAnalyzer::analyze(const PreparedImage& image) {
+#ifndef AI_FILE_SORTER_HAS_MTMD
+    (void)image;
+    throw std::runtime_error("Visual LLM support is not available in this build.");
+#else
+    if (image.rgb.empty() ||
+        image.rgb.size() != static_cast<std::size_t>(image.width) * image.height * 3) {
+        return analyze(image.path);
+    }
+    const auto analysis_started = std::chrono::steady_clock::now();
+    BitmapPtr bitmap(mtmd_bitmap_init(image.width, image.height, image.rgb.data()));
+    if (!bitmap) {
+        return analyze(image.path);
+    }
+    return analyze_bitmap(bitmap.get(), image.path, image.decode_ms, analysis_started);
+#endif
+}
+
+int32_t LlavaImageAnalyzer::preferred_input_long_side() const {
+#ifdef AI_FILE_SORTER_HAS_MTMD
+    if (projector_image_size_ <= 0) {
+        return 0;
+    }
+    // Tiling projectors (LLaVA-NeXT anyres, Qwen2-VL) still benefit from some detail above the base size.
+    return std::max(kMinimumPreparedImageLongSide, projector_image_size_ * 2);
+#else
+    return 0;
+#endif
+}
+
+int32_t LlavaImageAnalyzer::minimum_input_long_side() const {
+#ifdef AI_FILE_SORTER_HAS_MTMD
+    return std::max(0, projector_image_size_);
+#else
+    return 0;
+#endif
+}
+
+#ifdef AI_FILE_SORTER_HAS_MTMD
+ImageAnalysisResult LlavaImageAnalyzer::analyze_bitmap(mtmd_bitmap* bitmap,
+                                                       const std::filesystem::path& image_path,
+                                                       double bitmap_load_ms,
+                                                       std::chrono::steady_clock::time_point analysis_started) {
+    auto logger = Logger::get_logger("core_logger");
     ImageAnalysisDiagnostics diagnostics;
     diagnostics.available = true;
-    diagnostics.bitmap_load_ms = elapsed_ms(bitmap_started, std::chrono::steady_clock::now());
+    diagnostics.bitmap_load_ms = bitmap_load_ms;
     diagnostics.batch_size = batch_size_;
     diagnostics.text_gpu_enabled = text_gpu_enabled_;
     diagnostics.mmproj_gpu_enabled = mmproj_gpu_enabled_;
 
-    const auto description_request = build_description_request(prompt_policy_);
-    const std::string description = infer_text(bitmap.get(),
-                                               description_request.system_prompt,
-                                               description_request.user_prompt,
-                                               settings_.n_predict,
-                                               &diagnostics.description_pass);
-
-    const auto filename_request = build_filename_request(prompt_policy_, description);
-    const std::string raw_filename = infer_text(nullptr,
-                                                filename_request.system_prompt,
-                                                filename_request.user_prompt,
-                                                settings_.n_predict,
-                                                &diagnostics.filename_pass);
+    std::string description;
+    std::string raw_filename;
+    if (single_pass_enabled_ && uses_single_pass(prompt_policy_)) {
+        const auto request = build_single_pass_request(prompt_policy_);
+        const std::string reply = infer_text(bitmap,
+                                             request.system_prompt,
+                                             request.user_prompt,
+                                             settings_.n_predict + kSinglePassFilenameTokens,
+                                             &diagnostics.description_pass,
+                                             kSinglePassGrammar);
+        if (auto parsed = parse_single_pass_reply(reply)) {
+            description = std::move(parsed->description);
+            raw_filename = std::move(parsed->filename);
+        } else if (logger) {
+            logger->warn("Single-pass visual reply could not be parsed; using separate passes");
+        }
+    }
+
+    if (description.empty()) {
+        const auto description_request = build_description_request(prompt_policy_);
+        description = infer_text(bitmap,
+                                 description_request.system_prompt,
+                                 description_request.user_prompt,
+                                 settings_.n_predict,
+                                 &diagnostics.description_pass);
+    }
+
+    if (raw_filename.empty()) {
+        const auto filename_request = build_filename_request(prompt_policy_, description);
+        raw_filename = infer_text(nullptr,
+                                  filename_request.system_prompt,
+                                  filename_request.user_prompt,
+                                  settings_.n_predict,
+                                  &diagnostics.filename_pass);
+    }
     diagnostics.batch_size = batch_size_;
     if (logger) {
         logger->info("Visual raw filename: {}", raw_filename);
@@ -1626,8 +1842,8 @@ ImageAnalysisResult LlavaImageAnalyzer::analyze(const std::filesystem::path& ima
         logger->info("Visual suggested filename: {}", result.suggested_name);
     }
     return result;
-#endif
 }
+#endif
 
 #ifdef AI_FILE_SORTER_HAS_MTMD
 void LlavaImageAnalyzer::mtmd_progress_callback(const char* name,
@@ -1689,7 +1905,8 @@ std::string LlavaImageAnalyzer::infer_text(mtmd_bitmap* bitmap,
                                            std::string_view system_prompt,
                                            const std::string& user_prompt,
                                            int32_t max_tokens,
-                                           ImageInferenceDiagnostics* diagnostics) {
+                                           ImageInferenceDiagnostics* diagnostics,
+                                           const char* grammar) {
     auto logger = Logger::get_logger("core_logger");
     if (!context_) {
         initialize_context();
@@ -1831,15 +2048,27 @@ std::string LlavaImageAnalyzer::infer_text(mtmd_bitmap* bitmap,
     std::string response;
     response.reserve(kGeneratedResponseReserveBytes);
 
+    SamplerPtr constrained_sampler;
+    if (grammar) {
+        constrained_sampler.reset(make_grammar_sampler(vocab_, grammar));
+        if (!constrained_sampler && logger) {
+            logger->warn("Failed to initialize visual output grammar; generating without constraints");
+        }
+    }
+
     const int vocab_size = llama_vocab_n_tokens(vocab_);
     const auto generation_started = std::chrono::steady_clock::now();
     for (int32_t i = 0; i < max_tokens; ++i) {
-        const float* logits = llama_get_logits(context_);
-        if (!logits) {
-            throw std::runtime_error("llama_get_logits returned nullptr");
+        llama_token token_id = LLAMA_TOKEN_NULL;
+        if (constrained_sampler) {
+            token_id = llama_sampler_sample(constrained_sampler.get(), context_, -1);
+        } else {
+            const float* logits = llama_get_logits(context_);
+            if (!logits) {
+                throw std::runtime_error("llama_get_logits returned nullptr");
+            }
+            token_id = greedy_sample(logits, vocab_size, settings_.temperature);
         }
-
-        llama_token token_id = greedy_sample(logits, vocab_size, settings_.temperature);
         if (llama_vocab_is_eog(vocab_, token_id)) {
             break;
         }
@@ -1870,12 +2099,14 @@ std::string LlavaImageAnalyzer::infer_text(void* bitmap,
                                            std::string_view system_prompt,
                                            const std::string& user_prompt,
                                            int32_t max_tokens,
-                                           ImageInferenceDiagnostics* diagnostics) {
+                                           ImageInferenceDiagnostics* diagnostics,
+                                           const char* grammar) {
     (void)bitmap;
     (void)system_prompt;
     (void)user_prompt;
     (void)max_tokens;
     (void)diagnostics;
+    (void)grammar;
     throw std::runtime_error("Visual LLM support is not available in this build.");
 }
 #endif
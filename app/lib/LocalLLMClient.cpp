@@ -1,5 +1,8 @@
 #include "LocalLLMClient.hpp"
 #include "FileCategoryPolicy.hpp"
+#include "GpuLayerProfileCache.hpp"
+#include "LlamaContextOptions.hpp"
+#include "LlamaModelRegistry.hpp"
 #include "Logger.hpp"
 #include "Utils.hpp"
 #include "TestHooks.hpp"
@@ -29,6 +32,11 @@
 #include <string>
 #include <array>
 #include <utility>
+#include <iterator>
+#include <functional>
+#include <cstdint>
+#include <chrono>
+#include <thread>
 
 #if defined(__APPLE__)
 #include <mach/mach.h>
@@ -122,6 +130,10 @@ constexpr int kFirstBatchFallbackTokens = 1024;
 constexpr int kSecondBatchFallbackTokens = 512;
 constexpr int kThirdBatchFallbackTokens = 256;
 constexpr int kDefaultCompletionTokens = 256;
+constexpr int kCategorizationResponseTokens = 64;
+constexpr int kDefaultLocalBatchSequences = 4;
+constexpr int kMaximumLocalBatchSequences = 8;
+constexpr int kMaximumBatchContextTokens = 16384;
 constexpr std::size_t kEstimatedPromptBufferBytes = 4096;
 constexpr std::size_t kTokenPieceBufferBytes = 128;
 constexpr std::size_t kMetadataScanBytes = 8ULL * 1024ULL * 1024ULL;
@@ -200,6 +212,40 @@ int resolve_context_length() {
     return kDefaultLocalLlmContextTokens;
 }
 
+int kv_cache_context_scale(ggml_type type_k) {
+    // Quantized caches take roughly half (q8_0) or a quarter (q4_0) of the f16 footprint.
+    switch (type_k) {
+        case GGML_TYPE_Q8_0: return 2;
+        case GGML_TYPE_Q4_0: return 4;
+        default: return 1;
+    }
+}
+
+std::size_t resolve_batch_sequences(int per_sequence_context, int kv_context_scale = 1) {
+    int parsed = kDefaultLocalBatchSequences;
+    int value = 0;
+    if (try_parse_env_int("AI_FILE_SORTER_LOCAL_BATCH_SIZE", value)) {
+        parsed = value;
+    }
+    // The single-request context stays allocated beside the batched one, so it takes one slot of the budget.
+    const int budget_contexts =
+        (kMaximumBatchContextTokens * std::max(1, kv_context_scale)) / std::max(1, per_sequence_context);
+    const int context_cap = std::max(1, budget_contexts - 1);
+    return static_cast<std::size_t>(std::clamp(parsed, 1, std::min(kMaximumLocalBatchSequences, context_cap)));
+}
+
+std::string resolve_backend_tag() {
+    const char* value = std::getenv("AI_FILE_SORTER_GPU_BACKEND");
+    if (!value || *value == '\0') {
+        return "auto";
+    }
+    std::string lowered(value);
+    std::transform(lowered.begin(), lowered.end(), lowered.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return lowered;
+}
+
 bool is_cpu_backend_requested() {
     auto is_cpu_env = [](const char* value) {
         if (!value || *value == '\0') {
@@ -922,79 +968,129 @@ int prompt_token_budget(int context_tokens, int max_tokens) {
     return std::max(1, context_tokens - generation_reserve);
 }
 
-std::string truncate_with_ellipsis(std::string value, std::size_t limit) {
-    if (value.size() <= limit) {
-        return value;
+enum class PromptSectionKind {
+    Fixed,
+    FileContext,
+    Hints,
+    Candidates
+};
+
+struct PromptSection {
+    std::string text;
+    PromptSectionKind kind{PromptSectionKind::Fixed};
+};
+
+struct PromptSectionMarker {
+    std::string_view marker;
+    PromptSectionKind kind;
+};
+
+constexpr std::array<PromptSectionMarker, 11> kPromptSectionMarkers = {{
+    {"\nDocument summary: ", PromptSectionKind::FileContext},
+    {"\nImage description: ", PromptSectionKind::FileContext},
+    {"\nRecent assignments for similar items:", PromptSectionKind::Hints},
+    {"\nAllowed main categories", PromptSectionKind::Candidates},
+    {"\nAllowed subcategories", PromptSectionKind::Candidates},
+    {"\nFile name:", PromptSectionKind::Fixed},
+    {"\nDirectory name:", PromptSectionKind::Fixed},
+    {"\nPath:", PromptSectionKind::Fixed},
+    {"\nFull path:", PromptSectionKind::Fixed},
+    {"\nDetermine the canonical main category and subcategory", PromptSectionKind::Fixed},
+    {"\nAnswer with exactly one line:", PromptSectionKind::Fixed}
+}};
+
+// Trim order and the token floor each section keeps while the prompt is over budget.
+struct PromptSectionTrimRule {
+    PromptSectionKind kind;
+    std::size_t minimum_tokens;
+};
+
+constexpr std::array<PromptSectionTrimRule, 3> kPromptSectionTrimOrder = {{
+    {PromptSectionKind::Hints, 0},
+    {PromptSectionKind::FileContext, 64},
+    {PromptSectionKind::Candidates, 96}
+}};
+
+// Tokenizing sections on their own can differ from the full prompt by a token at each boundary.
+constexpr int kPromptBudgetSlackTokens = 8;
+// Tokens kept from the end of an over-budget prompt: the answer format and assistant header.
+constexpr int kPromptTailKeepTokens = 64;
+
+std::vector<PromptSection> split_prompt_sections(const std::string& prompt) {
+    std::vector<std::pair<std::size_t, PromptSectionKind>> boundaries;
+    for (const auto& entry : kPromptSectionMarkers) {
+        for (auto pos = prompt.find(entry.marker); pos != std::string::npos;
+             pos = prompt.find(entry.marker, pos + 1)) {
+            boundaries.emplace_back(pos, entry.kind);
+        }
     }
-    if (limit <= 3) {
-        value.resize(limit);
-        return value;
+    std::sort(boundaries.begin(), boundaries.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first < rhs.first;
+    });
+
+    std::vector<PromptSection> sections;
+    std::size_t section_start = 0;
+    PromptSectionKind section_kind = PromptSectionKind::Fixed;
+    for (const auto& [pos, kind] : boundaries) {
+        if (pos > section_start) {
+            sections.push_back({prompt.substr(section_start, pos - section_start), section_kind});
+        }
+        section_start = pos;
+        section_kind = kind;
     }
-    value.resize(limit - 3);
-    value += "...";
-    return value;
+    if (section_start < prompt.size()) {
+        sections.push_back({prompt.substr(section_start), section_kind});
+    }
+    return sections;
 }
 
-std::string shrink_user_prompt_for_context(const std::string& prompt, int attempt) {
-    static const std::array<std::size_t, 4> kSummaryBudgets = {1200, 800, 500, 300};
-    static const std::array<std::size_t, 4> kPromptBudgets = {1800, 1400, 1000, 700};
+std::string fit_user_prompt_sections(
+    const std::string& prompt,
+    int overflow_tokens,
+    const std::function<std::vector<std::string>(const std::string&)>& token_pieces) {
+    if (overflow_tokens <= 0) {
+        return prompt;
+    }
 
-    auto trim_labeled_section = [&](std::string text, std::string_view marker) {
-        const auto marker_pos = text.find(marker);
-        if (marker_pos == std::string::npos) {
-            return text;
+    std::vector<PromptSection> sections = split_prompt_sections(prompt);
+    std::vector<std::vector<std::string>> pieces(sections.size());
+    std::vector<std::size_t> kept(sections.size(), 0);
+    for (std::size_t i = 0; i < sections.size(); ++i) {
+        if (sections[i].kind != PromptSectionKind::Fixed) {
+            pieces[i] = token_pieces(sections[i].text);
+            kept[i] = pieces[i].size();
         }
+    }
 
-        std::size_t suffix_start = std::string::npos;
-        constexpr std::array<std::string_view, 8> kSectionMarkers = {
-            "\nFile name:",
-            "\nDirectory name:",
-            "\nPath:",
-            "\nAllowed main categories",
-            "\nAllowed subcategories",
-            "\nDetermine the canonical main category and subcategory",
-            "\nRecent assignments for similar items:",
-            "\nAnswer with exactly one line:"
-        };
-        for (const std::string_view section_marker : kSectionMarkers) {
-            const auto section_pos = text.find(section_marker, marker_pos + 1);
-            if (section_pos != std::string::npos) {
-                suffix_start = suffix_start == std::string::npos
-                    ? section_pos
-                    : std::min(suffix_start, section_pos);
+    auto remaining = static_cast<std::size_t>(overflow_tokens);
+    for (const auto& rule : kPromptSectionTrimOrder) {
+        for (std::size_t i = 0; i < sections.size() && remaining > 0; ++i) {
+            if (sections[i].kind != rule.kind || kept[i] <= rule.minimum_tokens) {
+                continue;
             }
+            const std::size_t removable = kept[i] - rule.minimum_tokens;
+            const std::size_t removed = std::min(removable, remaining);
+            kept[i] -= removed;
+            remaining -= removed;
         }
-        if (suffix_start == std::string::npos) {
-            suffix_start = text.size();
-        }
+    }
 
-        const std::size_t section_start = marker_pos + marker.size();
-        const std::size_t section_length = suffix_start > section_start ? suffix_start - section_start : 0;
-        const std::size_t budget = kSummaryBudgets[std::min<std::size_t>(
-            static_cast<std::size_t>(attempt),
-            kSummaryBudgets.size() - 1)];
-        if (section_length <= budget) {
-            return text;
+    std::string fitted;
+    fitted.reserve(prompt.size());
+    for (std::size_t i = 0; i < sections.size(); ++i) {
+        if (sections[i].kind == PromptSectionKind::Fixed || kept[i] == pieces[i].size()) {
+            fitted += sections[i].text;
+            continue;
         }
-
-        const std::string prefix = text.substr(0, section_start);
-        const std::string section = truncate_with_ellipsis(text.substr(section_start, section_length), budget);
-        const std::string suffix = text.substr(suffix_start);
-        return prefix + section + suffix;
-    };
-
-    std::string trimmed = prompt;
-    trimmed = trim_labeled_section(std::move(trimmed), "\nDocument summary: ");
-    trimmed = trim_labeled_section(std::move(trimmed), "\nImage description: ");
-
-    const std::size_t budget = kPromptBudgets[std::min<std::size_t>(
-        static_cast<std::size_t>(attempt),
-        kPromptBudgets.size() - 1)];
-    if (trimmed.size() > budget) {
-        return truncate_with_ellipsis(trimmed, budget);
+        if (kept[i] == 0) {
+            continue;
+        }
+        for (std::size_t piece = 0; piece < kept[i]; ++piece) {
+            fitted += pieces[i][piece];
+        }
+        fitted += "...";
     }
-
-    return trimmed;
+    return fitted;
 }
 
 bool is_probably_integrated_gpu(ggml_backend_dev_t device,
@@ -1419,50 +1515,380 @@ bool tokenize_prompt(const llama_vocab* vocab,
     return true;
 }
 
+std::vector<std::string> tokenize_to_pieces(const llama_vocab* vocab, const std::string& text)
+{
+    std::vector<std::string> pieces;
+    const int n_tokens = -llama_tokenize(vocab, text.c_str(), text.size(), nullptr, 0, false, false);
+    if (n_tokens <= 0) {
+        return pieces;
+    }
+    std::vector<llama_token> tokens(static_cast<std::size_t>(n_tokens));
+    if (llama_tokenize(vocab, text.c_str(), text.size(), tokens.data(), tokens.size(), false, false) < 0) {
+        return pieces;
+    }
+    pieces.reserve(tokens.size());
+    char buf[kTokenPieceBufferBytes];
+    for (const llama_token token : tokens) {
+        const int n = llama_token_to_piece(vocab, token, buf, sizeof(buf), 0, false);
+        pieces.emplace_back(buf, n > 0 ? static_cast<std::size_t>(n) : 0);
+    }
+    return pieces;
+}
+
+void truncate_prompt_to_budget(std::vector<llama_token>& prompt_tokens,
+                               int& n_prompt,
+                               int prompt_budget,
+                               const std::shared_ptr<spdlog::logger>& logger)
+{
+    if (prompt_budget <= 0 || n_prompt <= prompt_budget) {
+        return;
+    }
+    // Drop from the middle so the system prompt and the answer format both survive.
+    const int tail = std::min(kPromptTailKeepTokens, prompt_budget / 2);
+    const int head = prompt_budget - tail;
+    const int overflow = n_prompt - prompt_budget;
+    if (logger) {
+        logger->warn("Prompt tokens ({}) exceed prompt budget ({}); dropping {} token(s) from the middle",
+                     n_prompt, prompt_budget, overflow);
+    }
+    prompt_tokens.erase(prompt_tokens.begin() + head, prompt_tokens.end() - tail);
+    n_prompt = prompt_budget;
+}
+
+bool build_prompt_tokens(llama_model* model,
+                         const llama_vocab* vocab,
+                         const std::string& system_prompt,
+                         const std::string& prompt,
+                         int context_budget,
+                         std::vector<llama_token>& prompt_tokens,
+                         int& n_prompt,
+                         const std::shared_ptr<spdlog::logger>& logger)
+{
+    std::string final_prompt;
+    if (!format_prompt(model, system_prompt, prompt, final_prompt)) {
+        if (logger) {
+            logger->error("Failed to apply chat template to prompt");
+        }
+        return false;
+    }
+    if (!tokenize_prompt(vocab, final_prompt, prompt_tokens, n_prompt, logger)) {
+        return false;
+    }
+    if (context_budget <= 0 || n_prompt <= context_budget) {
+        return true;
+    }
+
+    const int overflow = n_prompt - context_budget + kPromptBudgetSlackTokens;
+    const std::string fitted_prompt = fit_user_prompt_sections(
+        prompt, overflow, [vocab](const std::string& text) { return tokenize_to_pieces(vocab, text); });
+    if (fitted_prompt == prompt) {
+        if (logger) {
+            logger->warn("Prompt tokens ({}) exceed prompt budget ({}) with nothing left to trim",
+                         n_prompt,
+                         context_budget);
+        }
+        return true;
+    }
+    if (logger) {
+        logger->info("Prompt tokens ({}) exceed prompt budget ({}); trimmed hints and file context by {} char(s)",
+                     n_prompt,
+                     context_budget,
+                     prompt.size() - std::min(prompt.size(), fitted_prompt.size()));
+    }
+    if (!format_prompt(model, system_prompt, fitted_prompt, final_prompt)) {
+        if (logger) {
+            logger->error("Failed to apply chat template to prompt");
+        }
+        return false;
+    }
+    return tokenize_prompt(vocab, final_prompt, prompt_tokens, n_prompt, logger);
+}
+
+// Forces "Category : Subcategory" with each label capped at the 80 characters label validation accepts.
+constexpr const char* kCategorizationGrammar = R"gbnf(
+root  ::= label " : " label
+label ::= head tail{0,79}
+head  ::= [^ :/\\\n\r\t]
+tail  ::= [^:/\\\n\r\t]
+)gbnf";
+
+llama_sampler* make_sampler_chain(const llama_vocab* vocab = nullptr,
+                                  const char* grammar = nullptr,
+                                  const std::shared_ptr<spdlog::logger>& logger = nullptr)
+{
+    llama_sampler* chain = llama_sampler_chain_init(llama_sampler_chain_default_params());
+    if (vocab && grammar) {
+        if (llama_sampler* grammar_sampler = llama_sampler_init_grammar(vocab, grammar, "root")) {
+            llama_sampler_chain_add(chain, grammar_sampler);
+        } else if (logger) {
+            logger->warn("Failed to initialize categorization grammar; sampling without constraints");
+        }
+    }
+    llama_sampler_chain_add(chain, llama_sampler_init_min_p(kDefaultMinPSampler, 1));
+    llama_sampler_chain_add(chain, llama_sampler_init_temp(kDefaultTemperatureSampler));
+    llama_sampler_chain_add(chain, llama_sampler_init_dist(LLAMA_DEFAULT_SEED));
+    return chain;
+}
+
+constexpr int kThreadCalibrationContextTokens = 256;
+constexpr std::size_t kThreadCalibrationPromptTokens = 64;
+constexpr int kThreadCalibrationGenerationTokens = 8;
+constexpr const char* kThreadCalibrationSampleText =
+    "Quarterly invoice from the accounting department covering office supplies, travel expenses "
+    "and software subscriptions for the regional sales team. ";
+
+std::vector<int> thread_calibration_candidates(unsigned int hardware_threads)
+{
+    const int total = static_cast<int>(std::max(1u, hardware_threads));
+    // Half the logical threads approximates the physical core count on SMT machines.
+    std::vector<int> candidates{total, (total * 3) / 4, total / 2, total / 4};
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [](int value) {
+                         return value < 1;
+                     }),
+                     candidates.end());
+    std::sort(candidates.begin(), candidates.end(), std::greater<int>());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    return candidates;
+}
+
+struct DecodeRates {
+    double prompt_tokens_per_second{0.0};
+    double generation_tokens_per_second{0.0};
+};
+
+std::optional<DecodeRates> measure_decode_rates(llama_context* ctx,
+                                                std::vector<llama_token>& tokens,
+                                                int threads)
+{
+    using Clock = std::chrono::steady_clock;
+    llama_set_n_threads(ctx, threads, threads);
+    llama_memory_clear(llama_get_memory(ctx), true);
+
+    const auto prompt_start = Clock::now();
+    if (llama_decode(ctx, llama_batch_get_one(tokens.data(), static_cast<int32_t>(tokens.size())))) {
+        return std::nullopt;
+    }
+    llama_synchronize(ctx);
+    const std::chrono::duration<double> prompt_elapsed = Clock::now() - prompt_start;
+
+    llama_token token = tokens.back();
+    const auto generation_start = Clock::now();
+    for (int i = 0; i < kThreadCalibrationGenerationTokens; ++i) {
+        if (llama_decode(ctx, llama_batch_get_one(&token, 1))) {
+            return std::nullopt;
+        }
+    }
+    llama_synchronize(ctx);
+    const std::chrono::duration<double> generation_elapsed = Clock::now() - generation_start;
+
+    DecodeRates rates;
+    rates.prompt_tokens_per_second =
+        static_cast<double>(tokens.size()) / std::max(prompt_elapsed.count(), 1e-6);
+    rates.generation_tokens_per_second =
+        kThreadCalibrationGenerationTokens / std::max(generation_elapsed.count(), 1e-6);
+    return rates;
+}
+
+std::size_t reusable_prefix_length(const std::vector<llama_token>& cached_tokens,
+                                   const std::vector<llama_token>& prompt_tokens)
+{
+    if (prompt_tokens.empty()) {
+        return 0;
+    }
+    const auto mismatch = std::mismatch(cached_tokens.begin(), cached_tokens.end(),
+                                        prompt_tokens.begin(), prompt_tokens.end());
+    const auto common = static_cast<std::size_t>(std::distance(cached_tokens.begin(), mismatch.first));
+    // At least one prompt token must be decoded so the sampler sees fresh logits.
+    return std::min(common, prompt_tokens.size() - 1);
+}
+
+constexpr std::size_t kMinimumSnapshotPrefixTokens = 32;
+constexpr std::size_t kMaximumPromptStateSnapshots = 8;
+constexpr std::string_view kPromptStateSnapshotExtension = ".kvstate";
+
+std::uint64_t fnv1a_append(std::uint64_t hash, std::string_view data)
+{
+    constexpr std::uint64_t kFnvPrime = 1099511628211ull;
+    for (const unsigned char ch : data) {
+        hash ^= static_cast<std::uint64_t>(ch);
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+std::string model_file_identity(const std::string& model_path)
+{
+    // The model is identified by path, size and modification time; hashing a
+    // multi-gigabyte GGUF on every start would cost more than the caches save.
+    const auto path = Utils::utf8_to_path(model_path);
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(path, ec);
+    const auto model_size = ec ? 0 : static_cast<std::uint64_t>(size);
+    const auto write_time = std::filesystem::last_write_time(path, ec);
+    const auto model_time = ec ? 0 : static_cast<long long>(write_time.time_since_epoch().count());
+    return model_path + "|" + std::to_string(model_size) + "|" + std::to_string(model_time);
+}
+
+constexpr const char* kGpuLayerProfileFileName = "gpu_layer_profiles.json";
+
+std::uint64_t total_gpu_memory_bytes()
+{
+    // CUDA and Vulkan can both list the same physical GPU, so sum per backend and keep the largest view.
+    std::unordered_map<ggml_backend_reg_t, std::uint64_t> per_backend;
+    for (size_t i = 0; i < ggml_backend_dev_count(); ++i) {
+        ggml_backend_dev_t device = ggml_backend_dev_get(i);
+        const auto type = ggml_backend_dev_type(device);
+        if (type != GGML_BACKEND_DEVICE_TYPE_GPU && type != GGML_BACKEND_DEVICE_TYPE_IGPU) {
+            continue;
+        }
+        size_t free_bytes = 0;
+        size_t total_bytes = 0;
+        ggml_backend_dev_memory(device, &free_bytes, &total_bytes);
+        per_backend[ggml_backend_dev_backend_reg(device)] += static_cast<std::uint64_t>(total_bytes);
+    }
+    std::uint64_t total = 0;
+    for (const auto& [reg, bytes] : per_backend) {
+        total = std::max(total, bytes);
+    }
+    return total;
+}
+
+std::string prompt_state_snapshot_name(const std::string& model_path,
+                                       const std::string& backend_tag,
+                                       const std::string& system_prompt,
+                                       const llama_context_params& params)
+{
+    std::ostringstream key;
+    key << model_file_identity(model_path) << '\n' << backend_tag << '\n'
+        << params.n_ctx << ':' << params.n_batch << ':' << params.n_ubatch << ':'
+        << static_cast<int>(params.type_k) << ':' << static_cast<int>(params.type_v) << ':'
+        << (params.offload_kqv ? 1 : 0) << '\n';
+
+    std::uint64_t hash = fnv1a_append(14695981039346656037ull, key.str());
+    hash = fnv1a_append(hash, system_prompt);
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "prefix-%016llx", static_cast<unsigned long long>(hash));
+    return std::string(name) + std::string(kPromptStateSnapshotExtension);
+}
+
+void prune_prompt_state_snapshots(const std::filesystem::path& directory,
+                                  const std::shared_ptr<spdlog::logger>& logger)
+{
+    std::error_code ec;
+    std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> snapshots;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+        if (!entry.is_regular_file(ec) || entry.path().extension() != kPromptStateSnapshotExtension) {
+            continue;
+        }
+        snapshots.emplace_back(entry.last_write_time(ec), entry.path());
+    }
+    if (snapshots.size() <= kMaximumPromptStateSnapshots) {
+        return;
+    }
+    std::sort(snapshots.begin(), snapshots.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first > rhs.first;
+    });
+    for (std::size_t i = kMaximumPromptStateSnapshots; i < snapshots.size(); ++i) {
+        std::filesystem::remove(snapshots[i].second, ec);
+        if (logger) {
+            logger->debug("Removed stale prompt state snapshot '{}'", Utils::path_to_utf8(snapshots[i].second));
+        }
+    }
+}
+
+int retain_cached_prefix(llama_context* ctx,
+                         std::vector<llama_token>& kv_tokens,
+                         const std::vector<llama_token>& prompt_tokens,
+                         const std::shared_ptr<spdlog::logger>& logger)
+{
+    llama_memory_t memory = llama_get_memory(ctx);
+    const std::size_t n_keep = reusable_prefix_length(kv_tokens, prompt_tokens);
+    if (n_keep > 0 && llama_memory_seq_rm(memory, 0, static_cast<llama_pos>(n_keep), -1)) {
+        kv_tokens.resize(n_keep);
+        if (logger) {
+            logger->debug("Reusing {} cached prompt token(s) of {}", n_keep, prompt_tokens.size());
+        }
+        return static_cast<int>(n_keep);
+    }
+    llama_memory_clear(memory, true);
+    kv_tokens.clear();
+    return 0;
+}
+
+bool cancellation_requested(const std::atomic<bool>* cancelled)
+{
+    return cancelled && cancelled->load(std::memory_order_relaxed);
+}
+
+// Drops whatever a failed or aborted decode left on sequence 0 past the tokens known to be cached.
+void discard_unconfirmed_tokens(llama_context* ctx, std::vector<llama_token>& kv_tokens)
+{
+    llama_memory_t memory = llama_get_memory(ctx);
+    if (!llama_memory_seq_rm(memory, 0, static_cast<llama_pos>(kv_tokens.size()), -1)) {
+        llama_memory_clear(memory, true);
+        kv_tokens.clear();
+    }
+}
+
 std::string run_generation_loop(llama_context* ctx,
                                 llama_sampler* smpl,
                                 std::vector<llama_token>& prompt_tokens,
                                 int n_prompt,
                                 int max_tokens,
                                 const std::shared_ptr<spdlog::logger>& logger,
-                                const llama_vocab* vocab)
+                                const llama_vocab* vocab,
+                                std::vector<llama_token>& kv_tokens,
+                                const std::atomic<bool>* cancelled,
+                                const std::function<void(std::size_t)>& on_prefix_retained = {})
 {
     const int ctx_n_ctx = static_cast<int>(llama_n_ctx(ctx));
     int ctx_n_batch = static_cast<int>(llama_n_batch(ctx));
     if (ctx_n_batch <= 0) {
         ctx_n_batch = ctx_n_ctx;
     }
+    // Prompt chunks are one ubatch each so a cancellation is noticed between ubatches.
+    const int ctx_n_ubatch = static_cast<int>(llama_n_ubatch(ctx));
+    if (ctx_n_ubatch > 0) {
+        ctx_n_batch = std::min(ctx_n_batch, ctx_n_ubatch);
+    }
+
+    truncate_prompt_to_budget(prompt_tokens, n_prompt, prompt_token_budget(ctx_n_ctx, max_tokens), logger);
 
-    const int prompt_budget = prompt_token_budget(ctx_n_ctx, max_tokens);
-    if (prompt_budget > 0 && n_prompt > prompt_budget) {
-        const int overflow = n_prompt - prompt_budget;
-        if (overflow > 0 && overflow < n_prompt) {
+    int n_pos = retain_cached_prefix(ctx, kv_tokens, prompt_tokens, logger);
+    if (n_pos > 0 && on_prefix_retained) {
+        on_prefix_retained(static_cast<std::size_t>(n_pos));
+    }
+    while (n_pos < n_prompt) {
+        // GPU backends mostly ignore the abort callback, so cancellation is also checked between chunks.
+        if (cancellation_requested(cancelled)) {
             if (logger) {
-                logger->warn("Prompt tokens ({}) exceed prompt budget ({}) by {}; truncating oldest tokens",
-                             n_prompt, prompt_budget, overflow);
+                logger->debug("Generation cancelled during prompt eval");
             }
-            prompt_tokens.erase(prompt_tokens.begin(),
-                                prompt_tokens.begin() + overflow);
-            n_prompt = prompt_budget;
+            return std::string();
         }
-    }
-
-    int n_pos = 0;
-    while (n_pos < n_prompt) {
         const int chunk = std::min(ctx_n_batch, n_prompt - n_pos);
         llama_batch batch = llama_batch_get_one(prompt_tokens.data() + n_pos, chunk);
         if (llama_decode(ctx, batch)) {
             if (logger) {
                 logger->warn("llama_decode returned non-zero status during prompt eval; aborting generation");
             }
+            discard_unconfirmed_tokens(ctx, kv_tokens);
             return std::string();
         }
+        kv_tokens.insert(kv_tokens.end(), prompt_tokens.begin() + n_pos, prompt_tokens.begin() + n_pos + chunk);
         n_pos += chunk;
     }
 
     std::string output;
     int generated_tokens = 0;
     while (generated_tokens < max_tokens) {
+        if (cancellation_requested(cancelled)) {
+            if (logger) {
+                logger->debug("Generation cancelled after {} token(s)", generated_tokens);
+            }
+            break;
+        }
         llama_token new_token_id = llama_sampler_sample(smpl, ctx, -1);
         if (llama_vocab_is_eog(vocab, new_token_id)) {
             break;
@@ -1482,8 +1908,10 @@ std::string run_generation_loop(llama_context* ctx,
             if (logger) {
                 logger->warn("llama_decode returned non-zero status; aborting generation");
             }
+            discard_unconfirmed_tokens(ctx, kv_tokens);
             break;
         }
+        kv_tokens.push_back(new_token_id);
     }
 
     while (!output.empty() && std::isspace(static_cast<unsigned char>(output.front()))) {
@@ -1493,6 +1921,186 @@ std::string run_generation_loop(llama_context* ctx,
     return output;
 }
 
+struct BatchSequence {
+    std::vector<llama_token> prompt_tokens;
+    llama_sampler* sampler{nullptr};
+    llama_pos n_past{0};
+    int32_t logits_index{-1};
+    llama_token pending_token{0};
+    bool has_pending{false};
+    int generated{0};
+    std::string output;
+};
+
+void add_batch_token(llama_batch& batch, llama_token token, llama_pos pos, llama_seq_id seq_id, bool logits)
+{
+    const int32_t index = batch.n_tokens;
+    batch.token[index] = token;
+    batch.pos[index] = pos;
+    batch.n_seq_id[index] = 1;
+    batch.seq_id[index][0] = seq_id;
+    batch.logits[index] = logits ? 1 : 0;
+    batch.n_tokens++;
+}
+
+// Length of the token prefix shared by every sequence, leaving each at least one token of its own.
+std::size_t shared_prompt_prefix_length(const std::vector<BatchSequence>& sequences)
+{
+    if (sequences.size() < 2 || sequences.front().prompt_tokens.empty()) {
+        return 0;
+    }
+    const auto& first = sequences.front().prompt_tokens;
+    std::size_t shared = first.size() - 1;
+    for (std::size_t seq = 1; seq < sequences.size() && shared > 0; ++seq) {
+        const auto& tokens = sequences[seq].prompt_tokens;
+        if (tokens.empty()) {
+            return 0;
+        }
+        shared = std::min(shared, tokens.size() - 1);
+        std::size_t i = 0;
+        while (i < shared && tokens[i] == first[i]) {
+            ++i;
+        }
+        shared = i;
+    }
+    return shared;
+}
+
+bool run_batched_generation_loop(llama_context* ctx,
+                                 const llama_vocab* vocab,
+                                 std::vector<BatchSequence>& sequences,
+                                 int max_tokens,
+                                 const std::shared_ptr<spdlog::logger>& logger,
+                                 const std::atomic<bool>* cancelled)
+{
+    llama_memory_t memory = llama_get_memory(ctx);
+    llama_memory_clear(memory, true);
+
+    // Batches are flushed one ubatch at a time so a cancellation is noticed between ubatches.
+    const int n_ubatch = static_cast<int>(llama_n_ubatch(ctx));
+    const int n_batch = n_ubatch > 0 ? std::min(static_cast<int>(llama_n_batch(ctx)), n_ubatch)
+                                     : static_cast<int>(llama_n_batch(ctx));
+    llama_batch batch = llama_batch_init(n_batch, 0, 1);
+
+    auto sample_ready_sequences = [&]() {
+        for (auto& sequence : sequences) {
+            if (sequence.logits_index < 0) {
+                continue;
+            }
+            const llama_token token = llama_sampler_sample(sequence.sampler, ctx, sequence.logits_index);
+            sequence.logits_index = -1;
+            if (llama_vocab_is_eog(vocab, token)) {
+                continue;
+            }
+            char buf[kTokenPieceBufferBytes];
+            const int n = llama_token_to_piece(vocab, token, buf, sizeof(buf), 0, true);
+            if (n < 0) {
+                continue;
+            }
+            sequence.output.append(buf, n);
+            if (++sequence.generated >= max_tokens) {
+                continue;
+            }
+            sequence.pending_token = token;
+            sequence.has_pending = true;
+        }
+    };
+
+    auto decode_pending_batch = [&]() {
+        if (batch.n_tokens == 0) {
+            return true;
+        }
+        if (cancellation_requested(cancelled)) {
+            if (logger) {
+                logger->debug("Batched categorization cancelled");
+            }
+            batch.n_tokens = 0;
+            return false;
+        }
+        const bool ok = llama_decode(ctx, batch) == 0;
+        if (ok) {
+            sample_ready_sequences();
+        } else if (logger) {
+            logger->warn("llama_decode returned non-zero status during batched categorization");
+        }
+        batch.n_tokens = 0;
+        return ok;
+    };
+
+    bool ok = true;
+
+    // The system prompt and shared context are decoded once on sequence 0 and then
+    // forked into the other sequences, which only decode their per-file suffixes.
+    const std::size_t shared_prefix = shared_prompt_prefix_length(sequences);
+    if (shared_prefix > 0) {
+        const auto& prefix_tokens = sequences.front().prompt_tokens;
+        for (std::size_t i = 0; i < shared_prefix; ++i) {
+            if (batch.n_tokens == n_batch && !decode_pending_batch()) {
+                ok = false;
+                break;
+            }
+            add_batch_token(batch, prefix_tokens[i], static_cast<llama_pos>(i), 0, false);
+        }
+        ok = ok && decode_pending_batch();
+        if (ok) {
+            for (std::size_t seq = 0; seq < sequences.size(); ++seq) {
+                if (seq > 0) {
+                    llama_memory_seq_cp(memory, 0, static_cast<llama_seq_id>(seq),
+                                        0, static_cast<llama_pos>(shared_prefix));
+                }
+                sequences[seq].n_past = static_cast<llama_pos>(shared_prefix);
+            }
+            if (logger) {
+                logger->debug("Shared {} prompt token(s) across {} batched sequence(s)",
+                              shared_prefix, sequences.size());
+            }
+        }
+    }
+
+    for (std::size_t seq = 0; ok && seq < sequences.size(); ++seq) {
+        auto& sequence = sequences[seq];
+        for (std::size_t i = shared_prefix; i < sequence.prompt_tokens.size(); ++i) {
+            if (batch.n_tokens == n_batch && !decode_pending_batch()) {
+                ok = false;
+                break;
+            }
+            const bool last = i + 1 == sequence.prompt_tokens.size();
+            if (last) {
+                sequence.logits_index = batch.n_tokens;
+            }
+            add_batch_token(batch, sequence.prompt_tokens[i], sequence.n_past++,
+                            static_cast<llama_seq_id>(seq), last);
+        }
+    }
+    ok = ok && decode_pending_batch();
+
+    while (ok) {
+        for (std::size_t seq = 0; seq < sequences.size(); ++seq) {
+            auto& sequence = sequences[seq];
+            if (!sequence.has_pending) {
+                continue;
+            }
+            sequence.has_pending = false;
+            sequence.logits_index = batch.n_tokens;
+            add_batch_token(batch, sequence.pending_token, sequence.n_past++,
+                            static_cast<llama_seq_id>(seq), true);
+        }
+        if (batch.n_tokens == 0) {
+            break;
+        }
+        ok = decode_pending_batch();
+    }
+
+    llama_batch_free(batch);
+    for (std::size_t seq = 0; seq < sequences.size(); ++seq) {
+        if (!llama_memory_seq_rm(memory, static_cast<llama_seq_id>(seq), -1, -1)) {
+            llama_memory_clear(memory, true);
+            break;
+        }
+    }
+    return ok;
+}
+
 std::optional<int32_t> parse_block_count_entry(const std::vector<char>& buffer,
                                                std::size_t bytes_read,
                                                std::size_t key_pos,
@@ -2430,8 +3038,10 @@ bool llama_logs_enabled_from_env()
 }
 
 LocalLLMClient::LocalLLMClient(const std::string& model_path,
-                               FallbackDecisionCallback fallback_decision_callback)
+                               FallbackDecisionCallback fallback_decision_callback,
+                               const std::string& state_dir)
     : model_path(model_path),
+      state_dir_(state_dir.empty() ? std::filesystem::path() : Utils::utf8_to_path(state_dir)),
       fallback_decision_callback_(std::move(fallback_decision_callback)),
       original_gpu_backend_env_(read_env_value("AI_FILE_SORTER_GPU_BACKEND")),
       original_llama_arg_device_env_(read_env_value("LLAMA_ARG_DEVICE")),
@@ -2450,14 +3060,30 @@ LocalLLMClient::LocalLLMClient(const std::string& model_path,
     const int context_length = std::clamp(resolve_context_length(),
                                           kMinimumContextAttemptTokens,
                                           kMaximumRuntimeContextTokens);
-    llama_model_params model_params = prepare_model_params(logger);
-
     if (logger) {
         logger->info("Configured context length {} token(s) for local LLM", context_length);
     }
 
-    model_params = load_model_or_throw(model_params, logger);
+    backend_tag_ = resolve_backend_tag();
+    llama_model_params model_params = llama_model_default_params();
+    if (auto resident = LlamaModelRegistry::instance().find(model_path, backend_tag_)) {
+        model_handle_ = resident->model;
+        model = model_handle_.get();
+        vocab = llama_model_get_vocab(model);
+        model_params.n_gpu_layers = resident->n_gpu_layers;
+        if (logger) {
+            logger->info("Reusing resident local model '{}' (n_gpu_layers={})",
+                         model_path,
+                         resident->n_gpu_layers);
+        }
+    } else {
+        model_params = load_model_with_profile(logger);
+    }
     configure_context(context_length, model_params);
+    batch_size_ = resolve_batch_sequences(context_length, kv_cache_context_scale(ctx_params.type_k));
+    if (logger && batch_size_ > 1) {
+        logger->info("Batched local categorization enabled for up to {} sequence(s)", batch_size_);
+    }
     backend_env_guard.restore_now();
 }
 
@@ -2565,6 +3191,9 @@ llama_model_params LocalLLMClient::prepare_model_params(const std::shared_ptr<sp
 {
     const ModelPreparationResult preparation = build_model_preparation_result_for_path(model_path, logger);
     if (preparation.status.has_value()) {
+        if (*preparation.status == Status::GpuLowMemoryFallbackToCpu) {
+            gpu_memory_constrained_ = true;
+        }
         notify_status(*preparation.status);
     }
     return preparation.params;
@@ -2659,6 +3288,32 @@ std::string sanitize_output_for_testing(const std::string& output) {
     return sanitize_categorization_output(output);
 }
 
+std::size_t reusable_prefix_length_for_testing(const std::vector<llama_token>& cached_tokens,
+                                               const std::vector<llama_token>& prompt_tokens) {
+    return reusable_prefix_length(cached_tokens, prompt_tokens);
+}
+
+std::vector<int> thread_calibration_candidates_for_testing(unsigned int hardware_threads)
+{
+    return thread_calibration_candidates(hardware_threads);
+}
+
+std::string fit_user_prompt_sections_for_testing(
+    const std::string& prompt,
+    int overflow_tokens,
+    const std::function<std::vector<std::string>(const std::string&)>& token_pieces)
+{
+    return fit_user_prompt_sections(prompt, overflow_tokens, token_pieces);
+}
+
+std::string prompt_state_snapshot_name_for_testing(const std::string& model_path,
+                                                  const std::string& backend_tag,
+                                                  const std::string& system_prompt,
+                                                  const llama_context_params& params)
+{
+    return prompt_state_snapshot_name(model_path, backend_tag, system_prompt, params);
+}
+
 } // namespace LocalLLMTestAccess
 #endif
 
@@ -2667,7 +3322,8 @@ llama_model_params LocalLLMClient::load_model_or_throw(llama_model_params model_
                                                        const std::shared_ptr<spdlog::logger>& logger)
 {
     auto try_load = [&](const llama_model_params& params) {
-        model = llama_model_load_from_file(model_path.c_str(), params);
+        model_handle_ = LlamaModelRegistry::instance().acquire(model_path, backend_tag_, params);
+        model = model_handle_.get();
         if (!model) {
             return false;
         }
@@ -2729,6 +3385,7 @@ llama_model_params LocalLLMClient::load_model_or_throw(llama_model_params model_
         set_env_var("LLAMA_ARG_DEVICE", "cpu");
         notify_status(Status::GpuFallbackToCpu);
         model_params.n_gpu_layers = 0;
+        backend_tag_ = "cpu";
         if (try_load(model_params)) {
             return model_params;
         }
@@ -2741,18 +3398,108 @@ llama_model_params LocalLLMClient::load_model_or_throw(llama_model_params model_
 }
 
 
+llama_model_params LocalLLMClient::load_model_with_profile(const std::shared_ptr<spdlog::logger>& logger)
+{
+    gpu_profile_key_.reset();
+    std::optional<GpuLayerProfileCache::Key> profile_key;
+    if (!state_dir_.empty() && backend_tag_ != "cpu" && resolve_gpu_layer_override() == INT_MIN) {
+        const std::uint64_t total_gpu_bytes = total_gpu_memory_bytes();
+        if (total_gpu_bytes > 0) {
+            profile_key = GpuLayerProfileCache::Key{model_file_identity(model_path),
+                                                    backend_tag_,
+                                                    GpuLayerProfileCache::memory_bucket_mib(total_gpu_bytes)};
+        }
+    }
+    GpuLayerProfileCache profiles(state_dir_ / kGpuLayerProfileFileName);
+
+    // Backend selection, memory checks and status notifications still run; the cache only
+    // replaces the layer estimate and the load-retry ladder.
+    const llama_model_params prepared_params = prepare_model_params(logger);
+    if (profile_key && prepared_params.n_gpu_layers != 0) {
+        if (const auto cached_layers = profiles.lookup(*profile_key)) {
+            llama_model_params cached_params = prepared_params;
+            cached_params.n_gpu_layers = *cached_layers;
+            model_handle_ = LlamaModelRegistry::instance().acquire(model_path, backend_tag_, cached_params);
+            model = model_handle_.get();
+            if (model) {
+                vocab = llama_model_get_vocab(model);
+                if (logger) {
+                    logger->info("Loaded local model '{}' with cached n_gpu_layers={}",
+                                 model_path,
+                                 *cached_layers);
+                }
+                gpu_profile_key_ = profile_key;
+                gpu_profile_layers_ = *cached_layers;
+                return cached_params;
+            }
+            if (logger) {
+                logger->warn("Cached n_gpu_layers={} no longer loads; probing again.", *cached_layers);
+            }
+            profiles.forget(*profile_key);
+        }
+    }
+
+    const std::string requested_backend = backend_tag_;
+    llama_model_params model_params = load_model_or_throw(prepared_params, logger);
+    if (profile_key && backend_tag_ == requested_backend && model_params.n_gpu_layers > 0) {
+        // Stored once a context has been created with these layers; see settle_gpu_layer_profile().
+        gpu_profile_key_ = profile_key;
+        gpu_profile_layers_ = model_params.n_gpu_layers;
+    }
+    return model_params;
+}
+
+
+void LocalLLMClient::settle_gpu_layer_profile(bool context_created)
+{
+    if (!gpu_profile_key_) {
+        return;
+    }
+    GpuLayerProfileCache profiles(state_dir_ / kGpuLayerProfileFileName);
+    if (context_created) {
+        profiles.store(*gpu_profile_key_, gpu_profile_layers_);
+    } else {
+        profiles.forget(*gpu_profile_key_);
+        if (auto logger = Logger::get_logger("core_logger")) {
+            logger->warn("Forgetting cached n_gpu_layers={} after context initialization failed",
+                         gpu_profile_layers_);
+        }
+    }
+    gpu_profile_key_.reset();
+}
+
+
 void LocalLLMClient::configure_context(int context_length, const llama_model_params& model_params)
 {
     ctx_params = llama_context_default_params();
     ctx_params.n_ctx = context_length;
     ctx_params.n_batch = context_length;
+    ctx_params.abort_callback = &LocalLLMClient::abort_requested;
+    ctx_params.abort_callback_data = this;
 #ifdef GGML_USE_METAL
     if (model_params.n_gpu_layers != 0) {
         ctx_params.offload_kqv = true;
     }
-#else
-    (void)model_params;
 #endif
+    if (model && model_params.n_gpu_layers > 0 && model_params.n_gpu_layers < llama_model_n_layer(model)) {
+        gpu_memory_constrained_ = true;
+    }
+    gpu_fully_offloaded_ = model && llama_supports_gpu_offload() && !is_cpu_backend_requested() &&
+                           model_params.n_gpu_layers >= llama_model_n_layer(model);
+    apply_kv_cache_options();
+}
+
+
+void LocalLLMClient::apply_kv_cache_options()
+{
+    const auto config = LlamaContextOptions::resolve(kv_cache_type_, flash_attention_, gpu_memory_constrained_);
+    LlamaContextOptions::apply(ctx_params, config);
+    if (auto logger = Logger::get_logger("core_logger")) {
+        logger->debug("Local KV cache K={} V={} (GPU memory constrained: {})",
+                      LlamaContextOptions::type_label(config.type_k),
+                      LlamaContextOptions::type_label(config.type_v),
+                      gpu_memory_constrained_);
+    }
 }
 
 
@@ -2768,7 +3515,8 @@ std::string LocalLLMClient::make_prompt(const std::string& file_name,
 std::string LocalLLMClient::generate_response(const std::string& prompt,
                                               int n_predict,
                                               bool apply_sanitizer,
-                                              const std::string& system_prompt)
+                                              const std::string& system_prompt,
+                                              bool constrain_output)
 {
     auto logger = Logger::get_logger("core_logger");
     if (logger) {
@@ -2816,6 +3564,13 @@ std::string LocalLLMClient::generate_response(const std::string& prompt,
         attempt.n_ctx = n_ctx;
         attempt.n_batch = std::min(n_batch, n_ctx);
         auto* ctx = llama_init_from_model(model, attempt);
+        if (!ctx && attempt.type_v != GGML_TYPE_F16) {
+            if (logger) {
+                logger->warn("Quantized V cache unavailable on this backend; retrying with an f16 V cache");
+            }
+            attempt.type_v = GGML_TYPE_F16;
+            ctx = llama_init_from_model(model, attempt);
+        }
         if (ctx) {
             resolved_params = attempt;
         }
@@ -2850,122 +3605,100 @@ std::string LocalLLMClient::generate_response(const std::string& prompt,
         return nullptr;
     };
 
+    std::lock_guard<std::mutex> lock(generation_mutex_);
     bool allow_fallback = true;
     for (;;) {
-        llama_context* ctx = nullptr;
-        llama_sampler* smpl = nullptr;
         try {
-            llama_context_params resolved_params = ctx_params;
-            llama_context_params base_params = ctx_params;
-            ctx = init_context_with_retries(base_params, false, resolved_params);
-
-            if (!ctx && !is_cpu_backend_requested()) {
-                if (!allow_gpu_fallback(fallback_decision_callback_, logger, "context initialization failure")) {
-                    allow_fallback = false;
-                    throw std::runtime_error("GPU backend failed during context initialization and CPU fallback was declined.");
-                }
-                if (logger) {
-                    logger->warn("Context init failed on GPU; reloading model on CPU and retrying.");
-                }
-                llama_model_params cpu_params = llama_model_default_params();
-                cpu_params.n_gpu_layers = 0;
-                ScopedBackendEnvRestore backend_env_guard;
-                set_env_var("AI_FILE_SORTER_GPU_BACKEND", "cpu");
-                set_env_var("LLAMA_ARG_DEVICE", "cpu");
-                set_env_var("GGML_DISABLE_CUDA", "1");
-                notify_status(Status::GpuFallbackToCpu);
-
-                llama_model* old_model = model;
-                llama_model* cpu_model = llama_model_load_from_file(model_path.c_str(), cpu_params);
-                if (!cpu_model) {
-                    if (logger) {
-                        logger->error("Failed to reload model on CPU after context init failure");
+            if (!ctx) {
+                llama_context_params resolved_params = ctx_params;
+                llama_context_params base_params = ctx_params;
+                ctx = init_context_with_retries(base_params, false, resolved_params);
+                settle_gpu_layer_profile(ctx != nullptr);
+
+                if (!ctx && !is_cpu_backend_requested()) {
+                    if (!allow_gpu_fallback(fallback_decision_callback_, logger, "context initialization failure")) {
+                        allow_fallback = false;
+                        throw std::runtime_error("GPU backend failed during context initialization and CPU fallback was declined.");
                     }
-                } else {
-                    if (old_model) {
-                        llama_model_free(old_model);
+                    if (logger) {
+                        logger->warn("Context init failed on GPU; reloading model on CPU and retrying.");
                     }
-                    model = cpu_model;
-                    vocab = llama_model_get_vocab(model);
+                    llama_model_params cpu_params = llama_model_default_params();
+                    cpu_params.n_gpu_layers = 0;
+                    ScopedBackendEnvRestore backend_env_guard;
+                    set_env_var("AI_FILE_SORTER_GPU_BACKEND", "cpu");
+                    set_env_var("LLAMA_ARG_DEVICE", "cpu");
+                    set_env_var("GGML_DISABLE_CUDA", "1");
+                    notify_status(Status::GpuFallbackToCpu);
+
+                    if (!switch_to_cpu_model(cpu_params)) {
+                        if (logger) {
+                            logger->error("Failed to reload model on CPU after context init failure");
+                        }
+                    } else {
 #ifdef GGML_USE_METAL
-                    base_params = ctx_params;
-                    base_params.offload_kqv = false;
+                        base_params = ctx_params;
+                        base_params.offload_kqv = false;
 #else
-                    base_params = ctx_params;
+                        base_params = ctx_params;
 #endif
-                    resolved_params = base_params;
-                    ctx = init_context_with_retries(base_params, true, resolved_params);
-                }
-            }
-
-            if (!ctx) {
-                if (logger) {
-                    logger->error("Failed to initialize llama context");
+                        resolved_params = base_params;
+                        ctx = init_context_with_retries(base_params, true, resolved_params);
+                    }
                 }
-                return "";
-            }
-
-            ctx_params = resolved_params;
 
-            smpl = llama_sampler_chain_init(llama_sampler_chain_default_params());
-            llama_sampler_chain_add(smpl, llama_sampler_init_min_p(kDefaultMinPSampler, 1));
-            llama_sampler_chain_add(smpl, llama_sampler_init_temp(kDefaultTemperatureSampler));
-            llama_sampler_chain_add(smpl, llama_sampler_init_dist(LLAMA_DEFAULT_SEED));
-
-            std::vector<llama_token> prompt_tokens;
-            int n_prompt = 0;
-            std::string working_prompt = prompt;
-            std::string final_prompt;
-            const int context_budget = prompt_token_budget(static_cast<int>(resolved_params.n_ctx), n_predict);
-            for (int shrink_attempt = 0;; ++shrink_attempt) {
-                if (!format_prompt(model, system_prompt, working_prompt, final_prompt)) {
+                if (!ctx) {
                     if (logger) {
-                        logger->error("Failed to apply chat template to prompt");
+                        logger->error("Failed to initialize llama context");
                     }
-                    llama_free(ctx);
-                    llama_sampler_free(smpl);
                     return "";
                 }
 
-                if (!tokenize_prompt(vocab, final_prompt, prompt_tokens, n_prompt, logger)) {
-                    llama_free(ctx);
-                    llama_sampler_free(smpl);
-                    return "";
+                ctx_params = resolved_params;
+                kv_tokens_.clear();
+                if (logger) {
+                    logger->debug("Created persistent llama context (n_ctx={}, n_batch={})",
+                                  ctx_params.n_ctx,
+                                  ctx_params.n_batch);
                 }
+            }
 
-                if (context_budget <= 0 || n_prompt <= context_budget) {
-                    break;
-                }
+            const bool use_grammar = constrain_output && output_grammar_enabled_;
+            llama_sampler*& active_smpl = use_grammar ? grammar_smpl : smpl;
+            if (!active_smpl) {
+                active_smpl = use_grammar ? make_sampler_chain(vocab, kCategorizationGrammar, logger)
+                                          : make_sampler_chain();
+            }
+            llama_sampler_reset(active_smpl);
 
-                const std::string trimmed_prompt = shrink_user_prompt_for_context(working_prompt, shrink_attempt);
-                if (trimmed_prompt == working_prompt) {
-                    if (logger) {
-                        logger->warn("Prompt tokens ({}) still exceed prompt budget ({}); proceeding with token truncation",
-                                     n_prompt,
-                                     context_budget);
-                    }
-                    break;
-                }
+            std::vector<llama_token> prompt_tokens;
+            int n_prompt = 0;
+            const int context_budget = prompt_token_budget(static_cast<int>(ctx_params.n_ctx), n_predict);
+            if (!build_prompt_tokens(model, vocab, system_prompt, prompt, context_budget,
+                                     prompt_tokens, n_prompt, logger)) {
+                return "";
+            }
 
-                if (logger) {
-                    logger->warn("Prompt tokens ({}) exceed prompt budget ({}); shrinking user prompt and retrying",
-                                 n_prompt,
-                                 context_budget);
-                }
-                working_prompt = trimmed_prompt;
+            std::string snapshot_name;
+            if (!state_dir_.empty()) {
+                snapshot_name = prompt_state_snapshot_name(model_path, backend_tag_, system_prompt, ctx_params);
+                restore_prompt_state(snapshot_name, prompt_tokens, logger);
             }
 
             std::string output = run_generation_loop(ctx,
-                                                     smpl,
+                                                     active_smpl,
                                                      prompt_tokens,
                                                      n_prompt,
                                                      n_predict,
                                                      logger,
-                                                     vocab);
-
-            llama_sampler_reset(smpl);
-            llama_free(ctx);
-            llama_sampler_free(smpl);
+                                                     vocab,
+                                                     kv_tokens_,
+                                                     cancellation_flag_.load(),
+                                                     [&](std::size_t n_keep) {
+                                                         if (!snapshot_name.empty()) {
+                                                             save_prompt_state(snapshot_name, n_keep, logger);
+                                                         }
+                                                     });
 
             if (logger) {
                 logger->debug("Generation complete, produced {} character(s)", output.size());
@@ -2976,12 +3709,7 @@ std::string LocalLLMClient::generate_response(const std::string& prompt,
             }
             return output;
         } catch (const std::exception& ex) {
-            if (ctx) {
-                llama_free(ctx);
-            }
-            if (smpl) {
-                llama_sampler_free(smpl);
-            }
+            release_context();
 
             if (allow_fallback && !is_cpu_backend_requested()) {
                 if (!allow_gpu_fallback(fallback_decision_callback_, logger, "generation failure")) {
@@ -3000,18 +3728,11 @@ std::string LocalLLMClient::generate_response(const std::string& prompt,
                 set_env_var("GGML_DISABLE_CUDA", "1");
                 notify_status(Status::GpuFallbackToCpu);
 
-                llama_model* old_model = model;
-                llama_model* cpu_model = llama_model_load_from_file(model_path.c_str(), cpu_params);
-                if (!cpu_model) {
+                if (!switch_to_cpu_model(cpu_params)) {
                     if (logger) {
                         logger->error("Failed to reload model on CPU after GPU error");
                     }
                 } else {
-                    if (old_model) {
-                        llama_model_free(old_model);
-                    }
-                    model = cpu_model;
-                    vocab = llama_model_get_vocab(model);
 #ifdef GGML_USE_METAL
                     ctx_params.offload_kqv = false;
 #endif
@@ -3028,6 +3749,242 @@ std::string LocalLLMClient::generate_response(const std::string& prompt,
 }
 
 
+bool LocalLLMClient::switch_to_cpu_model(const llama_model_params& cpu_params)
+{
+    auto cpu_model = LlamaModelRegistry::instance().acquire(model_path, "cpu", cpu_params);
+    if (!cpu_model) {
+        return false;
+    }
+    release_context();
+    model_handle_ = std::move(cpu_model);
+    model = model_handle_.get();
+    vocab = llama_model_get_vocab(model);
+    backend_tag_ = "cpu";
+    LlamaModelRegistry::instance().release_idle();
+    return true;
+}
+
+
+void LocalLLMClient::restore_prompt_state(const std::string& snapshot_name,
+                                          const std::vector<llama_token>& prompt_tokens,
+                                          const std::shared_ptr<spdlog::logger>& logger)
+{
+    if (reusable_prefix_length(kv_tokens_, prompt_tokens) > 0) {
+        return;
+    }
+    const auto known = prompt_state_tokens_.find(snapshot_name);
+    if (known != prompt_state_tokens_.end() && known->second == 0) {
+        return;
+    }
+
+    const std::filesystem::path snapshot_path = state_dir_ / snapshot_name;
+    std::error_code ec;
+    if (!std::filesystem::exists(snapshot_path, ec)) {
+        prompt_state_tokens_[snapshot_name] = 0;
+        return;
+    }
+
+    llama_memory_clear(llama_get_memory(ctx), true);
+    kv_tokens_.clear();
+
+    std::vector<llama_token> tokens(ctx_params.n_ctx);
+    std::size_t n_loaded = 0;
+    const std::string path_utf8 = Utils::path_to_utf8(snapshot_path);
+    if (llama_state_seq_load_file(ctx, path_utf8.c_str(), 0, tokens.data(), tokens.size(), &n_loaded) == 0
+        || n_loaded == 0) {
+        if (logger) {
+            logger->warn("Discarding unreadable prompt state snapshot '{}'", path_utf8);
+        }
+        llama_memory_clear(llama_get_memory(ctx), true);
+        std::filesystem::remove(snapshot_path, ec);
+        prompt_state_tokens_[snapshot_name] = 0;
+        return;
+    }
+
+    tokens.resize(n_loaded);
+    kv_tokens_ = std::move(tokens);
+    prompt_state_tokens_[snapshot_name] = n_loaded;
+    if (logger) {
+        logger->info("Restored {} prompt token(s) from snapshot '{}'", n_loaded, path_utf8);
+    }
+}
+
+
+void LocalLLMClient::save_prompt_state(const std::string& snapshot_name,
+                                       std::size_t n_keep,
+                                       const std::shared_ptr<spdlog::logger>& logger)
+{
+    if (n_keep < kMinimumSnapshotPrefixTokens || n_keep != kv_tokens_.size()) {
+        return;
+    }
+    const auto known = prompt_state_tokens_.find(snapshot_name);
+    if (known != prompt_state_tokens_.end() && known->second >= n_keep) {
+        return;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(state_dir_, ec);
+    if (ec) {
+        if (logger) {
+            logger->warn("Failed to create prompt state directory '{}': {}",
+                         Utils::path_to_utf8(state_dir_), ec.message());
+        }
+        state_dir_.clear();
+        return;
+    }
+
+    const std::filesystem::path snapshot_path = state_dir_ / snapshot_name;
+    std::filesystem::path temp_path = snapshot_path;
+    temp_path += ".tmp";
+    const std::string temp_utf8 = Utils::path_to_utf8(temp_path);
+    if (llama_state_seq_save_file(ctx, temp_utf8.c_str(), 0, kv_tokens_.data(), kv_tokens_.size()) == 0) {
+        if (logger) {
+            logger->warn("Failed to write prompt state snapshot '{}'", temp_utf8);
+        }
+        std::filesystem::remove(temp_path, ec);
+        return;
+    }
+    std::filesystem::rename(temp_path, snapshot_path, ec);
+    if (ec) {
+        if (logger) {
+            logger->warn("Failed to store prompt state snapshot '{}': {}",
+                         Utils::path_to_utf8(snapshot_path), ec.message());
+        }
+        std::filesystem::remove(temp_path, ec);
+        return;
+    }
+
+    prompt_state_tokens_[snapshot_name] = n_keep;
+    if (logger) {
+        logger->debug("Saved {} prompt token(s) to snapshot '{}'", n_keep, Utils::path_to_utf8(snapshot_path));
+    }
+    prune_prompt_state_snapshots(state_dir_, logger);
+}
+
+
+std::optional<LocalLLMClient::ThreadTuning> LocalLLMClient::calibrate_threads()
+{
+    auto logger = Logger::get_logger("core_logger");
+    std::lock_guard<std::mutex> lock(generation_mutex_);
+    const std::vector<int> candidates = thread_calibration_candidates(std::thread::hardware_concurrency());
+    if (!model || !vocab || candidates.empty()) {
+        return std::nullopt;
+    }
+    if (candidates.size() == 1) {
+        apply_thread_counts(ThreadTuning{candidates.front(), candidates.front()});
+        return ThreadTuning{candidates.front(), candidates.front()};
+    }
+
+    std::string sample;
+    for (std::size_t i = 0; i < kThreadCalibrationPromptTokens / 8; ++i) {
+        sample += kThreadCalibrationSampleText;
+    }
+    const int n_tokens = -llama_tokenize(vocab, sample.c_str(), sample.size(), nullptr, 0, true, false);
+    if (n_tokens <= 0) {
+        return std::nullopt;
+    }
+    std::vector<llama_token> tokens(static_cast<std::size_t>(n_tokens));
+    if (llama_tokenize(vocab, sample.c_str(), sample.size(), tokens.data(), tokens.size(), true, false) < 0) {
+        return std::nullopt;
+    }
+    tokens.resize(std::min(tokens.size(), kThreadCalibrationPromptTokens));
+
+    llama_context_params params = ctx_params;
+    params.n_ctx = kThreadCalibrationContextTokens;
+    params.n_batch = kThreadCalibrationContextTokens;
+    llama_context* bench_ctx = llama_init_from_model(model, params);
+    if (!bench_ctx) {
+        if (logger) {
+            logger->warn("Skipping CPU thread calibration: failed to create a benchmark context");
+        }
+        return std::nullopt;
+    }
+
+    // The first decode pays for buffer allocation; keep it out of the comparison.
+    measure_decode_rates(bench_ctx, tokens, candidates.front());
+
+    ThreadTuning best;
+    DecodeRates best_rates;
+    for (const int threads : candidates) {
+        const auto rates = measure_decode_rates(bench_ctx, tokens, threads);
+        if (!rates) {
+            continue;
+        }
+        if (logger) {
+            logger->info("Thread calibration: {} thread(s) -> prompt {:.1f} tok/s, generation {:.1f} tok/s",
+                         threads,
+                         rates->prompt_tokens_per_second,
+                         rates->generation_tokens_per_second);
+        }
+        if (rates->prompt_tokens_per_second > best_rates.prompt_tokens_per_second) {
+            best_rates.prompt_tokens_per_second = rates->prompt_tokens_per_second;
+            best.n_threads_batch = threads;
+        }
+        if (rates->generation_tokens_per_second > best_rates.generation_tokens_per_second) {
+            best_rates.generation_tokens_per_second = rates->generation_tokens_per_second;
+            best.n_threads = threads;
+        }
+    }
+    llama_free(bench_ctx);
+
+    if (best.n_threads <= 0 || best.n_threads_batch <= 0) {
+        return std::nullopt;
+    }
+    if (logger) {
+        logger->info("Selected {} generation thread(s) and {} prompt thread(s) for local inference",
+                     best.n_threads,
+                     best.n_threads_batch);
+    }
+    apply_thread_counts(best);
+    return best;
+}
+
+
+void LocalLLMClient::set_thread_counts(const ThreadTuning& tuning)
+{
+    std::lock_guard<std::mutex> lock(generation_mutex_);
+    apply_thread_counts(tuning);
+}
+
+
+void LocalLLMClient::apply_thread_counts(const ThreadTuning& tuning)
+{
+    if (tuning.n_threads <= 0 || tuning.n_threads_batch <= 0) {
+        return;
+    }
+    ctx_params.n_threads = tuning.n_threads;
+    ctx_params.n_threads_batch = tuning.n_threads_batch;
+    if (ctx) {
+        llama_set_n_threads(ctx, tuning.n_threads, tuning.n_threads_batch);
+    }
+    if (batch_ctx_) {
+        llama_set_n_threads(batch_ctx_, tuning.n_threads, tuning.n_threads_batch);
+    }
+}
+
+
+void LocalLLMClient::release_context()
+{
+    if (batch_ctx_) {
+        llama_free(batch_ctx_);
+        batch_ctx_ = nullptr;
+    }
+    if (smpl) {
+        llama_sampler_free(smpl);
+        smpl = nullptr;
+    }
+    if (grammar_smpl) {
+        llama_sampler_free(grammar_smpl);
+        grammar_smpl = nullptr;
+    }
+    if (ctx) {
+        llama_free(ctx);
+        ctx = nullptr;
+    }
+    kv_tokens_.clear();
+}
+
+
 std::string LocalLLMClient::categorize_file(const std::string& file_name,
                                             const std::string& file_path,
                                             FileType file_type,
@@ -3048,7 +4005,7 @@ std::string LocalLLMClient::categorize_file(const std::string& file_name,
                   << "[system]\n" << system_prompt << "\n"
                   << "[user]\n" << prompt << "\n";
     }
-    std::string response = generate_response(prompt, 64, true, system_prompt);
+    std::string response = generate_response(prompt, kCategorizationResponseTokens, true, system_prompt, true);
     if (prompt_logging_enabled) {
         std::cout << "[DEV][RESPONSE] Categorization reply\n" << response << "\n";
     }
@@ -3056,6 +4013,137 @@ std::string LocalLLMClient::categorize_file(const std::string& file_name,
 }
 
 
+std::vector<std::string> LocalLLMClient::categorize_files(const std::vector<CategorizationRequest>& requests)
+{
+    if (requests.size() <= 1 || batch_size_ <= 1) {
+        return ILLMClient::categorize_files(requests);
+    }
+
+    std::vector<std::string> responses;
+    bool batched = false;
+    {
+        std::lock_guard<std::mutex> lock(generation_mutex_);
+        batched = run_batched_categorization(requests, responses);
+    }
+    if (!batched) {
+        return ILLMClient::categorize_files(requests);
+    }
+    return responses;
+}
+
+
+std::size_t LocalLLMClient::max_batch_size() const
+{
+    return batch_size_;
+}
+
+
+bool LocalLLMClient::ensure_batch_context(const std::shared_ptr<spdlog::logger>& logger)
+{
+    if (batch_ctx_) {
+        return true;
+    }
+    if (!model || batch_size_ <= 1) {
+        return false;
+    }
+
+    llama_context_params params = ctx_params;
+    params.n_seq_max = static_cast<uint32_t>(batch_size_);
+    // A unified KV buffer lets the sequences reference the shared prompt prefix instead of copying it.
+    params.kv_unified = true;
+    params.n_ctx = ctx_params.n_ctx * static_cast<uint32_t>(batch_size_);
+    batch_ctx_ = llama_init_from_model(model, params);
+    if (!batch_ctx_ && params.type_v != GGML_TYPE_F16) {
+        params.type_v = GGML_TYPE_F16;
+        batch_ctx_ = llama_init_from_model(model, params);
+    }
+    if (!batch_ctx_) {
+        if (logger) {
+            logger->warn("Failed to initialize batched llama context for {} sequence(s); categorizing sequentially",
+                         batch_size_);
+        }
+        batch_size_ = 1;
+        return false;
+    }
+    if (logger) {
+        logger->debug("Created batched llama context (n_ctx={}, n_seq_max={})", params.n_ctx, params.n_seq_max);
+    }
+    return true;
+}
+
+
+bool LocalLLMClient::run_batched_categorization(const std::vector<CategorizationRequest>& requests,
+                                                std::vector<std::string>& responses)
+{
+    auto logger = Logger::get_logger("core_logger");
+    if (!ensure_batch_context(logger)) {
+        return false;
+    }
+
+    const int context_budget =
+        prompt_token_budget(static_cast<int>(ctx_params.n_ctx), kCategorizationResponseTokens);
+    responses.clear();
+    responses.reserve(requests.size());
+
+    for (std::size_t start = 0; start < requests.size(); start += batch_size_) {
+        const std::size_t end = std::min(requests.size(), start + batch_size_);
+        std::vector<BatchSequence> sequences(end - start);
+        bool prepared = true;
+        for (std::size_t i = start; i < end && prepared; ++i) {
+            const auto& request = requests[i];
+            const std::string prompt = make_prompt(request.file_name,
+                                                   request.file_path,
+                                                   request.file_type,
+                                                   request.consistency_context);
+            const std::string system_prompt = categorization_system_prompt(request.file_path, request.file_type);
+            if (prompt_logging_enabled) {
+                std::cout << "\n[DEV][PROMPT] Categorization request (batched)\n"
+                          << "[system]\n" << system_prompt << "\n"
+                          << "[user]\n" << prompt << "\n";
+            }
+            auto& sequence = sequences[i - start];
+            int n_prompt = 0;
+            prepared = build_prompt_tokens(model, vocab, system_prompt, prompt, context_budget,
+                                           sequence.prompt_tokens, n_prompt, logger);
+            if (prepared) {
+                truncate_prompt_to_budget(sequence.prompt_tokens, n_prompt, context_budget, logger);
+                sequence.sampler = output_grammar_enabled_
+                    ? make_sampler_chain(vocab, kCategorizationGrammar, logger)
+                    : make_sampler_chain();
+            }
+        }
+
+        const bool decoded = prepared &&
+            run_batched_generation_loop(batch_ctx_, vocab, sequences, kCategorizationResponseTokens, logger,
+                                        cancellation_flag_.load());
+        for (auto& sequence : sequences) {
+            if (sequence.sampler) {
+                llama_sampler_free(sequence.sampler);
+            }
+        }
+        if (!decoded) {
+            return false;
+        }
+
+        for (auto& sequence : sequences) {
+            std::string output = std::move(sequence.output);
+            while (!output.empty() && std::isspace(static_cast<unsigned char>(output.front()))) {
+                output.erase(output.begin());
+            }
+            std::string response = sanitize_output(output);
+            if (prompt_logging_enabled) {
+                std::cout << "[DEV][RESPONSE] Categorization reply (batched)\n" << response << "\n";
+            }
+            responses.push_back(std::move(response));
+        }
+        if (logger) {
+            logger->debug("Batched categorization decoded {} sequence(s)", sequences.size());
+        }
+    }
+    return true;
+}
+
+
 std::string LocalLLMClient::complete_prompt(const std::string& prompt,
                                             int max_tokens)
 {
@@ -3082,7 +4170,10 @@ LocalLLMClient::~LocalLLMClient() {
     if (auto logger = Logger::get_logger("core_logger")) {
         logger->debug("Destroying LocalLLMClient for model '{}'", model_path);
     }
-    if (model) llama_model_free(model);
+    release_context();
+    model = nullptr;
+    vocab = nullptr;
+    model_handle_.reset();
     restore_env_var("AI_FILE_SORTER_GPU_BACKEND", original_gpu_backend_env_);
     restore_env_var("LLAMA_ARG_DEVICE", original_llama_arg_device_env_);
     restore_env_var("GGML_DISABLE_CUDA", original_ggml_disable_cuda_env_);
@@ -3093,6 +4184,34 @@ void LocalLLMClient::set_prompt_logging_enabled(bool enabled)
     prompt_logging_enabled = enabled;
 }
 
+void LocalLLMClient::set_cancellation_flag(const std::atomic<bool>* flag)
+{
+    cancellation_flag_.store(flag);
+}
+
+bool LocalLLMClient::abort_requested(void* data)
+{
+    const auto* client = static_cast<const LocalLLMClient*>(data);
+    const std::atomic<bool>* flag = client ? client->cancellation_flag_.load() : nullptr;
+    return flag && flag->load();
+}
+
+void LocalLLMClient::set_kv_cache_options(KvCacheType cache_type, FlashAttentionMode flash_attention)
+{
+    std::lock_guard<std::mutex> lock(generation_mutex_);
+    kv_cache_type_ = cache_type;
+    flash_attention_ = flash_attention;
+    release_context();
+    apply_kv_cache_options();
+    batch_size_ = resolve_batch_sequences(static_cast<int>(ctx_params.n_ctx),
+                                          kv_cache_context_scale(ctx_params.type_k));
+}
+
+void LocalLLMClient::set_output_grammar_enabled(bool enabled)
+{
+    output_grammar_enabled_ = enabled;
+}
+
 void LocalLLMClient::set_status_callback(StatusCallback callback)
 {
     status_callback_ = std::move(callback);
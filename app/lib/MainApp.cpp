@@ -12,6 +12,7 @@
 #include "GeminiClient.hpp"
 #include "LocalFsProvider.hpp"
 #include "LLMSelectionDialog.hpp"
+#include "LlamaModelRegistry.hpp"
 #include "Logger.hpp"
 #include "MainAppEditActions.hpp"
 #include "MainAppHelpActions.hpp"
@@ -520,6 +521,18 @@ std::string resolve_runtime_data_dir(Settings& settings, std::string app_data_di
     return resolved;
 }
 
+std::size_t resolve_remote_batch_size(const Settings& settings)
+{
+    if (const char* value = std::getenv("AI_FILE_SORTER_REMOTE_BATCH_SIZE"); value && *value) {
+        char* end = nullptr;
+        const long parsed = std::strtol(value, &end, 10);
+        if (end != value && parsed > 0) {
+            return static_cast<std::size_t>(parsed);
+        }
+    }
+    return static_cast<std::size_t>(settings.get_remote_batch_size());
+}
+
 } // namespace
 
 MainApp::MainApp(Settings& settings,
@@ -593,6 +606,7 @@ void MainApp::shutdown()
 {
     stop_running_analysis();
     save_settings();
+    LlamaModelRegistry::instance().release_all();
 }
 
 
@@ -2129,6 +2143,7 @@ void MainApp::run_consistency_pass()
         stop_analysis,
         settings.get_category_language(),
         progress_sink);
+    LlamaModelRegistry::instance().release_idle();
 }
 
 void MainApp::handle_development_prompt_logging(bool checked)
@@ -2419,6 +2434,8 @@ void MainApp::show_llm_selection_dialog()
                 settings.set_active_custom_api_id("");
             }
             using_local_llm = !is_remote_choice(settings.get_llm_choice());
+            // The model kept for the previous selection is not reused by the new one.
+            LlamaModelRegistry::instance().release_idle();
             refresh_category_language_menu();
             settings.save();
             refresh_backend_status_label();
@@ -2535,6 +2552,8 @@ void MainApp::apply_development_logging()
 std::unique_ptr<ILLMClient> MainApp::make_llm_client()
 {
     const LLMChoice choice = settings.get_llm_choice();
+    const std::string llm_state_dir =
+        Utils::path_to_utf8(Utils::utf8_to_path(settings.get_config_dir()) / "llm_state");
     const auto handle_local_llm_status = [this](LocalLLMClient::Status status) {
         schedule_backend_status_label_refresh();
         switch (status) {
@@ -2558,6 +2577,7 @@ std::unique_ptr<ILLMClient> MainApp::make_llm_client()
         CategorizationSession session(api_key, model);
         auto client = std::make_unique<LLMClient>(session.create_llm_client());
         client->set_prompt_logging_enabled(should_log_prompts());
+        client->set_batch_size(resolve_remote_batch_size(settings));
         schedule_backend_status_label_refresh();
         return client;
     }
@@ -2570,6 +2590,7 @@ std::unique_ptr<ILLMClient> MainApp::make_llm_client()
         }
         auto client = std::make_unique<GeminiClient>(api_key, model);
         client->set_prompt_logging_enabled(should_log_prompts());
+        client->set_batch_size(resolve_remote_batch_size(settings));
         schedule_backend_status_label_refresh();
         return client;
     }
@@ -2582,6 +2603,7 @@ std::unique_ptr<ILLMClient> MainApp::make_llm_client()
         }
         auto client = std::make_unique<LLMClient>(endpoint.api_key, endpoint.model, endpoint.base_url);
         client->set_prompt_logging_enabled(should_log_prompts());
+        client->set_batch_size(resolve_remote_batch_size(settings));
         schedule_backend_status_label_refresh();
         return client;
     }
@@ -2594,11 +2616,15 @@ std::unique_ptr<ILLMClient> MainApp::make_llm_client()
         }
         auto client = std::make_unique<LocalLLMClient>(
             custom.path,
-            [this](const std::string& reason) { return prompt_text_cpu_fallback(reason); });
+            [this](const std::string& reason) { return prompt_text_cpu_fallback(reason); },
+            llm_state_dir);
         client->set_status_callback([handle_local_llm_status](LocalLLMClient::Status status) {
             handle_local_llm_status(status);
         });
         client->set_prompt_logging_enabled(should_log_prompts());
+        client->set_output_grammar_enabled(settings.get_constrain_local_categorization_output());
+        client->set_kv_cache_options(settings.get_local_kv_cache_type(), settings.get_local_flash_attention());
+        apply_local_thread_tuning(*client, custom.path);
         schedule_backend_status_label_refresh();
         return client;
     }
@@ -2611,11 +2637,15 @@ std::unique_ptr<ILLMClient> MainApp::make_llm_client()
 
     auto client = std::make_unique<LocalLLMClient>(
         Utils::path_to_utf8(model_path),
-        [this](const std::string& reason) { return prompt_text_cpu_fallback(reason); });
+        [this](const std::string& reason) { return prompt_text_cpu_fallback(reason); },
+        llm_state_dir);
     client->set_status_callback([handle_local_llm_status](LocalLLMClient::Status status) {
         handle_local_llm_status(status);
     });
     client->set_prompt_logging_enabled(should_log_prompts());
+    client->set_output_grammar_enabled(settings.get_constrain_local_categorization_output());
+    client->set_kv_cache_options(settings.get_local_kv_cache_type(), settings.get_local_flash_attention());
+    apply_local_thread_tuning(*client, Utils::path_to_utf8(model_path));
     schedule_backend_status_label_refresh();
     return client;
 }
@@ -2710,6 +2740,26 @@ std::string MainApp::get_folder_path() const
 }
 
 
+void MainApp::apply_local_thread_tuning(LocalLLMClient& client, const std::string& model_path)
+{
+    const std::string profile = model_path + "|" + std::to_string(std::thread::hardware_concurrency());
+    if (settings.get_local_llm_thread_profile() == profile && settings.get_local_llm_threads() > 0) {
+        client.set_thread_counts(LocalLLMClient::ThreadTuning{settings.get_local_llm_threads(),
+                                                             settings.get_local_llm_batch_threads()});
+        return;
+    }
+    if (client.gpu_fully_offloaded()) {
+        return;
+    }
+    if (const auto tuning = client.calibrate_threads()) {
+        // make_llm_client runs on analysis workers; settings are only written from the UI thread.
+        run_on_ui([this, tuning = *tuning, profile]() {
+            settings.set_local_llm_thread_tuning(tuning.n_threads, tuning.n_threads_batch, profile);
+            settings.save();
+        });
+    }
+}
+
 void MainApp::run_on_ui(std::function<void()> func)
 {
     QMetaObject::invokeMethod(
@@ -0,0 +1,104 @@
+#include "PerceptualHash.hpp"
+
+#include "Utils.hpp"
+
+#include <QImage>
+#include <QImageReader>
+#include <QSize>
+#include <QString>
+
+#include <algorithm>
+#include <bit>
+
+namespace PerceptualHash {
+
+namespace {
+
+constexpr int kHashColumns = 9;
+constexpr int kHashRows = 8;
+constexpr int kDecodeSide = 64;
+// Nearly uniform images (blank pages, solid fills) all hash alike, so they are not grouped.
+constexpr int kMinimumLuminanceRange = 16;
+
+} // namespace
+
+std::optional<std::uint64_t> compute(const QImage& image)
+{
+    if (image.isNull()) {
+        return std::nullopt;
+    }
+
+    const QImage small = image.convertToFormat(QImage::Format_Grayscale8)
+                             .scaled(kHashColumns, kHashRows, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    if (small.width() != kHashColumns || small.height() != kHashRows) {
+        return std::nullopt;
+    }
+
+    int min_value = 255;
+    int max_value = 0;
+    std::uint64_t hash = 0;
+    for (int y = 0; y < kHashRows; ++y) {
+        const uchar* row = small.constScanLine(y);
+        for (int x = 0; x < kHashColumns; ++x) {
+            min_value = std::min<int>(min_value, row[x]);
+            max_value = std::max<int>(max_value, row[x]);
+        }
+        for (int x = 0; x + 1 < kHashColumns; ++x) {
+            hash <<= 1;
+            if (row[x] < row[x + 1]) {
+                hash |= 1;
+            }
+        }
+    }
+    if (max_value - min_value < kMinimumLuminanceRange) {
+        return std::nullopt;
+    }
+    return hash;
+}
+
+std::optional<std::uint64_t> compute(const std::filesystem::path& path)
+{
+    QImageReader reader(QString::fromStdString(Utils::path_to_utf8(path)));
+    const QSize source_size = reader.size();
+    if (source_size.isValid() &&
+        (source_size.width() > kDecodeSide || source_size.height() > kDecodeSide)) {
+        // The hash only needs a thumbnail; JPEG decodes this at a reduced DCT scale.
+        reader.setScaledSize(source_size.scaled(kDecodeSide, kDecodeSide, Qt::KeepAspectRatioByExpanding));
+    }
+    return compute(reader.read());
+}
+
+int distance(std::uint64_t lhs, std::uint64_t rhs)
+{
+    return std::popcount(lhs ^ rhs);
+}
+
+NearDuplicateIndex::NearDuplicateIndex(int max_distance)
+    : max_distance_(std::clamp(max_distance, 0, 64))
+{
+}
+
+void NearDuplicateIndex::add(std::string key, std::uint64_t hash)
+{
+    entries_.emplace_back(hash, std::move(key));
+}
+
+std::optional<NearDuplicateIndex::Match> NearDuplicateIndex::find(std::uint64_t hash) const
+{
+    std::optional<Match> best;
+    for (const auto& [indexed_hash, key] : entries_) {
+        const int current = distance(hash, indexed_hash);
+        if (current > max_distance_) {
+            continue;
+        }
+        if (!best || current < best->distance) {
+            best = Match{key, current};
+            if (current == 0) {
+                break;
+            }
+        }
+    }
+    return best;
+}
+
+} // namespace PerceptualHash
@@ -0,0 +1,219 @@
+#include "RemoteBatchPrompt.hpp"
+
+#include "CategorizationPrompt.hpp"
+#include "FileCategoryPolicy.hpp"
+#include "LLMErrors.hpp"
+#include "Logger.hpp"
+
+#if __has_include(<jsoncpp/json/json.h>)
+#include <jsoncpp/json/json.h>
+#elif __has_include(<json/json.h>)
+#include <json/json.h>
+#else
+#error "jsoncpp headers not found. Install jsoncpp development files."
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <exception>
+#include <memory>
+#include <sstream>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+
+// Headers of the context blocks that are built for one file. CategorizationService appends them
+// after the shared guidance and whitelist, so everything from the first one on belongs to the file.
+constexpr std::array<std::string_view, 3> kItemContextMarkers = {{
+    "Selected whitelist is large, so only the most relevant allowed candidates are shown.",
+    "User-learned category candidates from approved behavior:",
+    "Recent assignments for similar items:"
+}};
+
+std::string trim_copy(const std::string& value)
+{
+    const auto begin = std::find_if_not(value.begin(), value.end(), [](unsigned char ch) {
+        return std::isspace(ch);
+    });
+    const auto end = std::find_if_not(value.rbegin(), value.rend(), [](unsigned char ch) {
+        return std::isspace(ch);
+    }).base();
+    return begin < end ? std::string(begin, end) : std::string();
+}
+
+std::string json_string_member(const Json::Value& object, const char* key)
+{
+    const Json::Value& value = object[key];
+    return value.isString() ? trim_copy(value.asString()) : std::string();
+}
+
+// Turns one element of the reply array into a "<Main category> : <Subcategory>" line.
+std::string format_item(const Json::Value& item)
+{
+    if (item.isString()) {
+        const std::string line = trim_copy(item.asString());
+        return line.find(':') != std::string::npos ? line : std::string();
+    }
+    if (!item.isObject()) {
+        return std::string();
+    }
+    const std::string category = json_string_member(item, "category");
+    const std::string subcategory = json_string_member(item, "subcategory");
+    if (category.empty() || subcategory.empty()) {
+        return std::string();
+    }
+    return category + " : " + subcategory;
+}
+
+void append_indented(std::ostringstream& prompt, const std::string& block)
+{
+    std::istringstream lines(block);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (!line.empty()) {
+            prompt << "\n   " << line;
+        }
+    }
+}
+
+} // namespace
+
+namespace RemoteBatchPrompt {
+
+ContextParts split_context(const std::string& consistency_context)
+{
+    std::size_t split = consistency_context.size();
+    for (const auto marker : kItemContextMarkers) {
+        const auto pos = consistency_context.find(marker);
+        if (pos != std::string::npos) {
+            split = std::min(split, pos);
+        }
+    }
+    return ContextParts{trim_copy(consistency_context.substr(0, split)),
+                        trim_copy(consistency_context.substr(split))};
+}
+
+std::vector<std::vector<std::size_t>> group_requests(
+    const std::vector<ILLMClient::CategorizationRequest>& requests,
+    std::size_t max_items)
+{
+    const std::size_t limit = std::max<std::size_t>(1, max_items);
+    std::vector<std::vector<std::size_t>> groups;
+    std::unordered_map<std::string, std::size_t> open_groups;
+    for (std::size_t index = 0; index < requests.size(); ++index) {
+        const auto& request = requests[index];
+        const std::string key =
+            FileCategoryPolicy::determine_main_category_selection(request.file_name, request.file_type).family_name +
+            '\x1f' + split_context(request.consistency_context).shared;
+        auto it = open_groups.find(key);
+        if (it == open_groups.end() || groups[it->second].size() >= limit) {
+            groups.emplace_back();
+            open_groups[key] = groups.size() - 1;
+            groups.back().push_back(index);
+            continue;
+        }
+        groups[it->second].push_back(index);
+    }
+    return groups;
+}
+
+std::string build_user_prompt(const std::vector<ILLMClient::CategorizationRequest>& requests,
+                              const std::vector<std::size_t>& indices)
+{
+    std::ostringstream prompt;
+    prompt << "Categorize each of the following " << indices.size() << " items.\n";
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+        const auto& request = requests[indices[i]];
+        const bool directory = request.file_type == FileType::Directory;
+        prompt << "\n" << (i + 1) << ". " << (directory ? "Directory name: " : "File name: ") << request.file_name;
+        if (!request.file_path.empty()) {
+            prompt << "\n   Full path: " << request.file_path;
+        }
+        append_indented(prompt, split_context(request.consistency_context).item);
+    }
+    if (!indices.empty()) {
+        const std::string shared = split_context(requests[indices.front()].consistency_context).shared;
+        if (!shared.empty()) {
+            prompt << "\n\n" << shared;
+        }
+    }
+    return prompt.str();
+}
+
+std::vector<std::string> parse_response(const std::string& reply, std::size_t count)
+{
+    std::vector<std::string> results(count);
+    const auto begin = reply.find('[');
+    const auto end = reply.rfind(']');
+    if (begin == std::string::npos || end == std::string::npos || end <= begin) {
+        return results;
+    }
+
+    const std::string array_text = reply.substr(begin, end - begin + 1);
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    Json::Value root;
+    std::string errors;
+    if (!reader->parse(array_text.data(), array_text.data() + array_text.size(), &root, &errors) ||
+        !root.isArray()) {
+        return results;
+    }
+
+    for (Json::ArrayIndex position = 0; position < root.size(); ++position) {
+        const Json::Value& item = root[position];
+        std::size_t slot = position;
+        if (item.isObject() && item["id"].isIntegral()) {
+            const auto id = item["id"].asInt64();
+            if (id < 1) {
+                continue;
+            }
+            slot = static_cast<std::size_t>(id - 1);
+        }
+        if (slot >= count || !results[slot].empty()) {
+            continue;
+        }
+        results[slot] = format_item(item);
+    }
+    return results;
+}
+
+std::vector<std::string> categorize(const std::vector<ILLMClient::CategorizationRequest>& requests,
+                                    std::size_t max_items,
+                                    const BatchSender& send_batch,
+                                    const SingleSender& send_single)
+{
+    std::vector<std::string> responses(requests.size());
+    for (const auto& group : group_requests(requests, max_items)) {
+        try {
+            if (group.size() == 1) {
+                responses[group.front()] = send_single(requests[group.front()]);
+                continue;
+            }
+            const std::string reply = send_batch(CategorizationPrompt::batch_system_prompt(),
+                                                 build_user_prompt(requests, group),
+                                                 group.size());
+            const auto parsed = parse_response(reply, group.size());
+            std::size_t missing = 0;
+            for (std::size_t i = 0; i < group.size(); ++i) {
+                responses[group[i]] = parsed[i];
+                missing += parsed[i].empty() ? 1 : 0;
+            }
+            if (missing > 0) {
+                if (auto logger = Logger::get_logger("core_logger")) {
+                    logger->debug("Batched reply left {} of {} item(s) unparsed", missing, group.size());
+                }
+            }
+        } catch (const BackoffError&) {
+            throw;
+        } catch (const std::exception& ex) {
+            if (auto logger = Logger::get_logger("core_logger")) {
+                logger->debug("Batched categorization of {} item(s) failed: {}", group.size(), ex.what());
+            }
+        }
+    }
+    return responses;
+}
+
+} // namespace RemoteBatchPrompt
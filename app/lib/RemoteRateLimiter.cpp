@@ -0,0 +1,83 @@
+#include "RemoteRateLimiter.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+// Sleeps are sliced so cancellation is noticed promptly.
+constexpr auto kWaitSlice = std::chrono::milliseconds(100);
+
+} // namespace
+
+RemoteRateLimiter::RemoteRateLimiter(int requests_per_minute, std::size_t burst)
+    : tokens_per_second_(requests_per_minute > 0 ? requests_per_minute / 60.0 : 0.0),
+      capacity_(static_cast<double>(std::max<std::size_t>(1, burst))),
+      tokens_(capacity_),
+      last_refill_(Clock::now()),
+      paused_until_(last_refill_)
+{
+}
+
+RemoteRateLimiter::Clock::duration RemoteRateLimiter::try_acquire()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto now = Clock::now();
+    if (now < paused_until_) {
+        return paused_until_ - now;
+    }
+    if (tokens_per_second_ <= 0.0) {
+        return Clock::duration::zero();
+    }
+
+    refill(now);
+    if (tokens_ >= 1.0) {
+        tokens_ -= 1.0;
+        return Clock::duration::zero();
+    }
+    const auto wait = std::chrono::duration<double>((1.0 - tokens_) / tokens_per_second_);
+    return std::max<Clock::duration>(std::chrono::duration_cast<Clock::duration>(wait), Clock::duration(1));
+}
+
+bool RemoteRateLimiter::acquire(const std::atomic<bool>& stop_flag)
+{
+    while (!stop_flag.load()) {
+        if (pause_remaining() > Clock::duration::zero()) {
+            return false;
+        }
+        const auto wait = try_acquire();
+        if (wait == Clock::duration::zero()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::min<Clock::duration>(wait, kWaitSlice));
+    }
+    return false;
+}
+
+void RemoteRateLimiter::pause(Clock::duration delay)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto now = Clock::now();
+    paused_until_ = std::max(paused_until_, now + delay);
+    // Start from an empty bucket so requests do not burst the moment the pause ends.
+    refill(now);
+    tokens_ = 0.0;
+    last_refill_ = paused_until_;
+}
+
+RemoteRateLimiter::Clock::duration RemoteRateLimiter::pause_remaining() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto now = Clock::now();
+    return now < paused_until_ ? paused_until_ - now : Clock::duration::zero();
+}
+
+void RemoteRateLimiter::refill(Clock::time_point now)
+{
+    if (now <= last_refill_) {
+        return;
+    }
+    const double elapsed = std::chrono::duration<double>(now - last_refill_).count();
+    tokens_ = std::min(capacity_, tokens_ + elapsed * tokens_per_second_);
+    last_refill_ = now;
+}
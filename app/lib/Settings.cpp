@@ -133,6 +133,36 @@ std::string llm_choice_to_string(LLMChoice choice) {
     }
 }
 
+std::string kv_cache_type_to_string(KvCacheType type) {
+    switch (type) {
+        case KvCacheType::F16: return "f16";
+        case KvCacheType::Q8_0: return "q8_0";
+        case KvCacheType::Q4_0: return "q4_0";
+        default: return "auto";
+    }
+}
+
+KvCacheType parse_kv_cache_type(const std::string& value) {
+    if (value == "f16") return KvCacheType::F16;
+    if (value == "q8_0") return KvCacheType::Q8_0;
+    if (value == "q4_0") return KvCacheType::Q4_0;
+    return KvCacheType::Auto;
+}
+
+std::string flash_attention_to_string(FlashAttentionMode mode) {
+    switch (mode) {
+        case FlashAttentionMode::On: return "on";
+        case FlashAttentionMode::Off: return "off";
+        default: return "auto";
+    }
+}
+
+FlashAttentionMode parse_flash_attention(const std::string& value) {
+    if (value == "on") return FlashAttentionMode::On;
+    if (value == "off") return FlashAttentionMode::Off;
+    return FlashAttentionMode::Auto;
+}
+
 void set_bool_setting(IniConfig& config, const std::string& section, const char* key, bool value) {
     config.setValue(section, key, to_bool_string(value));
 }
@@ -326,11 +356,13 @@ void Settings::load_basic_settings(const std::function<bool(const char*, bool)>&
     add_image_date_to_category = load_bool("AddImageDateToCategory", false);
     rename_images_only = load_bool("RenameImagesOnly", false);
     process_images_only = load_bool("ProcessImagesOnly", false);
+    fast_visual_mode = load_bool("FastVisualMode", false);
     analyze_documents_by_content = load_bool("AnalyzeDocumentsByContent", false);
     offer_rename_documents = load_bool("OfferRenameDocuments", false);
     rename_documents_only = load_bool("RenameDocumentsOnly", false);
     process_documents_only = load_bool("ProcessDocumentsOnly", false);
     add_document_date_to_category = load_bool("AddDocumentDateToCategory", false);
+    document_summary_tokens = load_int("DocumentSummaryTokens", 0, 0);
     const bool image_expand_default = process_images_only ||
                                       offer_rename_images ||
                                       rename_images_only ||
@@ -366,6 +398,19 @@ void Settings::load_basic_settings(const std::function<bool(const char*, bool)>&
     benchmark_last_report = decode_multiline(config.getValue("Settings", "BenchmarkLastReport", ""));
     benchmark_last_run = config.getValue("Settings", "BenchmarkLastRun", "");
     consistency_pass_enabled = load_bool("ConsistencyPass", false);
+    constrain_local_categorization_output = load_bool("ConstrainLocalCategorizationOutput", true);
+    local_llm_threads = load_int("LocalLlmThreads", 0, 0);
+    local_llm_batch_threads = load_int("LocalLlmBatchThreads", 0, 0);
+    local_llm_thread_profile = config.getValue("Settings", "LocalLlmThreadProfile", "");
+    local_kv_cache_type = parse_kv_cache_type(config.getValue("Settings", "LocalKvCacheType", "auto"));
+    local_flash_attention = parse_flash_attention(config.getValue("Settings", "LocalFlashAttention", "auto"));
+    set_remote_concurrency(load_int("RemoteConcurrency", 1, 1));
+    remote_requests_per_minute = load_int("RemoteRequestsPerMinute", 0, 0);
+    set_remote_batch_size(load_int("RemoteBatchSize", 1, 1));
+    fast_path_rules_enabled = load_bool("FastPathRules", false);
+    set_learned_classifier_threshold(load_int("LearnedClassifierThreshold", 0, 0));
+    filename_clustering_enabled = load_bool("FilenameClustering", true);
+    set_cluster_verification_samples(load_int("ClusterVerificationSamples", 1, 0));
     development_prompt_logging = load_bool("DevelopmentPromptLogging", false);
     skipped_version = config.getValue("Settings", "SkippedVersion", "0.0.0");
     if (config.hasValue("Settings", "Language")) {
@@ -477,12 +522,14 @@ void Settings::save_core_settings()
     set_bool_setting(config, settings_section, "ImageOptionsExpanded", image_options_expanded);
     set_bool_setting(config, settings_section, "RenameImagesOnly", rename_images_only);
     set_bool_setting(config, settings_section, "ProcessImagesOnly", process_images_only);
+    set_bool_setting(config, settings_section, "FastVisualMode", fast_visual_mode);
     set_bool_setting(config, settings_section, "AnalyzeDocumentsByContent", analyze_documents_by_content);
     set_bool_setting(config, settings_section, "OfferRenameDocuments", offer_rename_documents);
     set_bool_setting(config, settings_section, "DocumentOptionsExpanded", document_options_expanded);
     set_bool_setting(config, settings_section, "RenameDocumentsOnly", rename_documents_only);
     set_bool_setting(config, settings_section, "ProcessDocumentsOnly", process_documents_only);
     set_bool_setting(config, settings_section, "AddDocumentDateToCategory", add_document_date_to_category);
+    config.setValue(settings_section, "DocumentSummaryTokens", std::to_string(document_summary_tokens));
     config.setValue(settings_section, "SortFolder", this->sort_folder);
 
     set_optional_setting(config, settings_section, "SkippedVersion", skipped_version);
@@ -493,6 +540,19 @@ void Settings::save_core_settings()
     set_optional_setting(config, settings_section, "BenchmarkLastReport", encode_multiline(benchmark_last_report));
     set_optional_setting(config, settings_section, "BenchmarkLastRun", benchmark_last_run);
     set_bool_setting(config, settings_section, "ConsistencyPass", consistency_pass_enabled);
+    set_bool_setting(config, settings_section, "ConstrainLocalCategorizationOutput", constrain_local_categorization_output);
+    config.setValue(settings_section, "LocalLlmThreads", std::to_string(local_llm_threads));
+    config.setValue(settings_section, "LocalLlmBatchThreads", std::to_string(local_llm_batch_threads));
+    set_optional_setting(config, settings_section, "LocalLlmThreadProfile", local_llm_thread_profile);
+    config.setValue(settings_section, "LocalKvCacheType", kv_cache_type_to_string(local_kv_cache_type));
+    config.setValue(settings_section, "LocalFlashAttention", flash_attention_to_string(local_flash_attention));
+    config.setValue(settings_section, "RemoteConcurrency", std::to_string(remote_concurrency));
+    config.setValue(settings_section, "RemoteRequestsPerMinute", std::to_string(remote_requests_per_minute));
+    config.setValue(settings_section, "RemoteBatchSize", std::to_string(remote_batch_size));
+    set_bool_setting(config, settings_section, "FastPathRules", fast_path_rules_enabled);
+    config.setValue(settings_section, "LearnedClassifierThreshold", std::to_string(learned_classifier_threshold));
+    set_bool_setting(config, settings_section, "FilenameClustering", filename_clustering_enabled);
+    config.setValue(settings_section, "ClusterVerificationSamples", std::to_string(cluster_verification_samples));
     set_bool_setting(config, settings_section, "DevelopmentPromptLogging", development_prompt_logging);
     config.setValue(settings_section, "Language", languageToString(language).toStdString());
     config.setValue(settings_section, "CategoryLanguage", categoryLanguageToString(category_language).toStdString());
@@ -971,6 +1031,16 @@ void Settings::set_process_images_only(bool value)
     process_images_only = value;
 }
 
+bool Settings::get_fast_visual_mode() const
+{
+    return fast_visual_mode;
+}
+
+void Settings::set_fast_visual_mode(bool value)
+{
+    fast_visual_mode = value;
+}
+
 bool Settings::get_analyze_documents_by_content() const
 {
     return analyze_documents_by_content;
@@ -1031,6 +1101,16 @@ void Settings::set_add_document_date_to_category(bool value)
     add_document_date_to_category = value;
 }
 
+int Settings::get_document_summary_tokens() const
+{
+    return document_summary_tokens;
+}
+
+void Settings::set_document_summary_tokens(int value)
+{
+    document_summary_tokens = std::max(0, value);
+}
+
 
 std::string Settings::get_sort_folder() const
 {
@@ -1053,6 +1133,128 @@ void Settings::set_consistency_pass_enabled(bool value)
     consistency_pass_enabled = value;
 }
 
+bool Settings::get_constrain_local_categorization_output() const
+{
+    return constrain_local_categorization_output;
+}
+
+void Settings::set_constrain_local_categorization_output(bool value)
+{
+    constrain_local_categorization_output = value;
+}
+
+int Settings::get_local_llm_threads() const
+{
+    return local_llm_threads;
+}
+
+int Settings::get_local_llm_batch_threads() const
+{
+    return local_llm_batch_threads;
+}
+
+std::string Settings::get_local_llm_thread_profile() const
+{
+    return local_llm_thread_profile;
+}
+
+void Settings::set_local_llm_thread_tuning(int n_threads, int n_threads_batch, const std::string& profile)
+{
+    local_llm_threads = std::max(0, n_threads);
+    local_llm_batch_threads = std::max(0, n_threads_batch);
+    local_llm_thread_profile = profile;
+}
+
+KvCacheType Settings::get_local_kv_cache_type() const
+{
+    return local_kv_cache_type;
+}
+
+void Settings::set_local_kv_cache_type(KvCacheType value)
+{
+    local_kv_cache_type = value;
+}
+
+FlashAttentionMode Settings::get_local_flash_attention() const
+{
+    return local_flash_attention;
+}
+
+void Settings::set_local_flash_attention(FlashAttentionMode value)
+{
+    local_flash_attention = value;
+}
+
+int Settings::get_remote_concurrency() const
+{
+    return remote_concurrency;
+}
+
+void Settings::set_remote_concurrency(int value)
+{
+    remote_concurrency = std::clamp(value, 1, 16);
+}
+
+int Settings::get_remote_requests_per_minute() const
+{
+    return remote_requests_per_minute;
+}
+
+void Settings::set_remote_requests_per_minute(int value)
+{
+    remote_requests_per_minute = std::max(0, value);
+}
+
+int Settings::get_remote_batch_size() const
+{
+    return remote_batch_size;
+}
+
+void Settings::set_remote_batch_size(int value)
+{
+    remote_batch_size = std::clamp(value, 1, 32);
+}
+
+bool Settings::get_fast_path_rules_enabled() const
+{
+    return fast_path_rules_enabled;
+}
+
+void Settings::set_fast_path_rules_enabled(bool value)
+{
+    fast_path_rules_enabled = value;
+}
+
+int Settings::get_learned_classifier_threshold() const
+{
+    return learned_classifier_threshold;
+}
+
+void Settings::set_learned_classifier_threshold(int value)
+{
+    learned_classifier_threshold = std::clamp(value, 0, 100);
+}
+
+bool Settings::get_filename_clustering_enabled() const
+{
+    return filename_clustering_enabled;
+}
+
+void Settings::set_filename_clustering_enabled(bool value)
+{
+    filename_clustering_enabled = value;
+}
+
+int Settings::get_cluster_verification_samples() const
+{
+    return cluster_verification_samples;
+}
+
+void Settings::set_cluster_verification_samples(int value)
+{
+    cluster_verification_samples = std::clamp(value, 0, 8);
+}
+
 bool Settings::get_development_prompt_logging() const
 {
     return development_prompt_logging;
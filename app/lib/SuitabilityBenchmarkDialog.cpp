@@ -3,6 +3,7 @@
 #include "DocumentTextAnalyzer.hpp"
 #include "ImageAnalyzerFactory.hpp"
 #include "ILLMClient.hpp"
+#include "LlamaModelRegistry.hpp"
 #include "LlmCatalog.hpp"
 #include "LocalLLMClient.hpp"
 #include "Settings.hpp"
@@ -1678,6 +1679,8 @@ void SuitabilityBenchmarkDialog::run_benchmark_worker()
                                                                     post_line,
                                                                     post_line_html,
                                                                     should_stop);
+        // The checks loaded models under benchmark backend overrides; do not keep them for the app.
+        LlamaModelRegistry::instance().release_idle();
 
         if (should_stop()) {
             post_line(QObject::tr("Benchmark stopped."));
@@ -112,6 +112,11 @@ std::vector<float> TextEmbeddingService::embed(std::string_view text)
     return vector;
 }
 
+std::vector<std::string> TextEmbeddingService::tokens(std::string_view text)
+{
+    return tokenize(text);
+}
+
 double TextEmbeddingService::cosine_similarity(const std::vector<float>& lhs,
                                                const std::vector<float>& rhs)
 {
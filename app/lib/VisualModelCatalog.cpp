@@ -106,7 +106,7 @@ const std::vector<VisualModelDescriptor>& visual_model_descriptors()
             "gemma-3-4b-it",
             "Gemma 3 4B IT",
             VisualModelArchitecture::MtmdProjector,
-            VisualPromptPolicy::StructuredVisionInstruct,
+            VisualPromptPolicy::StructuredSinglePass,
             {
                 {VisualModelArtifactKind::Model,
                  "Gemma 3 4B IT (text model)",
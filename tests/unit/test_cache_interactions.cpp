@@ -12,15 +12,19 @@
 #include "StoragePluginManager.hpp"
 #include "StorageProviderRegistry.hpp"
 #include "UndoManager.hpp"
+#include "UserLearningStore.hpp"
 #include "TestHelpers.hpp"
 #include "Utils.hpp"
 
 #include <atomic>
+#include <chrono>
 #include <algorithm>
 #include <fstream>
 #include <filesystem>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <unordered_set>
 
 #include <zip.h>
@@ -164,6 +168,72 @@ private:
     std::string response_;
 };
 
+class BatchingLLM : public ILLMClient {
+public:
+    std::string categorize_file(const std::string&,
+                                const std::string&,
+                                FileType,
+                                const std::string&) override {
+        ++single_calls;
+        return "Documents : Reports";
+    }
+
+    std::vector<std::string> categorize_files(const std::vector<CategorizationRequest>& requests) override {
+        batch_sizes.push_back(requests.size());
+        for (const auto& request : requests) {
+            batched_names.push_back(request.file_name);
+        }
+        return std::vector<std::string>(requests.size(), "Documents : Reports");
+    }
+
+    std::size_t max_batch_size() const override {
+        return 3;
+    }
+
+    std::string complete_prompt(const std::string&, int) override {
+        return std::string();
+    }
+
+    void set_prompt_logging_enabled(bool) override {
+    }
+
+    int single_calls{0};
+    std::vector<std::size_t> batch_sizes;
+    std::vector<std::string> batched_names;
+};
+
+class HangingLLM : public ILLMClient {
+public:
+    explicit HangingLLM(std::shared_ptr<std::atomic<int>> cancellations)
+        : cancellations_(std::move(cancellations)) {}
+
+    std::string categorize_file(const std::string&,
+                                const std::string&,
+                                FileType,
+                                const std::string&) override {
+        while (!(cancelled_ && cancelled_->load())) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        ++(*cancellations_);
+        throw std::runtime_error("cancelled");
+    }
+
+    std::string complete_prompt(const std::string&, int) override {
+        return std::string();
+    }
+
+    void set_prompt_logging_enabled(bool) override {
+    }
+
+    void set_cancellation_flag(const std::atomic<bool>* flag) override {
+        cancelled_ = flag;
+    }
+
+private:
+    std::shared_ptr<std::atomic<int>> cancellations_;
+    const std::atomic<bool>* cancelled_{nullptr};
+};
+
 class PromptCapturingLLM : public ILLMClient {
 public:
     std::string categorize_file(const std::string&,
@@ -308,6 +378,285 @@ TEST_CASE("CategorizationService invokes completion callback per entry") {
     CHECK(*calls == static_cast<int>(files.size()));
 }
 
+TEST_CASE("CategorizationService submits uncached entries to batching clients in windows") {
+    TempDir config_dir;
+    EnvVarGuard config_guard("AI_FILE_SORTER_CONFIG_DIR", config_dir.path().string());
+    Settings settings;
+    DatabaseManager db(settings.get_config_dir());
+
+    TempDir data_dir;
+    const std::string dir_path = data_dir.path().string();
+    const auto resolved = db.resolve_category("Images", "Photos");
+    REQUIRE(db.insert_or_update_file_with_categorization(
+        "cached.png", "F", dir_path, resolved, false, std::string(), false));
+
+    CategorizationService service(settings, db, nullptr);
+    std::atomic<bool> stop_flag{false};
+    BatchingLLM* client = nullptr;
+    auto factory = [&client]() {
+        auto llm = std::make_unique<BatchingLLM>();
+        client = llm.get();
+        return llm;
+    };
+
+    std::vector<FileEntry> files;
+    for (const char* name : {"a.txt", "cached.png", "b.txt", "c.txt", "d.txt"}) {
+        files.push_back(FileEntry{(data_dir.path() / name).string(), name, FileType::File});
+    }
+
+    const auto categorized = service.categorize_entries(
+        files,
+        true,
+        stop_flag,
+        {},
+        {},
+        {},
+        {},
+        factory);
+
+    REQUIRE(categorized.size() == files.size());
+    REQUIRE(client != nullptr);
+    REQUIRE(client->batch_sizes.size() == 1);
+    CHECK(client->batch_sizes.front() == 3);
+    CHECK(client->batched_names == std::vector<std::string>{"a.txt", "b.txt", "c.txt"});
+    CHECK(client->single_calls == 1);
+    CHECK(categorized[1].category == "Images");
+    CHECK(categorized[3].category == "Documents");
+    CHECK(categorized[3].subcategory == "Reports");
+}
+
+TEST_CASE("CategorizationService cancels a timed-out request before releasing the client") {
+    TempDir config_dir;
+    EnvVarGuard config_guard("AI_FILE_SORTER_CONFIG_DIR", config_dir.path().string());
+    EnvVarGuard timeout_guard("AI_FILE_SORTER_LOCAL_LLM_TIMEOUT", std::string("1"));
+    Settings settings;
+    DatabaseManager db(settings.get_config_dir());
+    CategorizationService service(settings, db, nullptr);
+
+    TempDir data_dir;
+    const std::vector<FileEntry> files = {
+        FileEntry{(data_dir.path() / "stuck.txt").string(), "stuck.txt", FileType::File}
+    };
+
+    std::atomic<bool> stop_flag{false};
+    auto cancellations = std::make_shared<std::atomic<int>>(0);
+    auto factory = [cancellations]() {
+        return std::make_unique<HangingLLM>(cancellations);
+    };
+
+    try {
+        service.categorize_entries(files, true, stop_flag, {}, {}, {}, {}, factory);
+    } catch (const std::exception&) {
+        // The timeout itself may surface as an error; the hung request must still be stopped.
+    }
+
+    CHECK(cancellations->load() == 1);
+}
+
+TEST_CASE("CategorizationService resolves rule-matched files without calling the LLM") {
+    TempDir config_dir;
+    EnvVarGuard config_guard("AI_FILE_SORTER_CONFIG_DIR", config_dir.path().string());
+    Settings settings;
+    CHECK_FALSE(settings.get_fast_path_rules_enabled());
+    settings.set_fast_path_rules_enabled(true);
+    DatabaseManager db(settings.get_config_dir());
+    CategorizationService service(settings, db, nullptr);
+
+    TempDir data_dir;
+    const std::string dir_path = data_dir.path().string();
+    const auto archive_path = data_dir.path() / "photos-backup.zip";
+    {
+        std::ofstream out(archive_path, std::ios::binary);
+        out << std::string("PK\x03\x04", 4) << std::string(60, '\0');
+    }
+    const std::vector<FileEntry> files = {
+        FileEntry{archive_path.string(), "photos-backup.zip", FileType::File},
+        FileEntry{(data_dir.path() / "notes.txt").string(), "notes.txt", FileType::File}
+    };
+
+    std::atomic<bool> stop_flag{false};
+    auto calls = std::make_shared<int>(0);
+    auto factory = [calls]() {
+        return std::make_unique<CountingLLM>(calls, "Documents : Notes");
+    };
+
+    const auto categorized = service.categorize_entries(files, true, stop_flag, {}, {}, {}, {}, factory);
+
+    REQUIRE(categorized.size() == 2);
+    CHECK(categorized[0].category == "Archives");
+    CHECK(categorized[0].subcategory == "Zip");
+    CHECK(categorized[1].category == "Documents");
+    CHECK(*calls == 1);
+
+    const auto cached = db.get_categorization_from_db(dir_path, "photos-backup.zip", FileType::File);
+    REQUIRE(cached.size() == 2);
+    CHECK(cached[0] == "Archives");
+
+    settings.set_fast_path_rules_enabled(false);
+    db.remove_file_categorization(dir_path, "photos-backup.zip", FileType::File);
+    const auto without_rules = service.categorize_entries(
+        {files.front()}, true, stop_flag, {}, {}, {}, {}, factory);
+    REQUIRE(without_rules.size() == 1);
+    CHECK(without_rules.front().category == "Documents");
+    CHECK(*calls == 2);
+}
+
+TEST_CASE("CategorizationService answers from the learned classifier when it is confident") {
+    TempDir config_dir;
+    EnvVarGuard config_guard("AI_FILE_SORTER_CONFIG_DIR", config_dir.path().string());
+    Settings settings;
+    CHECK(settings.get_learned_classifier_threshold() == 0);
+    settings.set_learned_classifier_threshold(90);
+    DatabaseManager db(settings.get_config_dir());
+    UserLearningStore learning_store(settings.get_config_dir());
+    REQUIRE(learning_store.is_open());
+
+    std::vector<std::pair<std::string, std::pair<std::string, std::string>>> approvals;
+    for (int i = 1; i <= 10; ++i) {
+        const std::string number = std::string(i < 10 ? "0" : "") + std::to_string(i);
+        approvals.push_back({"invoice_2023_" + number + "_acme.pdf", {"Finance", "Invoices"}});
+        approvals.push_back({"lecture_notes_week" + number + ".docx", {"Education", "Lectures"}});
+    }
+    std::string error;
+    for (const auto& [file_name, labels] : approvals) {
+        UserLearningStore::ApprovedMapping mapping;
+        mapping.file_name = file_name;
+        mapping.file_type = FileType::File;
+        mapping.dir_path = "/archive";
+        mapping.category = labels.first;
+        mapping.subcategory = labels.second;
+        REQUIRE(learning_store.record_approved_mapping(mapping, &error));
+    }
+
+    CategorizationService service(settings, db, nullptr, &learning_store);
+
+    TempDir data_dir;
+    const std::string dir_path = data_dir.path().string();
+    const std::vector<FileEntry> files = {
+        FileEntry{(data_dir.path() / "invoice_2024_07_acme.pdf").string(), "invoice_2024_07_acme.pdf", FileType::File},
+        FileEntry{(data_dir.path() / "grocery_list.txt").string(), "grocery_list.txt", FileType::File}
+    };
+
+    std::atomic<bool> stop_flag{false};
+    auto calls = std::make_shared<int>(0);
+    auto factory = [calls]() {
+        return std::make_unique<CountingLLM>(calls, "Documents : Notes");
+    };
+    std::vector<std::string> progress;
+    auto progress_callback = [&progress](const std::string& message) { progress.push_back(message); };
+
+    const auto categorized = service.categorize_entries(files, true, stop_flag, progress_callback, {}, {}, {}, factory);
+
+    // PDFs keep the stable Documents main category, so the learned main category moves to the subcategory slot.
+    REQUIRE(categorized.size() == 2);
+    CHECK(categorized[0].category == "Documents");
+    CHECK(categorized[0].subcategory == "Invoices");
+    CHECK(categorized[1].category == "Documents");
+    CHECK(*calls == 1);
+    CHECK(std::any_of(progress.begin(), progress.end(), [](const std::string& message) {
+        return message.rfind("[LEARNED] invoice_2024_07_acme.pdf", 0) == 0;
+    }));
+
+    settings.set_learned_classifier_threshold(0);
+    db.remove_file_categorization(dir_path, "invoice_2024_07_acme.pdf", FileType::File);
+    const auto without_classifier = service.categorize_entries(
+        {files.front()}, true, stop_flag, {}, {}, {}, {}, factory);
+    REQUIRE(without_classifier.size() == 1);
+    CHECK(without_classifier.front().category == "Documents");
+    CHECK(*calls == 2);
+}
+
+TEST_CASE("CategorizationService categorizes sibling files with numbered names once") {
+    TempDir config_dir;
+    EnvVarGuard config_guard("AI_FILE_SORTER_CONFIG_DIR", config_dir.path().string());
+    Settings settings;
+    DatabaseManager db(settings.get_config_dir());
+    CategorizationService service(settings, db, nullptr);
+
+    TempDir data_dir;
+    const std::string dir_path = data_dir.path().string();
+    std::vector<FileEntry> files;
+    for (const char* name : {"scan_0001.pdf", "scan_0002.pdf", "notes.txt", "scan_0003.pdf", "scan_0004.pdf"}) {
+        files.push_back(FileEntry{(data_dir.path() / name).string(), name, FileType::File});
+    }
+
+    std::atomic<bool> stop_flag{false};
+    auto calls = std::make_shared<int>(0);
+    auto factory = [calls]() {
+        return std::make_unique<CountingLLM>(calls, "Documents : Scans");
+    };
+    std::vector<std::string> progress;
+    auto progress_callback = [&progress](const std::string& message) { progress.push_back(message); };
+
+    const auto categorized = service.categorize_entries(files, true, stop_flag, progress_callback, {}, {}, {}, factory);
+
+    REQUIRE(categorized.size() == 5);
+    for (const auto& entry : categorized) {
+        CHECK(entry.category == "Documents");
+        CHECK(entry.subcategory == "Scans");
+    }
+    CHECK(categorized[4].file_name == "scan_0004.pdf");
+    // The representative, one verification sample and the unrelated file reach the LLM.
+    CHECK(*calls == 3);
+    CHECK(std::any_of(progress.begin(), progress.end(), [](const std::string& message) {
+        return message.rfind("[CLUSTER] scan_0003.pdf", 0) == 0;
+    }));
+
+    const auto cached = db.get_categorization_from_db(dir_path, "scan_0004.pdf", FileType::File);
+    REQUIRE(cached.size() == 2);
+    CHECK(cached[1] == "Scans");
+
+    settings.set_filename_clustering_enabled(false);
+    std::vector<FileEntry> pages;
+    for (const char* name : {"page_01.pdf", "page_02.pdf", "page_03.pdf"}) {
+        pages.push_back(FileEntry{(data_dir.path() / name).string(), name, FileType::File});
+    }
+    const auto without_clustering = service.categorize_entries(pages, true, stop_flag, {}, {}, {}, {}, factory);
+    CHECK(without_clustering.size() == 3);
+    CHECK(*calls == 6);
+}
+
+TEST_CASE("CategorizationService does not cluster siblings whose prompts carry their own content") {
+    TempDir config_dir;
+    EnvVarGuard config_guard("AI_FILE_SORTER_CONFIG_DIR", config_dir.path().string());
+    Settings settings;
+    DatabaseManager db(settings.get_config_dir());
+    CategorizationService service(settings, db, nullptr);
+
+    TempDir data_dir;
+    std::vector<FileEntry> files;
+    for (const char* name : {"IMG_0001.jpg", "IMG_0002.jpg", "IMG_0003.jpg", "IMG_0004.jpg"}) {
+        files.push_back(FileEntry{(data_dir.path() / name).string(), name, FileType::File});
+    }
+    const std::vector<std::string> descriptions = {"beach_sunset.jpg", "cat_on_sofa.jpg", "receipt_scan.jpg"};
+    auto override_provider = [&files, &descriptions](const FileEntry& entry)
+        -> std::optional<CategorizationService::PromptOverride> {
+        for (std::size_t i = 0; i < descriptions.size(); ++i) {
+            if (entry.full_path == files[i + 1].full_path) {
+                return CategorizationService::PromptOverride{descriptions[i], entry.full_path};
+            }
+        }
+        return std::nullopt;
+    };
+
+    std::atomic<bool> stop_flag{false};
+    auto calls = std::make_shared<int>(0);
+    auto factory = [calls]() {
+        return std::make_unique<CountingLLM>(calls, "Images : Photos");
+    };
+    std::vector<std::string> progress;
+    auto progress_callback = [&progress](const std::string& message) { progress.push_back(message); };
+
+    const auto categorized = service.categorize_entries(
+        files, true, stop_flag, progress_callback, {}, {}, {}, factory, override_provider);
+
+    CHECK(categorized.size() == 4);
+    CHECK(*calls == 4);
+    CHECK(std::none_of(progress.begin(), progress.end(), [](const std::string& message) {
+        return message.rfind("[CLUSTER]", 0) == 0;
+    }));
+}
+
 TEST_CASE("CategorizationService loads cached entries recursively for analysis") {
     TempDir config_dir;
     EnvVarGuard config_guard("AI_FILE_SORTER_CONFIG_DIR", config_dir.path().string());
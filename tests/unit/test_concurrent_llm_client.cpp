@@ -0,0 +1,204 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "ConcurrentLLMClient.hpp"
+#include "LLMErrors.hpp"
+#include "RemoteRateLimiter.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct InFlightCounter {
+    std::atomic<int> current{0};
+    std::atomic<int> peak{0};
+};
+
+class SlowRemoteLLM : public ILLMClient {
+public:
+    explicit SlowRemoteLLM(std::shared_ptr<InFlightCounter> counter)
+        : counter_(std::move(counter)) {}
+
+    std::string categorize_file(const std::string& file_name,
+                                const std::string&,
+                                FileType,
+                                const std::string&) override {
+        const int now = ++counter_->current;
+        int peak = counter_->peak.load();
+        while (now > peak && !counter_->peak.compare_exchange_weak(peak, now)) {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(40));
+        --counter_->current;
+        if (file_name == "broken.txt") {
+            throw std::runtime_error("Server Error");
+        }
+        return "Documents : " + file_name;
+    }
+
+    std::string complete_prompt(const std::string&, int) override {
+        return std::string();
+    }
+
+    void set_prompt_logging_enabled(bool) override {
+    }
+
+private:
+    std::shared_ptr<InFlightCounter> counter_;
+};
+
+class RateLimitedLLM : public ILLMClient {
+public:
+    std::string categorize_file(const std::string& file_name,
+                                const std::string&,
+                                FileType,
+                                const std::string&) override {
+        ++calls;
+        if (file_name == "limited.txt") {
+            throw BackoffError("Rate Limit Error", 2);
+        }
+        return "Documents : Reports";
+    }
+
+    std::string complete_prompt(const std::string&, int) override {
+        return std::string();
+    }
+
+    void set_prompt_logging_enabled(bool) override {
+    }
+
+    int calls{0};
+};
+
+class BatchedRemoteLLM : public ILLMClient {
+public:
+    explicit BatchedRemoteLLM(std::shared_ptr<std::atomic<int>> batches)
+        : batches_(std::move(batches)) {}
+
+    std::string categorize_file(const std::string& file_name,
+                                const std::string&,
+                                FileType,
+                                const std::string&) override {
+        return "Documents : " + file_name;
+    }
+
+    std::vector<std::string> categorize_files(const std::vector<CategorizationRequest>& requests) override {
+        ++(*batches_);
+        std::vector<std::string> responses;
+        for (const auto& request : requests) {
+            responses.push_back("Documents : " + request.file_name);
+        }
+        return responses;
+    }
+
+    std::size_t max_batch_size() const override {
+        return 2;
+    }
+
+    std::string complete_prompt(const std::string&, int) override {
+        return std::string();
+    }
+
+    void set_prompt_logging_enabled(bool) override {
+    }
+
+private:
+    std::shared_ptr<std::atomic<int>> batches_;
+};
+
+std::vector<ILLMClient::CategorizationRequest> make_requests(const std::vector<std::string>& names) {
+    std::vector<ILLMClient::CategorizationRequest> requests;
+    for (const auto& name : names) {
+        requests.push_back({name, "/tmp/" + name, FileType::File, std::string()});
+    }
+    return requests;
+}
+
+} // namespace
+
+TEST_CASE("ConcurrentLLMClient overlaps remote requests and keeps request order") {
+    auto counter = std::make_shared<InFlightCounter>();
+    int created = 0;
+    auto factory = [counter, &created]() -> std::unique_ptr<ILLMClient> {
+        ++created;
+        return std::make_unique<SlowRemoteLLM>(counter);
+    };
+    std::atomic<bool> stop_flag{false};
+    ConcurrentLLMClient client(std::make_unique<SlowRemoteLLM>(counter),
+                               factory,
+                               3,
+                               std::make_shared<RemoteRateLimiter>(0, 3),
+                               stop_flag);
+
+    const auto responses = client.categorize_files(
+        make_requests({"a.txt", "b.txt", "broken.txt", "c.txt", "d.txt", "e.txt"}));
+
+    CHECK(client.max_batch_size() == 3);
+    CHECK(created == 2);
+    CHECK(counter->peak.load() >= 2);
+    CHECK(counter->peak.load() <= 3);
+    CHECK(responses == std::vector<std::string>{
+        "Documents : a.txt", "Documents : b.txt", "", "Documents : c.txt", "Documents : d.txt", "Documents : e.txt"});
+}
+
+TEST_CASE("ConcurrentLLMClient pauses remote requests after a rate-limit response") {
+    auto primary = std::make_unique<RateLimitedLLM>();
+    RateLimitedLLM* remote = primary.get();
+    std::atomic<bool> stop_flag{false};
+    auto limiter = std::make_shared<RemoteRateLimiter>(0, 1);
+    ConcurrentLLMClient client(std::move(primary), {}, 1, limiter, stop_flag);
+
+    const auto responses = client.categorize_files(
+        make_requests({"first.txt", "limited.txt", "skipped.txt"}));
+
+    CHECK(responses == std::vector<std::string>{"Documents : Reports", "", ""});
+    CHECK(remote->calls == 2);
+    CHECK(limiter->pause_remaining() > std::chrono::seconds(1));
+
+    try {
+        client.categorize_file("next.txt", "/tmp/next.txt", FileType::File, std::string());
+        FAIL("Expected the paused client to report a backoff");
+    } catch (const BackoffError& backoff) {
+        CHECK(backoff.retry_after_seconds() == 2);
+    }
+    CHECK(remote->calls == 2);
+}
+
+TEST_CASE("ConcurrentLLMClient sends sub-batches to clients that batch prompts") {
+    auto batches = std::make_shared<std::atomic<int>>(0);
+    std::atomic<bool> stop_flag{false};
+    ConcurrentLLMClient client(std::make_unique<BatchedRemoteLLM>(batches),
+                               [batches]() { return std::make_unique<BatchedRemoteLLM>(batches); },
+                               2,
+                               std::make_shared<RemoteRateLimiter>(0, 2),
+                               stop_flag);
+
+    CHECK(client.max_batch_size() == 4);
+    const auto responses = client.categorize_files(make_requests({"a.txt", "b.txt", "c.txt", "d.txt", "e.txt"}));
+
+    CHECK(batches->load() == 2);
+    CHECK(responses == std::vector<std::string>{
+        "Documents : a.txt", "Documents : b.txt", "Documents : c.txt", "Documents : d.txt", "Documents : e.txt"});
+}
+
+TEST_CASE("RemoteRateLimiter refills tokens at the configured rate") {
+    RemoteRateLimiter limiter(600, 2);
+
+    CHECK(limiter.try_acquire() == RemoteRateLimiter::Clock::duration::zero());
+    CHECK(limiter.try_acquire() == RemoteRateLimiter::Clock::duration::zero());
+    const auto wait = limiter.try_acquire();
+    CHECK(wait > RemoteRateLimiter::Clock::duration::zero());
+    CHECK(wait <= std::chrono::milliseconds(100));
+
+    std::atomic<bool> stop_flag{false};
+    const auto start = RemoteRateLimiter::Clock::now();
+    REQUIRE(limiter.acquire(stop_flag));
+    CHECK(RemoteRateLimiter::Clock::now() - start >= std::chrono::milliseconds(50));
+
+    limiter.pause(std::chrono::milliseconds(300));
+    CHECK(limiter.pause_remaining() > RemoteRateLimiter::Clock::duration::zero());
+    CHECK_FALSE(limiter.acquire(stop_flag));
+}
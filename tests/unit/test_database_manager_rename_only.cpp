@@ -376,3 +376,55 @@ TEST_CASE("DatabaseManager migrates legacy audio and installer-builder taxonomy
     sqlite3_finalize(stmt);
     REQUIRE(sqlite3_close(raw_db) == SQLITE_OK);
 }
+
+TEST_CASE("DatabaseManager caches image analysis by content fingerprint and model") {
+    TempDir base_dir;
+    EnvVarGuard config_guard("AI_FILE_SORTER_CONFIG_DIR", base_dir.path().string());
+    const std::string fingerprint = "2048:0123456789abcdef";
+
+    {
+        DatabaseManager db(base_dir.path().string());
+        CHECK_FALSE(db.get_image_analysis(fingerprint, "llava-v1.6").has_value());
+        REQUIRE(db.store_image_analysis(fingerprint,
+                                        "llava-v1.6",
+                                        {"A dog on a beach at sunset.", "dog_beach_sunset"}));
+    }
+
+    DatabaseManager reopened(base_dir.path().string());
+    const auto cached = reopened.get_image_analysis(fingerprint, "llava-v1.6");
+    REQUIRE(cached.has_value());
+    CHECK(cached->description == "A dog on a beach at sunset.");
+    CHECK(cached->suggested_name == "dog_beach_sunset");
+    CHECK_FALSE(reopened.get_image_analysis(fingerprint, "gemma-3").has_value());
+    CHECK_FALSE(reopened.get_image_analysis("2048:fedcba9876543210", "llava-v1.6").has_value());
+
+    REQUIRE(reopened.clear_all_categorizations(true));
+    CHECK_FALSE(reopened.get_image_analysis(fingerprint, "llava-v1.6").has_value());
+}
+
+TEST_CASE("DatabaseManager caches document excerpts and dates by file identity") {
+    TempDir base_dir;
+    EnvVarGuard config_guard("AI_FILE_SORTER_CONFIG_DIR", base_dir.path().string());
+    const std::string identity = "64769:1234:5120:1700000000";
+
+    {
+        DatabaseManager db(base_dir.path().string());
+        CHECK_FALSE(db.get_document_excerpt(identity, "v1:8000").has_value());
+        REQUIRE(db.store_document_excerpt(identity, "v1:8000", {std::string("Quarterly report"), std::nullopt}));
+        REQUIRE(db.store_document_excerpt(identity, "v1:8000", {std::nullopt, std::string()}));
+    }
+
+    DatabaseManager reopened(base_dir.path().string());
+    const auto cached = reopened.get_document_excerpt(identity, "v1:8000");
+    REQUIRE(cached.has_value());
+    REQUIRE(cached->excerpt.has_value());
+    CHECK(*cached->excerpt == "Quarterly report");
+    REQUIRE(cached->creation_date.has_value());
+    CHECK(cached->creation_date->empty());
+    CHECK_FALSE(reopened.get_document_excerpt(identity, "v1:4000").has_value());
+
+    REQUIRE(reopened.clear_all_categorizations(false));
+    CHECK(reopened.get_document_excerpt(identity, "v1:8000").has_value());
+    REQUIRE(reopened.clear_all_categorizations(true));
+    CHECK_FALSE(reopened.get_document_excerpt(identity, "v1:8000").has_value());
+}
@@ -0,0 +1,97 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "DocumentTextAnalyzer.hpp"
+#include "TestHelpers.hpp"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+TEST_CASE("DocumentTextAnalyzer streams XML text across chunk boundaries") {
+    const std::vector<std::string> chunks = {
+        "<?xml version='1.0'?><w:body><w:p w:rsid=\"a>b\"><w:t>Tom &am",
+        "p; Jerry</w:t><w:t>caf&#233; &lt;draft&gt;</w:t></w:p><!-- don't -->",
+        "<w:p><w:t>Summary</w:t></w:p></w:body>"};
+
+    const auto [text, consumed] = DocumentTextAnalyzerTestAccess::collect_xml_text(chunks, 1000);
+
+    CHECK(consumed == chunks.size());
+    CHECK(text == "Tom & Jerry caf\xC3\xA9 <draft> Summary ");
+}
+
+TEST_CASE("DocumentTextAnalyzer skips XML comments and keeps CDATA text literally") {
+    const std::vector<std::string> chunks = {
+        "<a><!-- a > b -",
+        "- c --><t>one</t><![CDA",
+        "TA[x <b>&amp; y]] ]]]></t><t>two</t></a>"};
+
+    const auto [text, consumed] = DocumentTextAnalyzerTestAccess::collect_xml_text(chunks, 1000);
+
+    CHECK(consumed == chunks.size());
+    CHECK(text == "one x <b>&amp; y]] ] two ");
+}
+
+TEST_CASE("DocumentTextAnalyzer stops streaming XML once the excerpt budget is reached") {
+    std::vector<std::string> chunks;
+    for (int i = 0; i < 50; ++i) {
+        chunks.push_back("<si><t>shared string " + std::to_string(i) + "</t></si>");
+    }
+
+    const auto [text, consumed] = DocumentTextAnalyzerTestAccess::collect_xml_text(chunks, 40);
+
+    CHECK(text.size() == 40);
+    CHECK(text.rfind("shared string 0 shared string 1 ", 0) == 0);
+    CHECK(consumed < 5);
+}
+
+TEST_CASE("DocumentTextAnalyzer pre-summary keeps topical sentences in document order") {
+    std::string text = "Invoice 4471 from Northwind Traders covers quarterly espresso machine maintenance. ";
+    for (int i = 0; i < 6; ++i) {
+        text += "Please contact us if you have any questions about this. ";
+    }
+    text += "The espresso machine maintenance included descaling and gasket replacement.\n\n";
+    text += "Northwind Traders thanks you for your business.";
+
+    const std::string summary = DocumentTextAnalyzerTestAccess::select_key_sentences(text, 170);
+
+    CHECK(summary.size() <= 170);
+    CHECK(summary.find("Please contact") == std::string::npos);
+    const auto invoice = summary.find("Invoice 4471");
+    const auto details = summary.find("descaling and gasket");
+    REQUIRE(invoice != std::string::npos);
+    REQUIRE(details != std::string::npos);
+    CHECK(invoice < details);
+    CHECK(DocumentTextAnalyzerTestAccess::select_key_sentences(text, text.size()) == text);
+}
+
+TEST_CASE("DocumentTextAnalyzer reads PDF creation dates without external tools") {
+    TempDir dir;
+    const std::vector<std::string> objects = {
+        "1 0 obj\n<< /Type /Catalog /Pages 2 0 R >>\nendobj\n",
+        "2 0 obj\n<< /Type /Pages /Kids [3 0 R] /Count 1 >>\nendobj\n",
+        "3 0 obj\n<< /Type /Page /Parent 2 0 R /MediaBox [0 0 200 200] >>\nendobj\n",
+        "4 0 obj\n<< /Producer (unit test) /CreationDate (D:20210415093000Z) >>\nendobj\n"};
+    std::string pdf = "%PDF-1.4\n";
+    std::vector<std::size_t> offsets;
+    for (const auto& object : objects) {
+        offsets.push_back(pdf.size());
+        pdf += object;
+    }
+    const std::size_t xref_offset = pdf.size();
+    pdf += "xref\n0 5\n0000000000 65535 f \n";
+    for (const auto offset : offsets) {
+        const std::string number = std::to_string(offset);
+        pdf += std::string(10 - number.size(), '0') + number + " 00000 n \n";
+    }
+    pdf += "trailer\n<< /Size 5 /Root 1 0 R /Info 4 0 R >>\nstartxref\n" + std::to_string(xref_offset) + "\n%%EOF\n";
+
+    const auto path = dir.path() / "scan.pdf";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << pdf;
+    }
+
+    const auto date = DocumentTextAnalyzer::extract_creation_date(path);
+    REQUIRE(date.has_value());
+    CHECK(*date == "2021-04");
+}
@@ -0,0 +1,83 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "FastPathCategorizer.hpp"
+#include "TestHelpers.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace {
+
+void write_file(const std::filesystem::path& path, const std::string& contents)
+{
+    std::ofstream out(path, std::ios::binary);
+    out << contents;
+}
+
+} // namespace
+
+TEST_CASE("FastPathCategorizer confirms built-in rules with file signatures") {
+    TempDir dir;
+    const auto zip_path = dir.path() / "bundle.zip";
+    write_file(zip_path, std::string("PK\x03\x04", 4) + std::string(60, '\0'));
+    const auto fake_zip_path = dir.path() / "notes.zip";
+    write_file(fake_zip_path, "plain text that was renamed");
+    const auto font_path = dir.path() / "Inter-Regular.TTF";
+    write_file(font_path, std::string("\x00\x01\x00\x00", 4) + std::string(60, '\0'));
+    const auto dmg_path = dir.path() / "Installer.dmg";
+    write_file(dmg_path, std::string(1024, '\0') + "koly" + std::string(508, '\0'));
+
+    const FastPathCategorizer categorizer;
+
+    const auto zip = categorizer.match("bundle.zip", zip_path.string(), FileType::File);
+    REQUIRE(zip.has_value());
+    CHECK(zip->category == "Archives");
+    CHECK(zip->subcategory == "Zip");
+
+    const auto font = categorizer.match("Inter-Regular.TTF", font_path.string(), FileType::File);
+    REQUIRE(font.has_value());
+    CHECK(font->category == "Fonts");
+
+    // Installers are left to the model so their subcategory names the software they install.
+    CHECK_FALSE(categorizer.match("Installer.dmg", dmg_path.string(), FileType::File).has_value());
+
+    CHECK_FALSE(categorizer.match("notes.zip", fake_zip_path.string(), FileType::File).has_value());
+    CHECK_FALSE(categorizer.match("missing.zip", (dir.path() / "missing.zip").string(), FileType::File).has_value());
+    CHECK_FALSE(categorizer.match("bundle.zip", zip_path.string(), FileType::Directory).has_value());
+}
+
+TEST_CASE("FastPathCategorizer evaluates rules from a file before the built-in rules") {
+    TempDir dir;
+    const auto rules_path = dir.path() / "fast_path_rules.json";
+    write_file(rules_path, R"({
+        "rules": [
+            {"name": "Scanner exports", "name_pattern": "^scan_\\d+", "extensions": ["zip"],
+             "max_size": 1024, "category": "Scans", "subcategory": "Batches"},
+            {"name": "Broken pattern", "name_pattern": "([", "category": "Bad", "subcategory": "Rule"},
+            {"name": "No labels", "extensions": [".bin"]},
+            {"name": "Bad magic", "extensions": [".bin"], "magic": "zz", "category": "Bad", "subcategory": "Rule"}
+        ]
+    })");
+    const auto scan_path = dir.path() / "SCAN_0042.zip";
+    write_file(scan_path, std::string("PK\x03\x04", 4) + std::string(60, '\0'));
+    const auto large_scan_path = dir.path() / "scan_0043.zip";
+    write_file(large_scan_path, std::string("PK\x03\x04", 4) + std::string(4096, '\0'));
+
+    const auto categorizer = FastPathCategorizer::from_file(rules_path);
+    CHECK(categorizer.rule_count() == FastPathCategorizer::default_rules().size() + 1);
+
+    const auto scan = categorizer.match("SCAN_0042.zip", scan_path.string(), FileType::File);
+    REQUIRE(scan.has_value());
+    CHECK(scan->rule_name == "Scanner exports");
+    CHECK(scan->category == "Scans");
+
+    const auto large_scan = categorizer.match("scan_0043.zip", large_scan_path.string(), FileType::File);
+    REQUIRE(large_scan.has_value());
+    CHECK(large_scan->category == "Archives");
+
+    write_file(rules_path, R"({"use_builtin_rules": false, "rules": []})");
+    CHECK(FastPathCategorizer::from_file(rules_path).rule_count() == 0);
+    CHECK(FastPathCategorizer::from_file(dir.path() / "absent.json").rule_count() ==
+          FastPathCategorizer::default_rules().size());
+}
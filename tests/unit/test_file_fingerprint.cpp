@@ -0,0 +1,80 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "FileFingerprint.hpp"
+#include "TestHelpers.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <string>
+
+namespace {
+
+void write_bytes(const std::filesystem::path& path, const std::string& bytes)
+{
+    std::ofstream out(path, std::ios::binary);
+    out << bytes;
+}
+
+} // namespace
+
+TEST_CASE("FileFingerprint matches identical content regardless of location") {
+    TempDir dir;
+    std::string content(300 * 1024, 'a');
+    content[10] = 'b';
+    const auto original = dir.path() / "photo.jpg";
+    std::filesystem::create_directories(dir.path() / "imported");
+    const auto copy = dir.path() / "imported" / "IMG_0001.jpg";
+    write_bytes(original, content);
+    write_bytes(copy, content);
+
+    const auto original_fingerprint = FileFingerprint::compute(original);
+    const auto copy_fingerprint = FileFingerprint::compute(copy);
+    REQUIRE(original_fingerprint.has_value());
+    REQUIRE(copy_fingerprint.has_value());
+    CHECK(*original_fingerprint == *copy_fingerprint);
+    CHECK(original_fingerprint->rfind(std::to_string(content.size()) + ":", 0) == 0);
+}
+
+TEST_CASE("FileFingerprint distinguishes edits in sampled blocks and size changes") {
+    TempDir dir;
+    const std::string content(300 * 1024, 'a');
+    const auto base = dir.path() / "base.jpg";
+    write_bytes(base, content);
+
+    std::string tail_edit = content;
+    tail_edit.back() = 'z';
+    const auto edited = dir.path() / "edited.jpg";
+    write_bytes(edited, tail_edit);
+
+    const auto longer = dir.path() / "longer.jpg";
+    write_bytes(longer, content + "a");
+
+    const auto base_fingerprint = FileFingerprint::compute(base);
+    REQUIRE(base_fingerprint.has_value());
+    CHECK(FileFingerprint::compute(edited) != base_fingerprint);
+    CHECK(FileFingerprint::compute(longer) != base_fingerprint);
+    CHECK_FALSE(FileFingerprint::compute(dir.path() / "missing.jpg").has_value());
+}
+
+TEST_CASE("FileFingerprint identity follows renames but not edits") {
+    TempDir dir;
+    const auto original = dir.path() / "report.pdf";
+    write_bytes(original, "first version");
+    const auto written = std::filesystem::last_write_time(original);
+
+    const auto before = FileFingerprint::identity(original);
+    REQUIRE(before.has_value());
+    CHECK(FileFingerprint::identity(original) == before);
+
+    std::filesystem::last_write_time(original, written + std::chrono::seconds(5));
+    const auto touched = FileFingerprint::identity(original);
+    REQUIRE(touched.has_value());
+    CHECK(touched != before);
+
+#if !defined(_WIN32)
+    const auto renamed = dir.path() / "renamed.pdf";
+    std::filesystem::rename(original, renamed);
+    CHECK(FileFingerprint::identity(renamed) == touched);
+#endif
+    CHECK_FALSE(FileFingerprint::identity(dir.path() / "missing.pdf").has_value());
+}
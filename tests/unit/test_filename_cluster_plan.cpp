@@ -0,0 +1,112 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "FilenameClusterPlan.hpp"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+
+FileEntry make_entry(const std::string& dir, const std::string& name, FileType type = FileType::File)
+{
+    return FileEntry{dir + "/" + name, name, type};
+}
+
+CategorizedFile make_result(const std::string& name, const std::string& category, const std::string& subcategory)
+{
+    CategorizedFile result{"/scans", name, FileType::File, category, subcategory, 7};
+    result.canonical_category = category;
+    result.canonical_subcategory = subcategory;
+    return result;
+}
+
+} // namespace
+
+TEST_CASE("FilenameClusterPlan collapses numbers, dates, UUIDs and hashes into templates") {
+    CHECK(FilenameClusterPlan::make_template("scan_0001.pdf") == std::optional<std::string>("scan_{n}.pdf"));
+    CHECK(FilenameClusterPlan::make_template("Invoice-2024-03-17.PDF") ==
+          std::optional<std::string>("invoice-{date}.pdf"));
+    CHECK(FilenameClusterPlan::make_template("IMG_20240317_101502.jpg") ==
+          std::optional<std::string>("img_{date}_{n}.jpg"));
+    CHECK(FilenameClusterPlan::make_template("DSC_4412.NEF") == std::optional<std::string>("dsc_{n}.nef"));
+    CHECK(FilenameClusterPlan::make_template("export-3f2b8c1e-9a4d-4e6f-8b7a-1c2d3e4f5a6b.csv") ==
+          std::optional<std::string>("export-{uuid}.csv"));
+    CHECK(FilenameClusterPlan::make_template("cache_9f86d081884c7d659a2feaa0c55ad015.bin") ==
+          std::optional<std::string>("cache_{hash}.bin"));
+
+    CHECK_FALSE(FilenameClusterPlan::make_template("notes.txt").has_value());
+    CHECK_FALSE(FilenameClusterPlan::make_template("0042.jpg").has_value());
+    CHECK_FALSE(FilenameClusterPlan::make_template("v2.zip").has_value());
+}
+
+TEST_CASE("FilenameClusterPlan reuses a verified representative for sibling files") {
+    const std::vector<FileEntry> files = {
+        make_entry("/scans", "scan_0001.pdf"),
+        make_entry("/scans", "notes.txt"),
+        make_entry("/scans", "scan_0002.pdf"),
+        make_entry("/other", "scan_0003.pdf"),
+        make_entry("/scans", "scan_0004.pdf"),
+        make_entry("/scans", "scan_0005.pdf"),
+        make_entry("/scans", "scan_0006", FileType::Directory),
+        make_entry("/scans", "report_1.docx"),
+        make_entry("/scans", "report_2.docx"),
+    };
+
+    FilenameClusterPlan plan(files, 1);
+    CHECK(plan.cluster_count() == 1);
+    CHECK_FALSE(plan.will_propagate(0));
+    CHECK_FALSE(plan.will_propagate(2));
+    CHECK(plan.will_propagate(4));
+    CHECK(plan.will_propagate(5));
+    CHECK_FALSE(plan.will_propagate(3));
+    CHECK_FALSE(plan.will_propagate(6));
+    CHECK_FALSE(plan.will_propagate(8));
+
+    CHECK(plan.representative_result(4) == nullptr);
+
+    SECTION("a matching sample confirms the representative") {
+        plan.record_result(0, make_result("scan_0001.pdf", "Documents", "Scans"));
+        CHECK(plan.representative_result(4) == nullptr);
+        plan.record_result(2, make_result("scan_0002.pdf", "Documents", "Scans"));
+
+        const auto* representative = plan.representative_result(4);
+        REQUIRE(representative != nullptr);
+        CHECK(representative->file_name == "scan_0001.pdf");
+        CHECK(representative->subcategory == "Scans");
+        CHECK(plan.representative_result(5) == representative);
+        CHECK(plan.representative_result(2) == nullptr);
+    }
+
+    SECTION("a disagreeing sample dissolves the cluster") {
+        plan.record_result(0, make_result("scan_0001.pdf", "Documents", "Scans"));
+        plan.record_result(2, make_result("scan_0002.pdf", "Finance", "Receipts"));
+        CHECK(plan.representative_result(4) == nullptr);
+        CHECK_FALSE(plan.will_propagate(4));
+    }
+
+    SECTION("a representative without a result dissolves the cluster") {
+        plan.record_result(0, std::nullopt);
+        plan.record_result(2, make_result("scan_0002.pdf", "Documents", "Scans"));
+        CHECK(plan.representative_result(4) == nullptr);
+        CHECK_FALSE(plan.will_propagate(5));
+    }
+
+    SECTION("excluded entries never join a cluster") {
+        FilenameClusterPlan plan_with_overrides(files, 1, [](const FileEntry& entry) {
+            return entry.file_name == "scan_0002.pdf" || entry.file_name == "scan_0004.pdf";
+        });
+        CHECK(plan_with_overrides.cluster_count() == 0);
+        CHECK_FALSE(plan_with_overrides.will_propagate(5));
+    }
+
+    SECTION("without samples the representative is reused directly") {
+        FilenameClusterPlan unverified(files, 0);
+        CHECK(unverified.cluster_count() == 2);
+        CHECK(unverified.will_propagate(2));
+        CHECK(unverified.will_propagate(8));
+        unverified.record_result(0, make_result("scan_0001.pdf", "Documents", "Scans"));
+        REQUIRE(unverified.representative_result(2) != nullptr);
+        CHECK(unverified.representative_result(8) == nullptr);
+    }
+}
@@ -0,0 +1,54 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "GpuLayerProfileCache.hpp"
+#include "TestHelpers.hpp"
+
+#include <fstream>
+
+TEST_CASE("GpuLayerProfileCache persists the successful layer count per model, backend and memory bucket") {
+    TempDir dir;
+    const auto file = dir.path() / "gpu_layer_profiles.json";
+    const GpuLayerProfileCache::Key cuda_key{"/models/a.gguf|100|1", "cuda", 8192};
+    const GpuLayerProfileCache::Key vulkan_key{"/models/a.gguf|100|1", "vulkan", 8192};
+    const GpuLayerProfileCache::Key smaller_gpu_key{"/models/a.gguf|100|1", "cuda", 4096};
+
+    {
+        GpuLayerProfileCache cache(file);
+        CHECK_FALSE(cache.lookup(cuda_key).has_value());
+        REQUIRE(cache.store(cuda_key, 28));
+    }
+
+    GpuLayerProfileCache reopened(file);
+    REQUIRE(reopened.lookup(cuda_key).has_value());
+    CHECK(*reopened.lookup(cuda_key) == 28);
+    CHECK_FALSE(reopened.lookup(vulkan_key).has_value());
+    CHECK_FALSE(reopened.lookup(smaller_gpu_key).has_value());
+
+    REQUIRE(reopened.store(vulkan_key, 20));
+    REQUIRE(reopened.forget(cuda_key));
+    CHECK_FALSE(reopened.lookup(cuda_key).has_value());
+    CHECK(reopened.lookup(vulkan_key) == 20);
+}
+
+TEST_CASE("GpuLayerProfileCache ignores a corrupt profile file") {
+    TempDir dir;
+    const auto file = dir.path() / "gpu_layer_profiles.json";
+    {
+        std::ofstream out(file);
+        out << "{ not json";
+    }
+    const GpuLayerProfileCache::Key key{"/models/a.gguf|100|1", "cuda", 8192};
+
+    GpuLayerProfileCache cache(file);
+    CHECK_FALSE(cache.lookup(key).has_value());
+    REQUIRE(cache.store(key, 12));
+    CHECK(cache.lookup(key) == 12);
+}
+
+TEST_CASE("GpuLayerProfileCache buckets device memory so small driver differences share an entry") {
+    constexpr std::uint64_t mib = 1024ull * 1024ull;
+    CHECK(GpuLayerProfileCache::memory_bucket_mib(8192 * mib) == 8192);
+    CHECK(GpuLayerProfileCache::memory_bucket_mib(8100 * mib) == 7680);
+    CHECK(GpuLayerProfileCache::memory_bucket_mib(7800 * mib) == 7680);
+    CHECK(GpuLayerProfileCache::memory_bucket_mib(100 * mib) == 0);
+}
@@ -0,0 +1,255 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "ImagePrefetcher.hpp"
+#include "TestHelpers.hpp"
+
+#include <QColor>
+#include <QImage>
+#include <QString>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace {
+
+std::filesystem::path write_png(const std::filesystem::path& dir, const std::string& name, int width, int height)
+{
+    QImage image(width, height, QImage::Format_RGB32);
+    image.fill(QColor(200, 40, 10));
+    const auto path = dir / name;
+    REQUIRE(image.save(QString::fromStdString(path.string()), "PNG"));
+    return path;
+}
+
+std::vector<char> read_bytes(const std::filesystem::path& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void append_u16(std::vector<char>& out, uint16_t value)
+{
+    out.push_back(static_cast<char>(value & 0xFF));
+    out.push_back(static_cast<char>(value >> 8));
+}
+
+void append_u32(std::vector<char>& out, uint32_t value)
+{
+    append_u16(out, static_cast<uint16_t>(value & 0xFFFF));
+    append_u16(out, static_cast<uint16_t>(value >> 16));
+}
+
+void append_ifd_entry(std::vector<char>& out, uint16_t tag, uint16_t type, uint32_t value)
+{
+    append_u16(out, tag);
+    append_u16(out, type);
+    append_u32(out, 1);
+    append_u32(out, value);
+}
+
+// Inserts an APP1 segment holding IFD0 (orientation) and IFD1 (JPEG thumbnail) into a JPEG.
+std::filesystem::path write_jpeg_with_thumbnail(const std::filesystem::path& dir,
+                                                const std::filesystem::path& main_jpeg,
+                                                const std::filesystem::path& thumbnail_jpeg,
+                                                uint16_t orientation)
+{
+    const auto thumbnail = read_bytes(thumbnail_jpeg);
+    std::vector<char> tiff = {'I', 'I'};
+    append_u16(tiff, 42);
+    append_u32(tiff, 8);
+    append_u16(tiff, 1);
+    append_ifd_entry(tiff, 0x0112, 3, orientation);
+    append_u32(tiff, 26);
+    append_u16(tiff, 2);
+    append_ifd_entry(tiff, 0x0201, 4, 56);
+    append_ifd_entry(tiff, 0x0202, 4, static_cast<uint32_t>(thumbnail.size()));
+    append_u32(tiff, 0);
+    REQUIRE(tiff.size() == 56);
+    tiff.insert(tiff.end(), thumbnail.begin(), thumbnail.end());
+
+    const auto main = read_bytes(main_jpeg);
+    REQUIRE(main.size() > 2);
+    const auto segment_length = static_cast<uint16_t>(2 + 6 + tiff.size());
+    std::vector<char> out(main.begin(), main.begin() + 2);
+    out.push_back(static_cast<char>(0xFF));
+    out.push_back(static_cast<char>(0xE1));
+    out.push_back(static_cast<char>(segment_length >> 8));
+    out.push_back(static_cast<char>(segment_length & 0xFF));
+    out.insert(out.end(), {'E', 'x', 'i', 'f', '\0', '\0'});
+    out.insert(out.end(), tiff.begin(), tiff.end());
+    out.insert(out.end(), main.begin() + 2, main.end());
+
+    const auto path = dir / "camera.jpg";
+    std::ofstream file(path, std::ios::binary);
+    file.write(out.data(), static_cast<std::streamsize>(out.size()));
+    return path;
+}
+
+// Inserts an APP2 Multi-Picture Format index into a JPEG and appends the listed preview image.
+// A non-zero declared_size replaces the preview size written to the index.
+std::filesystem::path write_jpeg_with_mpf_preview(const std::filesystem::path& dir,
+                                                  const std::filesystem::path& main_jpeg,
+                                                  const std::filesystem::path& preview_jpeg,
+                                                  uint32_t declared_size = 0)
+{
+    const auto main = read_bytes(main_jpeg);
+    const auto preview = read_bytes(preview_jpeg);
+    REQUIRE(main.size() > 2);
+
+    std::vector<char> tiff = {'I', 'I'};
+    append_u16(tiff, 42);
+    append_u32(tiff, 8);
+    append_u16(tiff, 1);
+    append_u16(tiff, 0xB002);
+    append_u16(tiff, 7);
+    append_u32(tiff, 32);
+    append_u32(tiff, 26);
+    append_u32(tiff, 0);
+    REQUIRE(tiff.size() == 26);
+    // MP entries: the primary image, then the preview stored after the primary image's EOI.
+    const auto preview_offset = static_cast<uint32_t>(26 + 32 + main.size() - 2);
+    append_u32(tiff, 0x030000);
+    append_u32(tiff, static_cast<uint32_t>(main.size()));
+    append_u32(tiff, 0);
+    append_u32(tiff, 0);
+    append_u32(tiff, 0x010002);
+    append_u32(tiff, declared_size != 0 ? declared_size : static_cast<uint32_t>(preview.size()));
+    append_u32(tiff, preview_offset);
+    append_u32(tiff, 0);
+
+    const auto segment_length = static_cast<uint16_t>(2 + 4 + tiff.size());
+    std::vector<char> out(main.begin(), main.begin() + 2);
+    out.push_back(static_cast<char>(0xFF));
+    out.push_back(static_cast<char>(0xE2));
+    out.push_back(static_cast<char>(segment_length >> 8));
+    out.push_back(static_cast<char>(segment_length & 0xFF));
+    out.insert(out.end(), {'M', 'P', 'F', '\0'});
+    out.insert(out.end(), tiff.begin(), tiff.end());
+    out.insert(out.end(), main.begin() + 2, main.end());
+    out.insert(out.end(), preview.begin(), preview.end());
+
+    const auto path = dir / "camera_mpf.jpg";
+    std::ofstream file(path, std::ios::binary);
+    file.write(out.data(), static_cast<std::streamsize>(out.size()));
+    return path;
+}
+
+} // namespace
+
+TEST_CASE("ImagePrefetcher decodes images downscaled to the requested long side") {
+    TempDir dir;
+    const auto wide = write_png(dir.path(), "wide.png", 400, 200);
+    const auto small = write_png(dir.path(), "small.png", 60, 80);
+
+    ImagePrefetcher prefetcher({wide, small}, 100, 2, 2);
+
+    const auto first = prefetcher.take(0);
+    REQUIRE(first.has_value());
+    CHECK(first->path == wide);
+    CHECK(first->width == 100);
+    CHECK(first->height == 50);
+    REQUIRE(first->rgb.size() == 100u * 50u * 3u);
+    CHECK(first->rgb[0] == 200);
+    CHECK(first->rgb[1] == 40);
+    CHECK(first->rgb[2] == 10);
+
+    const auto second = prefetcher.take(1);
+    REQUIRE(second.has_value());
+    CHECK(second->width == 60);
+    CHECK(second->height == 80);
+
+    CHECK_FALSE(prefetcher.take(1).has_value());
+}
+
+TEST_CASE("ImagePrefetcher reports undecodable files and allows skipping ahead") {
+    TempDir dir;
+    const auto broken = dir.path() / "broken.jpg";
+    {
+        std::ofstream out(broken, std::ios::binary);
+        out << "not an image";
+    }
+    const auto skipped = write_png(dir.path(), "skipped.png", 32, 32);
+    const auto last = write_png(dir.path(), "last.png", 48, 16);
+
+    ImagePrefetcher prefetcher({broken, skipped, last}, 0, 1, 1);
+
+    CHECK_FALSE(prefetcher.take(0).has_value());
+    const auto image = prefetcher.take(2);
+    REQUIRE(image.has_value());
+    CHECK(image->width == 48);
+    CHECK(image->height == 16);
+    CHECK_FALSE(prefetcher.take(1).has_value());
+}
+
+TEST_CASE("ImagePrefetcher uses large enough EXIF previews in fast visual mode") {
+    TempDir dir;
+    QImage main_image(800, 600, QImage::Format_RGB32);
+    main_image.fill(QColor(220, 0, 0));
+    const auto main_path = dir.path() / "main.jpg";
+    REQUIRE(main_image.save(QString::fromStdString(main_path.string()), "JPG", 95));
+    QImage preview(400, 300, QImage::Format_RGB32);
+    preview.fill(QColor(0, 0, 220));
+    const auto preview_path = dir.path() / "preview.jpg";
+    REQUIRE(preview.save(QString::fromStdString(preview_path.string()), "JPG", 95));
+    const auto camera = write_jpeg_with_thumbnail(dir.path(), main_path, preview_path, 6);
+
+    const auto from_preview = ImagePrefetcher::decode(camera, 1024, 300);
+    REQUIRE(from_preview.has_value());
+    CHECK(from_preview->width == 300);
+    CHECK(from_preview->height == 400);
+    REQUIRE_FALSE(from_preview->rgb.empty());
+    CHECK(from_preview->rgb[0] < 40);
+    CHECK(from_preview->rgb[2] > 180);
+
+    const auto full_decode = ImagePrefetcher::decode(camera, 1024, 500);
+    REQUIRE(full_decode.has_value());
+    CHECK(std::max(full_decode->width, full_decode->height) == 800);
+    REQUIRE_FALSE(full_decode->rgb.empty());
+    CHECK(full_decode->rgb[0] > 180);
+    CHECK(full_decode->rgb[2] < 40);
+}
+
+TEST_CASE("ImagePrefetcher uses the Multi-Picture Format preview of camera JPEGs") {
+    TempDir dir;
+    QImage main_image(1600, 1200, QImage::Format_RGB32);
+    main_image.fill(QColor(220, 0, 0));
+    const auto main_path = dir.path() / "main.jpg";
+    REQUIRE(main_image.save(QString::fromStdString(main_path.string()), "JPG", 95));
+    QImage preview(1024, 768, QImage::Format_RGB32);
+    preview.fill(QColor(0, 0, 220));
+    const auto preview_path = dir.path() / "preview.jpg";
+    REQUIRE(preview.save(QString::fromStdString(preview_path.string()), "JPG", 95));
+    const auto camera = write_jpeg_with_mpf_preview(dir.path(), main_path, preview_path);
+
+    const auto from_preview = ImagePrefetcher::decode(camera, 896, 896);
+    REQUIRE(from_preview.has_value());
+    CHECK(from_preview->width == 896);
+    CHECK(from_preview->height == 672);
+    REQUIRE_FALSE(from_preview->rgb.empty());
+    CHECK(from_preview->rgb[0] < 40);
+    CHECK(from_preview->rgb[2] > 180);
+}
+
+TEST_CASE("ImagePrefetcher ignores Multi-Picture Format previews that run past the end of the file") {
+    TempDir dir;
+    QImage main_image(1600, 1200, QImage::Format_RGB32);
+    main_image.fill(QColor(220, 0, 0));
+    const auto main_path = dir.path() / "main.jpg";
+    REQUIRE(main_image.save(QString::fromStdString(main_path.string()), "JPG", 95));
+    QImage preview(1024, 768, QImage::Format_RGB32);
+    preview.fill(QColor(0, 0, 220));
+    const auto preview_path = dir.path() / "preview.jpg";
+    REQUIRE(preview.save(QString::fromStdString(preview_path.string()), "JPG", 95));
+    const auto camera = write_jpeg_with_mpf_preview(dir.path(), main_path, preview_path, 0xFFFFFF00u);
+
+    const auto decoded = ImagePrefetcher::decode(camera, 896, 896);
+    REQUIRE(decoded.has_value());
+    CHECK(decoded->width == 896);
+    CHECK(decoded->height == 672);
+    REQUIRE_FALSE(decoded->rgb.empty());
+    CHECK(decoded->rgb[0] > 180);
+    CHECK(decoded->rgb[2] < 40);
+}
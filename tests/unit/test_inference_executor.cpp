@@ -0,0 +1,48 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "InferenceExecutor.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+TEST_CASE("InferenceExecutor reuses its worker thread for queued jobs") {
+    InferenceExecutor executor(1);
+    std::vector<InferenceExecutor::Submission<std::thread::id>> submissions;
+    for (int i = 0; i < 4; ++i) {
+        submissions.push_back(executor.submit([](const std::atomic<bool>&) {
+            return std::this_thread::get_id();
+        }));
+    }
+
+    const auto first = submissions.front().result.get();
+    CHECK(first != std::this_thread::get_id());
+    for (std::size_t i = 1; i < submissions.size(); ++i) {
+        CHECK(submissions[i].result.get() == first);
+    }
+}
+
+TEST_CASE("InferenceExecutor frees the worker when a timed-out job is cancelled") {
+    InferenceExecutor executor(1);
+    auto slow = executor.submit([](const std::atomic<bool>& cancelled) {
+        while (!cancelled.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return -1;
+    });
+    auto queued = executor.submit([](const std::atomic<bool>&) { return 1; });
+    auto next = executor.submit([](const std::atomic<bool>&) { return 2; });
+
+    REQUIRE(slow.result.wait_for(std::chrono::milliseconds(50)) == std::future_status::timeout);
+    slow.cancel->store(true);
+    queued.cancel->store(true);
+
+    REQUIRE(next.result.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    CHECK(next.result.get() == 2);
+    CHECK(slow.result.get() == -1);
+    CHECK_THROWS_AS(queued.result.get(), std::future_error);
+
+    executor.wait_idle();
+}
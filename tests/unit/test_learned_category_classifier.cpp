@@ -0,0 +1,142 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "LearnedCategoryClassifier.hpp"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+UserLearningStore::ApprovedExample make_example(int id,
+                                                const std::string& file_name,
+                                                const std::string& category,
+                                                const std::string& subcategory,
+                                                const std::string& context_text = {})
+{
+    UserLearningStore::ApprovedExample example;
+    example.id = id;
+    example.file_name = file_name;
+    example.category = category;
+    example.subcategory = subcategory;
+    example.context_text = context_text;
+    example.source = "review";
+    return example;
+}
+
+// Ten approvals each for invoices, vacation photos and lecture notes, and two for tax returns.
+std::vector<UserLearningStore::ApprovedExample> make_history()
+{
+    const std::vector<std::string> vendors = {"acme", "globex", "initech"};
+    const std::vector<std::string> scenes = {"Sunny beach with palm trees and the ocean",
+                                             "Beach at sunset with waves and palm trees",
+                                             "Family on the beach near the ocean"};
+    std::vector<UserLearningStore::ApprovedExample> history;
+    int id = 0;
+    for (int i = 1; i <= 10; ++i) {
+        const std::string month = std::string(i < 10 ? "0" : "") + std::to_string(i);
+        history.push_back(make_example(++id,
+                                       "invoice_2023_" + month + "_" + vendors[i % 3] + ".pdf",
+                                       "Finance",
+                                       "Invoices"));
+    }
+    for (int i = 1; i <= 10; ++i) {
+        history.push_back(make_example(++id,
+                                       "IMG_" + std::to_string(2040 + i) + ".jpg",
+                                       "Images",
+                                       "Vacation",
+                                       scenes[i % 3]));
+    }
+    for (int i = 1; i <= 10; ++i) {
+        history.push_back(make_example(++id,
+                                       "lecture_notes_week" + std::to_string(i) + ".docx",
+                                       "Documents",
+                                       "Coursework"));
+    }
+    history.push_back(make_example(++id, "tax_return_2022.pdf", "Finance", "Taxes"));
+    history.push_back(make_example(++id, "tax_return_2021.pdf", "Finance", "Taxes"));
+    return history;
+}
+
+} // namespace
+
+TEST_CASE("LearnedCategoryClassifier answers repeated naming patterns with high confidence") {
+    LearnedCategoryClassifier classifier;
+    classifier.sync(make_history());
+    CHECK(classifier.label_count() == 4);
+    CHECK(classifier.example_count() == 32);
+
+    const auto invoice = classifier.predict(LearnedCategoryClassifier::feature_text("invoice_2024_07_acme.pdf", ""));
+    REQUIRE(invoice.has_value());
+    CHECK(invoice->category == "Finance");
+    CHECK(invoice->subcategory == "Invoices");
+    CHECK(invoice->confidence > 0.9);
+    CHECK(invoice->support == 10);
+
+    const auto photo = classifier.predict(LearnedCategoryClassifier::feature_text(
+        "IMG_3100.jpg", "Palm trees on a sunny beach by the ocean"));
+    REQUIRE(photo.has_value());
+    CHECK(photo->category == "Images");
+    CHECK(photo->subcategory == "Vacation");
+    CHECK(photo->confidence > 0.9);
+
+    SECTION("labels with too few examples are never predicted") {
+        const auto tax = classifier.predict(LearnedCategoryClassifier::feature_text("tax_return_2023.pdf", ""));
+        CHECK_FALSE(tax.has_value());
+    }
+
+    SECTION("a shared extension alone is not evidence") {
+        CHECK(LearnedCategoryClassifier::feature_text("resume.pdf", "") == "resume");
+        CHECK_FALSE(classifier.predict(LearnedCategoryClassifier::feature_text("resume.pdf", "")).has_value());
+        CHECK_FALSE(classifier.predict(LearnedCategoryClassifier::feature_text("2024.pdf", "")).has_value());
+    }
+
+    SECTION("unfamiliar names stay below the confidence of known patterns") {
+        const auto unknown = classifier.predict(LearnedCategoryClassifier::feature_text("qzx_blob.bin", ""));
+        CHECK((!unknown.has_value() || unknown->confidence < 0.9));
+        CHECK_FALSE(classifier.predict("").has_value());
+    }
+}
+
+TEST_CASE("LearnedCategoryClassifier syncs new approvals and refits corrected ones") {
+    auto history = make_history();
+    LearnedCategoryClassifier classifier;
+    classifier.sync(history);
+
+    SECTION("new approvals are learned without dropping earlier labels") {
+        for (int year = 2012; year <= 2019; ++year) {
+            history.push_back(
+                make_example(100 + year, "tax_return_" + std::to_string(year) + ".pdf", "Finance", "Taxes"));
+        }
+        history.push_back(make_example(99, "settings.json", "Finance", "Taxes", "Imported budget categories"));
+        history.back().source = "whitelist:Default";
+        classifier.sync(history);
+        CHECK(classifier.example_count() == 40);
+
+        const auto tax = classifier.predict(LearnedCategoryClassifier::feature_text("tax_return_2023.pdf", ""));
+        REQUIRE(tax.has_value());
+        CHECK(tax->subcategory == "Taxes");
+        CHECK(tax->support == 10);
+
+        const auto invoice = classifier.predict(LearnedCategoryClassifier::feature_text("invoice_2024_08_acme.pdf", ""));
+        REQUIRE(invoice.has_value());
+        CHECK(invoice->subcategory == "Invoices");
+    }
+
+    SECTION("relabeled and removed examples trigger a refit") {
+        for (auto& example : history) {
+            if (example.category == "Documents") {
+                example.category = "Education";
+                example.subcategory = "Lectures";
+            }
+        }
+        history.erase(history.begin());
+        classifier.sync(history);
+        CHECK(classifier.example_count() == 31);
+        CHECK(classifier.label_count() == 4);
+
+        const auto notes = classifier.predict(LearnedCategoryClassifier::feature_text("lecture_notes_week4.docx", ""));
+        REQUIRE(notes.has_value());
+        CHECK(notes->category == "Education");
+        CHECK(notes->subcategory == "Lectures");
+    }
+}
@@ -0,0 +1,31 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "LlamaContextOptions.hpp"
+
+TEST_CASE("LlamaContextOptions quantizes the KV cache automatically only under memory pressure") {
+    const auto roomy = LlamaContextOptions::resolve(KvCacheType::Auto, FlashAttentionMode::Auto, false);
+    CHECK(roomy.type_k == GGML_TYPE_F16);
+    CHECK(roomy.type_v == GGML_TYPE_F16);
+    CHECK(roomy.flash_attn == LLAMA_FLASH_ATTN_TYPE_AUTO);
+
+    const auto constrained = LlamaContextOptions::resolve(KvCacheType::Auto, FlashAttentionMode::Auto, true);
+    CHECK(constrained.type_k == GGML_TYPE_Q8_0);
+    CHECK(constrained.type_v == GGML_TYPE_Q8_0);
+
+    const auto pinned = LlamaContextOptions::resolve(KvCacheType::F16, FlashAttentionMode::On, true);
+    CHECK(pinned.type_k == GGML_TYPE_F16);
+    CHECK(pinned.flash_attn == LLAMA_FLASH_ATTN_TYPE_ENABLED);
+}
+
+TEST_CASE("LlamaContextOptions keeps the V cache in f16 when flash attention is off") {
+    const auto config = LlamaContextOptions::resolve(KvCacheType::Q4_0, FlashAttentionMode::Off, false);
+    CHECK(config.type_k == GGML_TYPE_Q4_0);
+    CHECK(config.type_v == GGML_TYPE_F16);
+    CHECK(config.flash_attn == LLAMA_FLASH_ATTN_TYPE_DISABLED);
+
+    llama_context_params params{};
+    LlamaContextOptions::apply(params, config);
+    CHECK(params.type_k == GGML_TYPE_Q4_0);
+    CHECK(params.type_v == GGML_TYPE_F16);
+    CHECK(params.flash_attn_type == LLAMA_FLASH_ATTN_TYPE_DISABLED);
+}
@@ -0,0 +1,118 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "LlamaModelRegistry.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct FakeModelStore {
+    std::vector<std::string> loads;
+    int frees{0};
+    bool fail_loads{false};
+
+    LlamaModelRegistry make_registry()
+    {
+        return LlamaModelRegistry(
+            [this](const std::string& path, const llama_model_params& params) -> llama_model* {
+                if (fail_loads) {
+                    return nullptr;
+                }
+                loads.push_back(path + "@" + std::to_string(params.n_gpu_layers));
+                return reinterpret_cast<llama_model*>(new int(0));
+            },
+            [this](llama_model* model) {
+                ++frees;
+                delete reinterpret_cast<int*>(model);
+            });
+    }
+};
+
+llama_model_params params_with_layers(int n_gpu_layers)
+{
+    llama_model_params params{};
+    params.n_gpu_layers = n_gpu_layers;
+    return params;
+}
+
+} // namespace
+
+TEST_CASE("LlamaModelRegistry shares one resident model per path, backend and GPU layer count") {
+    FakeModelStore store;
+    auto registry = store.make_registry();
+
+    auto first = registry.acquire("/models/text.gguf", "vulkan", params_with_layers(20));
+    auto second = registry.acquire("/models/text.gguf", "vulkan", params_with_layers(20));
+    REQUIRE(first);
+    CHECK(first.get() == second.get());
+    CHECK(store.loads.size() == 1);
+
+    const auto found = registry.find("/models/text.gguf", "vulkan");
+    REQUIRE(found.has_value());
+    CHECK(found->model.get() == first.get());
+    CHECK(found->n_gpu_layers == 20);
+    CHECK_FALSE(registry.find("/models/text.gguf", "cpu").has_value());
+}
+
+TEST_CASE("LlamaModelRegistry keeps released models resident until another model is loaded") {
+    FakeModelStore store;
+    auto registry = store.make_registry();
+
+    {
+        auto handle = registry.acquire("/models/text.gguf", "auto", params_with_layers(0));
+        REQUIRE(handle);
+    }
+    CHECK(registry.resident_count() == 1);
+    CHECK(store.frees == 0);
+
+    auto reused = registry.acquire("/models/text.gguf", "auto", params_with_layers(0));
+    CHECK(store.loads.size() == 1);
+
+    auto other = registry.acquire("/models/other.gguf", "auto", params_with_layers(0));
+    REQUIRE(other);
+    CHECK(store.frees == 0);
+    CHECK(registry.resident_count() == 2);
+
+    reused.reset();
+    auto third = registry.acquire("/models/third.gguf", "auto", params_with_layers(0));
+    REQUIRE(third);
+    CHECK(store.frees == 1);
+    CHECK_FALSE(registry.find("/models/text.gguf", "auto").has_value());
+
+    other.reset();
+    third.reset();
+    registry.release_idle();
+    CHECK(registry.resident_count() == 0);
+    CHECK(store.frees == 3);
+}
+
+TEST_CASE("LlamaModelRegistry release_all frees idle models and defers held ones to their last holder") {
+    FakeModelStore store;
+    auto registry = store.make_registry();
+
+    auto held = registry.acquire("/models/text.gguf", "auto", params_with_layers(0));
+    REQUIRE(held);
+    {
+        auto idle = registry.acquire("/models/text.gguf", "cpu", params_with_layers(0));
+        REQUIRE(idle);
+    }
+    CHECK(registry.resident_count() == 2);
+
+    registry.release_all();
+    CHECK(registry.resident_count() == 0);
+    CHECK(store.frees == 1);
+
+    held.reset();
+    CHECK(store.frees == 2);
+}
+
+TEST_CASE("LlamaModelRegistry does not cache failed loads") {
+    FakeModelStore store;
+    store.fail_loads = true;
+    auto registry = store.make_registry();
+
+    CHECK_FALSE(registry.acquire("/models/missing.gguf", "auto", params_with_layers(0)));
+    CHECK(registry.resident_count() == 0);
+}
@@ -104,6 +104,37 @@ TEST_CASE("LlavaImageAnalyzer exposes structured multimodal prompt policy") {
     CHECK(filename_prompt.find("Output only the filename stem.") != std::string::npos);
 }
 
+TEST_CASE("LlavaImageAnalyzer asks single-pass policies for description and filename together") {
+    const auto prompt =
+        LlavaImageAnalyzerTestAccess::single_pass_user_prompt(VisualPromptPolicy::StructuredSinglePass);
+    CHECK(prompt.find("<__media__>") != std::string::npos);
+    CHECK(prompt.find("Description:") != std::string::npos);
+    CHECK(prompt.find("Filename:") != std::string::npos);
+    CHECK(LlavaImageAnalyzerTestAccess::single_pass_user_prompt(
+              VisualPromptPolicy::StructuredVisionInstruct).empty());
+    CHECK(LlavaImageAnalyzerTestAccess::single_pass_user_prompt(VisualPromptPolicy::LegacyLlava).empty());
+
+    const auto fallback_prompt = LlavaImageAnalyzerTestAccess::description_user_prompt(
+        VisualPromptPolicy::StructuredSinglePass);
+    CHECK(fallback_prompt.find("Output only the description.") != std::string::npos);
+}
+
+TEST_CASE("LlavaImageAnalyzer parses single-pass replies and flags missing parts") {
+    const auto full = LlavaImageAnalyzerTestAccess::parse_single_pass_reply(
+        "Description: A scanned invoice with handwritten totals.\nFilename: scanned_invoice_totals");
+    REQUIRE(full.has_value());
+    CHECK(full->first == "A scanned invoice with handwritten totals.");
+    CHECK(full->second == "scanned_invoice_totals");
+
+    const auto truncated = LlavaImageAnalyzerTestAccess::parse_single_pass_reply(
+        "Description: A dog running on a beach at");
+    REQUIRE(truncated.has_value());
+    CHECK(truncated->first == "A dog running on a beach at");
+    CHECK(truncated->second.empty());
+
+    CHECK_FALSE(LlavaImageAnalyzerTestAccess::parse_single_pass_reply("Description:  \n").has_value());
+}
+
 #ifndef GGML_USE_METAL
 TEST_CASE("LlavaImageAnalyzer ignores global GPU layer override by default") {
     TempModelFile model(48, 8 * 1024 * 1024);
@@ -5,6 +5,8 @@
 #include "TestHelpers.hpp"
 #include "Utils.hpp"
 
+#include <cctype>
+
 #ifndef GGML_USE_METAL
 
 namespace {
@@ -429,4 +431,127 @@ TEST_CASE("LocalLLMClient retries on CPU when fallback is accepted") {
         REQUIRE(std::string(ex.what()).find("Failed to load model") != std::string::npos);
     }
 }
+
+TEST_CASE("LocalLLMClient reuses the shared prompt prefix of the persistent context") {
+    const std::vector<llama_token> cached{1, 10, 11, 12, 20, 21, 30};
+
+    SECTION("shared system prompt is kept and only the per-file suffix is decoded") {
+        const std::vector<llama_token> next{1, 10, 11, 12, 40, 41};
+        CHECK(LocalLLMTestAccess::reusable_prefix_length_for_testing(cached, next) == 4);
+    }
+
+    SECTION("an identical prompt still leaves one token to decode") {
+        const std::vector<llama_token> next{1, 10, 11, 12, 20, 21, 30};
+        CHECK(LocalLLMTestAccess::reusable_prefix_length_for_testing(cached, next) == next.size() - 1);
+    }
+
+    SECTION("a prompt that extends the cached tokens keeps all of them") {
+        const std::vector<llama_token> next{1, 10, 11, 12, 20, 21, 30, 31, 32};
+        CHECK(LocalLLMTestAccess::reusable_prefix_length_for_testing(cached, next) == cached.size());
+    }
+
+    SECTION("nothing is reused when the prompts diverge immediately or the cache is empty") {
+        CHECK(LocalLLMTestAccess::reusable_prefix_length_for_testing(cached, {2, 10, 11}) == 0);
+        CHECK(LocalLLMTestAccess::reusable_prefix_length_for_testing({}, {1, 10, 11}) == 0);
+        CHECK(LocalLLMTestAccess::reusable_prefix_length_for_testing(cached, {}) == 0);
+    }
+}
+
+TEST_CASE("LocalLLMClient compares full, three-quarter, half and quarter thread counts") {
+    CHECK(LocalLLMTestAccess::thread_calibration_candidates_for_testing(16) == std::vector<int>{16, 12, 8, 4});
+    CHECK(LocalLLMTestAccess::thread_calibration_candidates_for_testing(6) == std::vector<int>{6, 4, 3, 1});
+    CHECK(LocalLLMTestAccess::thread_calibration_candidates_for_testing(2) == std::vector<int>{2, 1});
+    CHECK(LocalLLMTestAccess::thread_calibration_candidates_for_testing(1) == std::vector<int>{1});
+    CHECK(LocalLLMTestAccess::thread_calibration_candidates_for_testing(0) == std::vector<int>{1});
+}
+
+TEST_CASE("LocalLLMClient trims prompt sections by token budget in priority order") {
+    // One token per word, keeping the whitespace that precedes it.
+    const auto word_pieces = [](const std::string& text) {
+        std::vector<std::string> pieces;
+        std::string current;
+        for (const char ch : text) {
+            if (std::isspace(static_cast<unsigned char>(ch)) && !current.empty() &&
+                !std::isspace(static_cast<unsigned char>(current.back()))) {
+                pieces.push_back(current);
+                current.clear();
+            }
+            current.push_back(ch);
+        }
+        if (!current.empty()) {
+            pieces.push_back(current);
+        }
+        return pieces;
+    };
+
+    std::string summary;
+    for (int i = 0; i < 200; ++i) {
+        summary += " word" + std::to_string(i);
+    }
+    const std::string hints =
+        "Recent assignments for similar items:\n- Finance : Invoices\n"
+        "Prefer one of the above when it fits; otherwise, choose the closest consistent alternative.";
+    const std::string candidates =
+        "Allowed main categories (pick exactly one label from the numbered list):\n1) Finance\n2) Legal\n";
+    const std::string prompt =
+        "Categorize this document file for file organization.\n\n"
+        "File name: report.pdf\nPath: /docs\nDocument summary:" + summary + "\n"
+        "\n" + hints + "\n" + candidates + "\n"
+        "\nAnswer with exactly one line:\n<Main category> : <Subcategory>";
+
+    SECTION("a prompt within budget is unchanged") {
+        CHECK(LocalLLMTestAccess::fit_user_prompt_sections_for_testing(prompt, 0, word_pieces) == prompt);
+    }
+
+    SECTION("a small overflow only shortens the consistency hints") {
+        const std::string fitted =
+            LocalLLMTestAccess::fit_user_prompt_sections_for_testing(prompt, 5, word_pieces);
+        CHECK(word_pieces(fitted).size() < word_pieces(prompt).size());
+        CHECK(fitted.find(summary) != std::string::npos);
+        CHECK(fitted.find(candidates) != std::string::npos);
+        CHECK(fitted.find("Recent assignments for similar items:") != std::string::npos);
+        CHECK(fitted.find("choose the closest consistent alternative.") == std::string::npos);
+    }
+
+    SECTION("a large overflow drops hints and cuts the summary but keeps fixed sections") {
+        const std::string fitted =
+            LocalLLMTestAccess::fit_user_prompt_sections_for_testing(prompt, 1000, word_pieces);
+        CHECK(fitted.find("Recent assignments") == std::string::npos);
+        CHECK(fitted.find(" word40") != std::string::npos);
+        CHECK(fitted.find(" word150") == std::string::npos);
+        CHECK(fitted.find(candidates) != std::string::npos);
+        CHECK(fitted.find("File name: report.pdf") != std::string::npos);
+        CHECK(fitted.find("\nAnswer with exactly one line:\n<Main category> : <Subcategory>") != std::string::npos);
+    }
+}
+
+TEST_CASE("LocalLLMClient keys prompt state snapshots by model, backend, context and system prompt") {
+    TempModelFile model;
+    const std::string model_path = model.path().string();
+    llama_context_params params = llama_context_default_params();
+    params.n_ctx = 2048;
+    params.n_batch = 512;
+
+    const std::string base = LocalLLMTestAccess::prompt_state_snapshot_name_for_testing(
+        model_path, "vulkan", "system prompt", params);
+    CHECK(base == LocalLLMTestAccess::prompt_state_snapshot_name_for_testing(
+        model_path, "vulkan", "system prompt", params));
+    CHECK(base.rfind("prefix-", 0) == 0);
+    CHECK(base.size() > std::string(".kvstate").size());
+    CHECK(base.substr(base.size() - 8) == ".kvstate");
+
+    CHECK(base != LocalLLMTestAccess::prompt_state_snapshot_name_for_testing(
+        model_path, "cpu", "system prompt", params));
+    CHECK(base != LocalLLMTestAccess::prompt_state_snapshot_name_for_testing(
+        model_path, "vulkan", "other system prompt", params));
+
+    llama_context_params smaller = params;
+    smaller.n_ctx = 1024;
+    CHECK(base != LocalLLMTestAccess::prompt_state_snapshot_name_for_testing(
+        model_path, "vulkan", "system prompt", smaller));
+
+    TempModelFile other_model;
+    CHECK(base != LocalLLMTestAccess::prompt_state_snapshot_name_for_testing(
+        other_model.path().string(), "vulkan", "system prompt", params));
+}
 #endif // GGML_USE_METAL
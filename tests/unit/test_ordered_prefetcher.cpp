@@ -0,0 +1,53 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "OrderedPrefetcher.hpp"
+
+#include <atomic>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+TEST_CASE("OrderedPrefetcher hands out items in order without running past the lookahead") {
+    constexpr std::size_t kCount = 12;
+    constexpr std::size_t kLookahead = 3;
+    std::atomic<std::size_t> taken{0};
+    std::atomic<bool> ran_ahead{false};
+
+    OrderedPrefetcher<std::string> prefetcher(
+        kCount,
+        [&](std::size_t index) -> std::optional<std::string> {
+            // `taken` trails the consumer position by at most one item.
+            if (index >= taken.load() + 1 + kLookahead) {
+                ran_ahead = true;
+            }
+            return "item-" + std::to_string(index);
+        },
+        3,
+        kLookahead);
+
+    for (std::size_t i = 0; i < kCount; ++i) {
+        const auto item = prefetcher.take(i);
+        REQUIRE(item.has_value());
+        CHECK(*item == "item-" + std::to_string(i));
+        taken = i + 1;
+    }
+    CHECK_FALSE(ran_ahead.load());
+    CHECK_FALSE(prefetcher.take(kCount).has_value());
+}
+
+TEST_CASE("OrderedPrefetcher turns producer failures into missing items") {
+    OrderedPrefetcher<int> prefetcher(
+        3,
+        [](std::size_t index) -> std::optional<int> {
+            if (index == 1) {
+                throw std::runtime_error("extraction failed");
+            }
+            return static_cast<int>(index) * 10;
+        },
+        2,
+        2);
+
+    CHECK(prefetcher.take(0) == std::optional<int>(0));
+    CHECK_FALSE(prefetcher.take(1).has_value());
+    CHECK(prefetcher.take(2) == std::optional<int>(20));
+}
@@ -0,0 +1,65 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "PerceptualHash.hpp"
+#include "TestHelpers.hpp"
+
+#include <QColor>
+#include <QImage>
+#include <QString>
+
+namespace {
+
+QImage make_pattern(int width, int height, bool mirrored)
+{
+    QImage image(width, height, QImage::Format_RGB32);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const int column = mirrored ? width - 1 - x : x;
+            const int shade = (column * 255) / width;
+            const bool band = ((y * 4) / height) % 2 == 1;
+            image.setPixelColor(x, y, band ? QColor(255 - shade, 80, shade) : QColor(shade, shade, shade));
+        }
+    }
+    return image;
+}
+
+} // namespace
+
+TEST_CASE("PerceptualHash matches resized copies and separates different images") {
+    TempDir dir;
+    const QImage original = make_pattern(320, 240, false);
+    const auto original_path = dir.path() / "original.png";
+    const auto resized_path = dir.path() / "resized.jpg";
+    REQUIRE(original.save(QString::fromStdString(original_path.string()), "PNG"));
+    REQUIRE(original.scaled(160, 120).save(QString::fromStdString(resized_path.string()), "JPG", 70));
+
+    const auto original_hash = PerceptualHash::compute(original_path);
+    const auto resized_hash = PerceptualHash::compute(resized_path);
+    const auto mirrored_hash = PerceptualHash::compute(make_pattern(320, 240, true));
+    REQUIRE(original_hash.has_value());
+    REQUIRE(resized_hash.has_value());
+    REQUIRE(mirrored_hash.has_value());
+
+    CHECK(PerceptualHash::distance(*original_hash, *resized_hash) <=
+          PerceptualHash::kDefaultNearDuplicateDistance);
+    CHECK(PerceptualHash::distance(*original_hash, *mirrored_hash) >
+          PerceptualHash::kDefaultNearDuplicateDistance);
+}
+
+TEST_CASE("PerceptualHash skips flat images and the index returns the closest match") {
+    QImage flat(64, 64, QImage::Format_RGB32);
+    flat.fill(QColor(30, 30, 30));
+    CHECK_FALSE(PerceptualHash::compute(flat).has_value());
+    CHECK_FALSE(PerceptualHash::compute(QImage()).has_value());
+
+    PerceptualHash::NearDuplicateIndex index(4);
+    CHECK_FALSE(index.find(0).has_value());
+    index.add("far", 0b1111);
+    index.add("near", 0b1);
+
+    const auto match = index.find(0);
+    REQUIRE(match.has_value());
+    CHECK(match->key == "near");
+    CHECK(match->distance == 1);
+    CHECK_FALSE(index.find(0xFF00).has_value());
+}
@@ -0,0 +1,128 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "LLMErrors.hpp"
+#include "RemoteBatchPrompt.hpp"
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+std::vector<ILLMClient::CategorizationRequest> make_requests(
+    const std::vector<std::pair<std::string, std::string>>& names_and_contexts)
+{
+    std::vector<ILLMClient::CategorizationRequest> requests;
+    for (const auto& [name, context] : names_and_contexts) {
+        requests.push_back({name, "~/Downloads/" + name, FileType::File, context});
+    }
+    return requests;
+}
+
+} // namespace
+
+TEST_CASE("RemoteBatchPrompt groups requests that share a context") {
+    const auto requests = make_requests({{"a.pdf", "documents"},
+                                         {"b.jpg", "images"},
+                                         {"c.pdf", "documents"},
+                                         {"d.pdf", "documents"},
+                                         {"e.jpg", "images"}});
+
+    const auto groups = RemoteBatchPrompt::group_requests(requests, 2);
+    REQUIRE(groups.size() == 3);
+    CHECK(groups[0] == std::vector<std::size_t>{0, 2});
+    CHECK(groups[1] == std::vector<std::size_t>{1, 4});
+    CHECK(groups[2] == std::vector<std::size_t>{3});
+
+    const std::string prompt = RemoteBatchPrompt::build_user_prompt(requests, groups[0]);
+    CHECK(prompt.find("1. File name: a.pdf") != std::string::npos);
+    CHECK(prompt.find("2. File name: c.pdf") != std::string::npos);
+    CHECK(prompt.find("Full path: ~/Downloads/c.pdf") != std::string::npos);
+    CHECK(prompt.find("documents") == prompt.rfind("documents"));
+}
+
+TEST_CASE("RemoteBatchPrompt shares the whitelist and lists per-file hints under each item") {
+    const std::string whitelist = "Allowed main categories (pick exactly one label from the numbered list):\n"
+                                  "1) Documents\n2) Finance\n";
+    const auto requests = make_requests(
+        {{"invoice.pdf",
+          whitelist + "\nRecent assignments for similar items:\n- Finance : Invoices\n"
+                      "Prefer one of the above when it fits; otherwise, choose the closest consistent alternative."},
+         {"manual.pdf", whitelist},
+         {"photo.jpg", whitelist},
+         {"letter.docx",
+          whitelist + "\nUser-learned category candidates from approved behavior:\n1) Documents : Letters\n"}});
+
+    const auto parts = RemoteBatchPrompt::split_context(requests[0].consistency_context);
+    CHECK(parts.shared == RemoteBatchPrompt::split_context(whitelist).shared);
+    CHECK(parts.item.rfind("Recent assignments for similar items:", 0) == 0);
+
+    const auto groups = RemoteBatchPrompt::group_requests(requests, 8);
+    REQUIRE(groups.size() == 2);
+    CHECK(groups[0] == std::vector<std::size_t>{0, 1, 3});
+    CHECK(groups[1] == std::vector<std::size_t>{2});
+
+    const std::string prompt = RemoteBatchPrompt::build_user_prompt(requests, groups[0]);
+    CHECK(prompt.find("1. File name: invoice.pdf") < prompt.find("   - Finance : Invoices"));
+    CHECK(prompt.find("   - Finance : Invoices") < prompt.find("2. File name: manual.pdf"));
+    CHECK(prompt.find("   1) Documents : Letters") > prompt.find("3. File name: letter.docx"));
+    CHECK(prompt.find("Allowed main categories") == prompt.rfind("Allowed main categories"));
+    CHECK(prompt.find("Allowed main categories") > prompt.find("   1) Documents : Letters"));
+}
+
+TEST_CASE("RemoteBatchPrompt parses JSON array replies by item number") {
+    const std::string reply =
+        "```json\n"
+        "[{\"id\": 2, \"category\": \"Images\", \"subcategory\": \"Screenshots\"},\n"
+        " {\"id\": 1, \"category\": \"Documents\", \"subcategory\": \"Invoices\"},\n"
+        " {\"id\": 4, \"category\": \"Music\"},\n"
+        " {\"id\": 9, \"category\": \"Videos\", \"subcategory\": \"Clips\"}]\n"
+        "```";
+
+    const auto parsed = RemoteBatchPrompt::parse_response(reply, 4);
+    CHECK(parsed == std::vector<std::string>{"Documents : Invoices", "Images : Screenshots", "", ""});
+    CHECK(RemoteBatchPrompt::parse_response("Documents : Invoices", 2) == std::vector<std::string>{"", ""});
+    CHECK(RemoteBatchPrompt::parse_response("[\"Archives : Backups\"]", 1) ==
+          std::vector<std::string>{"Archives : Backups"});
+}
+
+TEST_CASE("RemoteBatchPrompt leaves unparsed items for individual requests") {
+    const auto requests = make_requests({{"a.pdf", "documents"},
+                                         {"b.pdf", "documents"},
+                                         {"c.zip", "archives"},
+                                         {"d.mp3", "audio"},
+                                         {"e.mp3", "audio"}});
+    std::vector<std::size_t> batch_sizes;
+    std::vector<std::string> singles;
+
+    const auto responses = RemoteBatchPrompt::categorize(
+        requests,
+        4,
+        [&batch_sizes](const std::string& system_prompt, const std::string& user_prompt, std::size_t item_count) {
+            CHECK(system_prompt.find("JSON") != std::string::npos);
+            batch_sizes.push_back(item_count);
+            if (user_prompt.find("d.mp3") != std::string::npos) {
+                throw std::runtime_error("Server Error");
+            }
+            return std::string("[{\"id\": 1, \"category\": \"Documents\", \"subcategory\": \"Reports\"}]");
+        },
+        [&singles](const ILLMClient::CategorizationRequest& request) {
+            singles.push_back(request.file_name);
+            return std::string("Archives : Backups");
+        });
+
+    CHECK(batch_sizes == std::vector<std::size_t>{2, 2});
+    CHECK(singles == std::vector<std::string>{"c.zip"});
+    CHECK(responses == std::vector<std::string>{"Documents : Reports", "", "Archives : Backups", "", ""});
+
+    CHECK_THROWS_AS(RemoteBatchPrompt::categorize(
+                        requests,
+                        4,
+                        [](const std::string&, const std::string&, std::size_t) -> std::string {
+                            throw BackoffError("Rate Limit Error", 5);
+                        },
+                        [](const ILLMClient::CategorizationRequest&) { return std::string(); }),
+                    BackoffError);
+}
@@ -0,0 +1,71 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "Settings.hpp"
+#include "TestHelpers.hpp"
+
+TEST_CASE("Settings defaults grammar-constrained local categorization on and persists the toggle") {
+    TempDir temp;
+    EnvVarGuard home_guard("HOME", temp.path().string());
+#ifdef _WIN32
+    EnvVarGuard appdata_guard("APPDATA", temp.path().string());
+#endif
+    EnvVarGuard config_guard("AI_FILE_SORTER_CONFIG_DIR", temp.path().string());
+
+    Settings settings;
+    REQUIRE_FALSE(settings.load());
+    REQUIRE(settings.get_constrain_local_categorization_output());
+
+    settings.set_constrain_local_categorization_output(false);
+    REQUIRE(settings.save());
+
+    Settings reloaded;
+    REQUIRE(reloaded.load());
+    REQUIRE_FALSE(reloaded.get_constrain_local_categorization_output());
+}
+
+TEST_CASE("Settings persists calibrated local LLM thread counts with their profile") {
+    TempDir temp;
+    EnvVarGuard home_guard("HOME", temp.path().string());
+#ifdef _WIN32
+    EnvVarGuard appdata_guard("APPDATA", temp.path().string());
+#endif
+    EnvVarGuard config_guard("AI_FILE_SORTER_CONFIG_DIR", temp.path().string());
+
+    Settings settings;
+    REQUIRE_FALSE(settings.load());
+    REQUIRE(settings.get_local_llm_threads() == 0);
+    REQUIRE(settings.get_local_llm_batch_threads() == 0);
+    REQUIRE(settings.get_local_llm_thread_profile().empty());
+
+    settings.set_local_llm_thread_tuning(8, 16, "/models/text.gguf|16");
+    REQUIRE(settings.save());
+
+    Settings reloaded;
+    REQUIRE(reloaded.load());
+    REQUIRE(reloaded.get_local_llm_threads() == 8);
+    REQUIRE(reloaded.get_local_llm_batch_threads() == 16);
+    REQUIRE(reloaded.get_local_llm_thread_profile() == "/models/text.gguf|16");
+}
+
+TEST_CASE("Settings persists local KV cache precision and flash-attention mode") {
+    TempDir temp;
+    EnvVarGuard home_guard("HOME", temp.path().string());
+#ifdef _WIN32
+    EnvVarGuard appdata_guard("APPDATA", temp.path().string());
+#endif
+    EnvVarGuard config_guard("AI_FILE_SORTER_CONFIG_DIR", temp.path().string());
+
+    Settings settings;
+    REQUIRE_FALSE(settings.load());
+    REQUIRE(settings.get_local_kv_cache_type() == KvCacheType::Auto);
+    REQUIRE(settings.get_local_flash_attention() == FlashAttentionMode::Auto);
+
+    settings.set_local_kv_cache_type(KvCacheType::Q4_0);
+    settings.set_local_flash_attention(FlashAttentionMode::Off);
+    REQUIRE(settings.save());
+
+    Settings reloaded;
+    REQUIRE(reloaded.load());
+    REQUIRE(reloaded.get_local_kv_cache_type() == KvCacheType::Q4_0);
+    REQUIRE(reloaded.get_local_flash_attention() == FlashAttentionMode::Off);
+}
@@ -53,7 +53,7 @@ TEST_CASE("Default visual model descriptor exposes the MTMD backend catalog") {
     CHECK(std::string(descriptor.id) == "gemma-3-4b-it");
     CHECK(std::string(descriptor.display_name) == "Gemma 3 4B IT");
     CHECK(descriptor.architecture == VisualModelArchitecture::MtmdProjector);
-    CHECK(descriptor.prompt_policy == VisualPromptPolicy::StructuredVisionInstruct);
+    CHECK(descriptor.prompt_policy == VisualPromptPolicy::StructuredSinglePass);
     REQUIRE(descriptor.artifacts.size() == 2);
     CHECK(descriptor.artifacts[0].kind == VisualModelArtifactKind::Model);
     CHECK(std::string(descriptor.artifacts[0].url_env) == "GEMMA3_4B_MODEL_URL");
@@ -74,7 +74,7 @@ TEST_CASE("Default visual model descriptor exposes the MTMD backend catalog") {
     const auto* gemma = find_visual_model_descriptor("gemma-3-4b-it");
     REQUIRE(gemma != nullptr);
     CHECK(std::string(gemma->display_name) == "Gemma 3 4B IT");
-    CHECK(gemma->prompt_policy == VisualPromptPolicy::StructuredVisionInstruct);
+    CHECK(gemma->prompt_policy == VisualPromptPolicy::StructuredSinglePass);
     REQUIRE(gemma->artifacts.size() == 2);
     CHECK(std::string(gemma->artifacts[0].url_env) == "GEMMA3_4B_MODEL_URL");
     CHECK(std::string(gemma->artifacts[1].url_env) == "GEMMA3_4B_MMPROJ_URL");